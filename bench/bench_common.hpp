@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "config/chat_htm_config.hpp"
+#include "encoders/scalar_encoder.hpp"
+#include "encoders/word_row_encoder.hpp"
+#include "runtime/text_runtime.hpp"
+#include "text/text_chunker.hpp"
+#include "text/word_chunker.hpp"
+
+namespace chat_htm::bench {
+
+/// Path of a shipped config, e.g. config_path("small_text").
+inline std::string config_path(const std::string& name) {
+  return std::string(CHAT_HTM_SOURCE_DIR) + "/configs/" + name + ".yaml";
+}
+
+/// Deterministic pseudo-English text of `bytes` characters: lowercase words
+/// of 1-10 letters separated by spaces and the odd sentence break, so
+/// results do not depend on an external corpus.
+inline std::string synthetic_text(std::size_t bytes, std::uint32_t seed = 12345) {
+  std::string out;
+  out.reserve(bytes);
+  std::uint32_t s = seed;
+  auto next = [&s] {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  };
+  while (out.size() < bytes) {
+    const std::uint32_t len = 1 + next() % 10;
+    for (std::uint32_t i = 0; i < len && out.size() < bytes; ++i) {
+      out.push_back(static_cast<char>('a' + next() % 26));
+    }
+    if (out.size() < bytes) out.push_back(next() % 12 == 0 ? '\n' : ' ');
+  }
+  return out;
+}
+
+/// A shipped config with htm_flow's timing logs off.  `column_cols`, if
+/// positive, overrides every layer's column width.
+inline ChatHtmConfig bench_config(const std::string& config_name, int column_cols = 0) {
+  auto cfg = ChatHtmConfig::load(config_path(config_name));
+  for (auto& layer : cfg.region.layers) {
+    layer.log_timings = false;
+    if (column_cols > 0) layer.num_column_cols = column_cols;
+  }
+  chain_layer_inputs(cfg.region);
+  return cfg;
+}
+
+/// Build a TextRuntime for `cfg` over synthetic text, the way
+/// `chat_htm --config` would.
+inline std::unique_ptr<TextRuntime> make_runtime(const ChatHtmConfig& cfg, const std::string& name) {
+  const std::string text = synthetic_text(1 << 16);
+  if (cfg.text_mode == TextMode::WordHash) {
+    return std::make_unique<TextRuntime>(
+        cfg.region, std::make_unique<WordChunker>(WordChunker::from_string(text)),
+        WordHashEncoder(cfg.word_hash), name);
+  }
+  if (cfg.text_mode == TextMode::WordRows) {
+    return std::make_unique<TextRuntime>(
+        cfg.region, std::make_unique<WordChunker>(WordChunker::from_string(text)),
+        WordRowEncoder(cfg.word_rows), name);
+  }
+  return std::make_unique<TextRuntime>(
+      cfg.region, std::make_unique<TextChunker>(TextChunker::from_string(text)),
+      ScalarEncoder(cfg.scalar), name);
+}
+
+/// make_runtime() for a shipped config; see bench_config().
+inline std::unique_ptr<TextRuntime> make_runtime(const std::string& config_name,
+                                                 int column_cols = 0) {
+  return make_runtime(bench_config(config_name, column_cols), config_name);
+}
+
+}  // namespace chat_htm::bench
@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "encoders/scalar_encoder.hpp"
+#include "encoders/sdr.hpp"
+#include "encoders/word_row_encoder.hpp"
+
+namespace {
+
+using chat_htm::ScalarEncoder;
+using chat_htm::Sdr;
+using chat_htm::WordRowEncoder;
+
+/// Arg 0: encoder width n (w stays ~9% of n).
+ScalarEncoder::Params scalar_params(const benchmark::State& state, bool cache) {
+  ScalarEncoder::Params p;
+  p.n = static_cast<int>(state.range(0));
+  p.w = std::max(1, p.n * 9 / 100);
+  p.cache = cache;
+  return p;
+}
+
+void BM_ScalarEncoderEncode(benchmark::State& state) {
+  const ScalarEncoder enc(scalar_params(state, false));
+  int value = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(enc.encode(value));
+    value = (value + 1) & 127;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarEncoderEncode)->Arg(100)->Arg(1024)->Arg(4096);
+
+void BM_ScalarEncoderIndices(benchmark::State& state) {
+  const ScalarEncoder enc(scalar_params(state, state.range(1) != 0));
+  std::vector<int> out;
+  int value = 0;
+  for (auto _ : state) {
+    enc.encode_indices(value, out);
+    benchmark::DoNotOptimize(out.data());
+    value = (value + 1) & 127;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarEncoderIndices)->ArgsProduct({{100, 1024, 4096}, {0, 1}})->ArgNames({"n", "cache"});
+
+/// Word-row encoder at the word_rows_text.yaml geometry (5 rows x 216 cols).
+void BM_WordRowEncoderEncode(benchmark::State& state) {
+  WordRowEncoder::Params p;
+  p.rows = 5;
+  p.cols = 216;
+  p.letter_bits = 8;
+  const WordRowEncoder enc(p);
+  const std::vector<std::string> words = {"the", "quick", "brown", "fox", "jumps",
+                                          "over", "lazy", "dogs", "encyclopedia"};
+  std::size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(enc.encode(words[i]));
+    i = (i + 1) % words.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WordRowEncoderEncode);
+
+/// Overlap of two word-row SDRs (1080 bits, 40 active): bit-packed
+/// AND-popcount vs. merging the sorted index lists.
+void BM_SdrOverlap(benchmark::State& state) {
+  WordRowEncoder::Params p;
+  p.rows = 5;
+  p.cols = 216;
+  p.letter_bits = 8;
+  const WordRowEncoder enc(p);
+  const Sdr a = enc.encode_sdr("hello");
+  const Sdr b = enc.encode_sdr("help");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a.overlap(b));
+  }
+  state.SetLabel(chat_htm::sdr_kernels::name());
+}
+BENCHMARK(BM_SdrOverlap);
+
+void BM_IndexListOverlap(benchmark::State& state) {
+  WordRowEncoder::Params p;
+  p.rows = 5;
+  p.cols = 216;
+  p.letter_bits = 8;
+  const WordRowEncoder enc(p);
+  std::vector<int> a, b;
+  enc.encode_indices("hello", a);
+  enc.encode_indices("help", b);
+  for (auto _ : state) {
+    std::size_t shared = 0;
+    for (std::size_t i = 0, j = 0; i < a.size() && j < b.size();) {
+      if (a[i] == b[j]) {
+        ++shared;
+        ++i;
+        ++j;
+      } else if (a[i] < b[j]) {
+        ++i;
+      } else {
+        ++j;
+      }
+    }
+    benchmark::DoNotOptimize(shared);
+  }
+}
+BENCHMARK(BM_IndexListOverlap);
+
+}  // namespace
@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "encoders/sdr.hpp"
+#include "runtime/column_kernels.hpp"
+
+namespace {
+
+using chat_htm::bench::make_runtime;
+
+/// One TextRuntime::step() per iteration; `steps_per_sec` is the number to
+/// track across htm_flow bumps.
+void run_steps(benchmark::State& state, const std::string& config, int column_cols = 0) {
+  auto runtime = make_runtime(config, column_cols);
+  for (auto _ : state) {
+    runtime->step(1);
+  }
+  state.counters["steps_per_sec"] =
+      benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+void BM_RuntimeStep(benchmark::State& state, const char* config) { run_steps(state, config); }
+BENCHMARK_CAPTURE(BM_RuntimeStep, small_text, "small_text")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_RuntimeStep, default_text, "default_text")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_RuntimeStep, word_rows_text, "word_rows_text")->Unit(benchmark::kMicrosecond);
+
+/// small_text.yaml with every layer's column width set to arg 0.
+void BM_RuntimeStepColumns(benchmark::State& state) {
+  run_steps(state, "small_text", static_cast<int>(state.range(0)));
+  state.counters["columns"] = static_cast<double>(state.range(0));
+}
+BENCHMARK(BM_RuntimeStepColumns)
+    ->RangeMultiplier(2)
+    ->Range(20, 320)
+    ->ArgName("column_cols")
+    ->Unit(benchmark::kMicrosecond);
+
+/// Packing a layer 0 snapshot's predictive columns into a bitset (2048
+/// columns, every seventh predictive).
+void BM_PackPredictiveColumns(benchmark::State& state) {
+  std::vector<htm_gui::ColumnCellMasks> masks(2048);
+  for (std::size_t c = 0; c < masks.size(); c += 7) masks[c].predictive = 1u << (c % 4);
+  chat_htm::Sdr out(masks.size());
+  for (auto _ : state) {
+    chat_htm::column_kernels::pack_predictive(masks.data(), masks.size(), out.words());
+    benchmark::DoNotOptimize(out.words());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(masks.size()));
+}
+BENCHMARK(BM_PackPredictiveColumns);
+
+}  // namespace
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "bench_common.hpp"
+#include "text/text_chunker.hpp"
+#include "text/word_chunker.hpp"
+
+namespace {
+
+using chat_htm::TextChunker;
+using chat_htm::WordChunker;
+using chat_htm::bench::synthetic_text;
+
+void BM_TextChunkerNext(benchmark::State& state) {
+  TextChunker chunker = TextChunker::from_string(synthetic_text(1 << 16));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(chunker.next());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TextChunkerNext);
+
+/// Arg 0: corpus size in bytes; arg 1: tokenizer threads (0 = all cores).
+void BM_WordChunkerTokenize(benchmark::State& state) {
+  const std::string text = synthetic_text(static_cast<std::size_t>(state.range(0)));
+  const int threads = static_cast<int>(state.range(1));
+  for (auto _ : state) {
+    WordChunker chunker = WordChunker::from_string(text, threads);
+    benchmark::DoNotOptimize(chunker.size());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WordChunkerTokenize)
+    ->ArgsProduct({{1 << 16, 1 << 20}, {1, 0}})
+    ->ArgNames({"bytes", "threads"})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_WordChunkerNext(benchmark::State& state) {
+  WordChunker chunker = WordChunker::from_string(synthetic_text(1 << 16));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(chunker.next_id());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WordChunkerNext);
+
+}  // namespace
@@ -0,0 +1,306 @@
+// chat_htm_perf: throughput regression harness.
+//
+// Runs a fixed matrix of TextRuntime configurations, each in its own
+// process so peak RSS and startup are per case, records steps/sec, peak RSS
+// and startup time, and compares them against a baseline JSON.  Exits 1 if
+// any case regressed past its tolerance, so CI can gate on it.  Cases with no
+// baseline entry fail too once the baseline has been recorded; while it is
+// empty they are only reported.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "runtime/perf_baseline.hpp"
+#include "runtime/runtime_batch.hpp"
+
+namespace {
+
+using chat_htm::PerfResult;
+using Clock = std::chrono::steady_clock;
+
+/// One point of the matrix.
+struct PerfCase {
+  std::string config;  ///< Shipped config the case starts from.
+  std::string mode;    ///< "char" or "word_rows"; part of the key only.
+  int columns;         ///< Columns per layer (the config's rows are kept).
+  int layers;          ///< Copies of layer 0 stacked into a region.
+  bool frozen;         ///< freeze_permanences(); segments still grow.
+  int threads;         ///< Independent streams, one worker thread each.
+
+  std::string name() const {
+    return mode + "/c" + std::to_string(columns) + "/l" + std::to_string(layers) + "/"
+           + (frozen ? "frozen" : "learn") + "/t" + std::to_string(threads);
+  }
+};
+
+/// The fixed matrix: one scaling curve per axis through a common base case
+/// (character mode, 400 columns, 1 layer, learning on, 1 thread), rather
+/// than the full product, so a run stays within a CI job's budget.
+std::vector<PerfCase> perf_matrix() {
+  const PerfCase base{"small_text", "char", 400, 1, false, 1};
+  std::vector<PerfCase> cases;
+  for (int columns : {200, 400, 800, 1600, 3200, 6400}) {
+    PerfCase c = base;
+    c.columns = columns;
+    cases.push_back(c);
+  }
+  for (int layers : {2, 3, 4}) {
+    PerfCase c = base;
+    c.layers = layers;
+    cases.push_back(c);
+  }
+  for (int columns : {400, 1600, 6400}) {
+    cases.push_back({"word_rows_text", "word_rows", columns, 1, false, 1});
+  }
+  for (int columns : {400, 6400}) {
+    PerfCase c = base;
+    c.columns = columns;
+    c.frozen = true;
+    cases.push_back(c);
+  }
+  cases.push_back({"word_rows_text", "word_rows", 400, 1, true, 1});
+  for (int threads : {2, 4}) {
+    PerfCase c = base;
+    c.threads = threads;
+    cases.push_back(c);
+  }
+  return cases;
+}
+
+chat_htm::ChatHtmConfig case_config(const PerfCase& c) {
+  auto cfg = chat_htm::bench::bench_config(c.config);
+  auto& region = cfg.region;
+  auto layer0 = region.layers.front();
+  layer0.num_column_cols = std::max(1, c.columns / std::max(1, layer0.num_column_rows));
+  region.layers.assign(static_cast<std::size_t>(c.layers), layer0);
+  chat_htm::chain_layer_inputs(region);
+  if (c.frozen) chat_htm::freeze_permanences(region);
+  return cfg;
+}
+
+/// Child side: build and step one case, print "name sps startup_ms rss_kib".
+int run_case(const PerfCase& c, double seconds) {
+  constexpr int kWarmupSteps = 50;
+  constexpr int kChunk = 50;
+  const auto t0 = Clock::now();
+  const auto cfg = case_config(c);
+  chat_htm::TextRuntimeBatch batch(c.threads);
+  for (int i = 0; i < c.threads; ++i) batch.add(chat_htm::bench::make_runtime(cfg, c.name()));
+  batch.step(1);
+  const double startup_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+  batch.step(kWarmupSteps);
+  std::int64_t steps = 0;
+  const auto start = Clock::now();
+  double elapsed = 0.0;
+  do {
+    batch.step(kChunk);
+    steps += kChunk;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (elapsed < seconds);
+
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);  // ru_maxrss is in KiB on Linux.
+  std::cout << c.name() << ' ' << std::setprecision(10)
+            << static_cast<double>(steps * c.threads) / elapsed << ' ' << startup_ms << ' '
+            << static_cast<std::int64_t>(usage.ru_maxrss) << '\n';
+  return 0;
+}
+
+/// Parent side: run `name` in a fresh process of this binary.
+bool measure(const std::string& self, const std::string& name, double seconds, PerfResult& out) {
+  std::ostringstream cmd;
+  cmd << '\'' << self << "' --case '" << name << "' --seconds " << seconds;
+  FILE* pipe = popen(cmd.str().c_str(), "r");
+  if (!pipe) return false;
+  std::string line;
+  char buf[512];
+  while (std::fgets(buf, sizeof(buf), pipe)) line += buf;
+  if (pclose(pipe) != 0) return false;
+  std::istringstream in(line);
+  return static_cast<bool>(in >> out.name >> out.steps_per_sec >> out.startup_ms >> out.peak_rss_kib)
+         && out.name == name;
+}
+
+std::string self_path(const char* argv0) {
+  std::error_code ec;
+  const auto exe = std::filesystem::read_symlink("/proc/self/exe", ec);
+  return ec ? std::string(argv0) : exe.string();
+}
+
+void usage(const char* prog) {
+  std::cout
+      << "Usage: " << prog << " [OPTIONS]\n\n"
+      << "Run the throughput matrix and compare it with a baseline.\n\n"
+      << "Options:\n"
+      << "  --baseline FILE       Baseline JSON (default: bench/perf/baseline.json)\n"
+      << "  --update-baseline     Write the results to --baseline instead of comparing\n"
+      << "  --require-baseline    Fail cases with no baseline entry (default once the\n"
+      << "                        baseline has any cases)\n"
+      << "  --allow-missing-baseline  Only report cases with no baseline entry (default\n"
+      << "                        while the baseline is empty)\n"
+      << "  --out FILE            Also write the results as JSON to FILE\n"
+      << "  --filter TEXT         Only run cases whose name contains TEXT\n"
+      << "  --seconds S           Timed stepping per case (default: 2)\n"
+      << "  --max-slowdown F      Allowed steps/sec drop, as a fraction (default: 0.15)\n"
+      << "  --max-rss-growth F    Allowed peak RSS growth (default: 0.10)\n"
+      << "  --max-startup-growth F  Allowed startup time growth (default: 0.25)\n"
+      << "  --list                Print the case names and exit\n"
+      << "  -h, --help            Show this help message\n\n"
+      << "Exit status: 0 if no case regressed, 1 on a regression, a failed case or\n"
+      << "(with --require-baseline) a case with no baseline entry,\n"
+      << "2 on a usage or baseline error.\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string baseline_path = CHAT_HTM_SOURCE_DIR "/bench/perf/baseline.json";
+  std::string out_path;
+  std::string filter;
+  std::string case_name;
+  bool update = false;
+  bool list = false;
+  std::optional<bool> require_baseline;  // Unset: required iff the baseline has cases.
+  double seconds = 2.0;
+  chat_htm::PerfTolerance tol;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&](const char* what) -> const char* {
+      if (i + 1 >= argc) {
+        std::cerr << arg << " requires " << what << "\n";
+        return nullptr;
+      }
+      return argv[++i];
+    };
+    const char* v = nullptr;
+    if (arg == "-h" || arg == "--help") { usage(argv[0]); return 0; }
+    if (arg == "--list") { list = true; continue; }
+    if (arg == "--update-baseline") { update = true; continue; }
+    if (arg == "--require-baseline") { require_baseline = true; continue; }
+    if (arg == "--allow-missing-baseline") { require_baseline = false; continue; }
+    if (arg == "--baseline") { if (!(v = value("a file path"))) return 2; baseline_path = v; continue; }
+    if (arg == "--out") { if (!(v = value("a file path"))) return 2; out_path = v; continue; }
+    if (arg == "--filter") { if (!(v = value("text"))) return 2; filter = v; continue; }
+    if (arg == "--case") { if (!(v = value("a case name"))) return 2; case_name = v; continue; }
+    if (arg == "--seconds") { if (!(v = value("a number"))) return 2; seconds = std::atof(v); continue; }
+    if (arg == "--max-slowdown") { if (!(v = value("a fraction"))) return 2; tol.steps_per_sec_drop = std::atof(v); continue; }
+    if (arg == "--max-rss-growth") { if (!(v = value("a fraction"))) return 2; tol.peak_rss_growth = std::atof(v); continue; }
+    if (arg == "--max-startup-growth") { if (!(v = value("a fraction"))) return 2; tol.startup_growth = std::atof(v); continue; }
+    std::cerr << "Unknown option: " << arg << "\n";
+    usage(argv[0]);
+    return 2;
+  }
+  if (seconds <= 0.0) {
+    std::cerr << "--seconds must be > 0\n";
+    return 2;
+  }
+
+  const auto matrix = perf_matrix();
+  if (!case_name.empty()) {
+    for (const PerfCase& c : matrix) {
+      if (c.name() != case_name) continue;
+      try {
+        return run_case(c, seconds);
+      } catch (const std::exception& e) {
+        std::cerr << case_name << ": " << e.what() << "\n";
+        return 1;
+      }
+    }
+    std::cerr << "Unknown case: " << case_name << "\n";
+    return 2;
+  }
+
+  std::vector<PerfCase> cases;
+  std::set<std::string> seen;
+  for (const PerfCase& c : matrix) {
+    const std::string name = c.name();
+    if (name.find(filter) == std::string::npos || !seen.insert(name).second) continue;
+    cases.push_back(c);
+  }
+  if (list) {
+    for (const PerfCase& c : cases) std::cout << c.name() << "\n";
+    return 0;
+  }
+
+  std::vector<PerfResult> baseline;
+  if (!update) {
+    try {
+      baseline = chat_htm::load_perf_results(baseline_path);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << "\n";
+      return 2;
+    }
+  }
+#ifndef NDEBUG
+  std::cerr << "warning: this is not a Release build; timings are not representative\n";
+#endif
+
+  const std::string self = self_path(argv[0]);
+  std::vector<PerfResult> results;
+  int failed = 0;
+  std::cout << std::left << std::setw(28) << "case" << std::right << std::setw(14) << "steps/sec"
+            << std::setw(12) << "startup_ms" << std::setw(12) << "rss_MiB" << "\n";
+  for (const PerfCase& c : cases) {
+    PerfResult r;
+    if (!measure(self, c.name(), seconds, r)) {
+      std::cout << std::left << std::setw(28) << c.name() << "  FAILED\n";
+      ++failed;
+      continue;
+    }
+    std::cout << std::left << std::setw(28) << r.name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(14) << r.steps_per_sec << std::setw(12)
+              << r.startup_ms << std::setw(12) << static_cast<double>(r.peak_rss_kib) / 1024.0
+              << std::defaultfloat << "\n";
+    results.push_back(r);
+  }
+  std::cout << std::setprecision(6);
+
+  const std::string json = chat_htm::perf_results_json(results);
+  for (const std::string& path : {out_path, update ? baseline_path : std::string()}) {
+    if (path.empty()) continue;
+    std::ofstream out(path);
+    if (!(out << json)) {
+      std::cerr << "Cannot write " << path << "\n";
+      return 2;
+    }
+    std::cout << "Results: " << path << "\n";
+  }
+  if (update) return failed ? 1 : 0;
+
+  const auto cmp = chat_htm::compare_perf(baseline, results, tol);
+  const bool require = require_baseline.value_or(!baseline.empty());
+  for (const auto& name : cmp.unmatched) {
+    std::cout << (require ? "MISSING " : "No baseline for ") << name
+              << " (record one with --update-baseline)\n";
+  }
+  for (const auto& reg : cmp.regressions) {
+    std::cout << "REGRESSION " << reg.name << " " << reg.metric << ": " << reg.baseline << " -> "
+              << reg.measured << " (" << std::showpos << std::fixed << std::setprecision(1)
+              << (reg.baseline > 0 ? (reg.measured / reg.baseline - 1.0) * 100.0 : 0.0)
+              << std::noshowpos << std::defaultfloat << "%)\n";
+  }
+  if (failed) std::cout << failed << " case(s) failed to run\n";
+  const bool ok = cmp.ok(require) && failed == 0;
+  std::cout << (ok ? "OK" : "FAIL") << ": " << results.size() << " case(s), "
+            << cmp.regressions.size() << " regression(s), " << cmp.unmatched.size()
+            << " without a baseline\n";
+  return ok ? 0 : 1;
+}
@@ -27,6 +27,8 @@ BUILD_TYPE (first positional arg, default: Release):
 OPTIONS (case-insensitive, any order after BUILD_TYPE):
   GUI              Enable the Qt6 GUI debugger (requires Qt6)
   NOTESTS          Skip building the test suite
+  BENCH            Build chat_htm_perf and chat_htm_bench (the latter needs Google Benchmark)
+  NATIVE           Compile with -march=native (AVX2 SDR kernels on x86)
   CLEAN            Same as passing "clean" as the first argument
 
 COMMANDS:
@@ -38,6 +40,7 @@ Examples:
   ./build.sh Debug                    # Debug build
   ./build.sh Release GUI              # Release + GUI
   ./build.sh Debug GUI NOTESTS        # Debug + GUI, skip tests
+  ./build.sh Release BENCH            # Release + microbenchmarks
   ./build.sh clean                    # Wipe build dir
 EOF
   exit 0
@@ -69,12 +72,16 @@ esac
 # Remaining args = options
 GUI_FLAG="-DHTM_FLOW_WITH_GUI=OFF"
 TESTS_FLAG="-DCHAT_HTM_BUILD_TESTS=ON"
+BENCH_FLAG="-DCHAT_HTM_BUILD_BENCHMARKS=OFF"
+NATIVE_FLAG="-DCHAT_HTM_NATIVE_ARCH=OFF"
 
 for arg in "${@:$START_IDX}"; do
   lower=$(echo "$arg" | tr '[:upper:]' '[:lower:]')
   case "$lower" in
     gui)     GUI_FLAG="-DHTM_FLOW_WITH_GUI=ON" ;;
     notests) TESTS_FLAG="-DCHAT_HTM_BUILD_TESTS=OFF" ;;
+    bench)   BENCH_FLAG="-DCHAT_HTM_BUILD_BENCHMARKS=ON" ;;
+    native)  NATIVE_FLAG="-DCHAT_HTM_NATIVE_ARCH=ON" ;;
     clean)   rm -rf build; echo "Removed build/"; exit 0 ;;
     *)       echo "Unknown option: $arg"; display_help ;;
   esac
@@ -95,12 +102,16 @@ cd build
 echo "Build type:  $BUILD_TYPE"
 echo "GUI:         ${GUI_FLAG##*=}"
 echo "Tests:       ${TESTS_FLAG##*=}"
+echo "Benchmarks:  ${BENCH_FLAG##*=}"
+echo "Native arch: ${NATIVE_FLAG##*=}"
 echo ""
 
 if ! cmake .. \
   -DCMAKE_BUILD_TYPE="$BUILD_TYPE" \
   "$GUI_FLAG" \
   "$TESTS_FLAG" \
+  "$BENCH_FLAG" \
+  "$NATIVE_FLAG" \
   -DBUILD_TESTS=OFF 2>&1; then
 
   # Check if this was a Qt6 / GUI failure
@@ -128,6 +139,12 @@ echo "Build complete.  Binary: build/chat_htm"
 if [[ "$TESTS_FLAG" == *"ON"* ]]; then
   echo "Run tests:   cd build && ctest --output-on-failure"
 fi
+if [[ "$BENCH_FLAG" == *"ON"* ]]; then
+  echo "Perf gate:   build/chat_htm_perf   (compares with bench/perf/baseline.json)"
+fi
+if [[ "$BENCH_FLAG" == *"ON"* && -x chat_htm_bench ]]; then
+  echo "Benchmarks:  build/chat_htm_bench --benchmark_out=bench.json --benchmark_out_format=json"
+fi
 if [[ "$GUI_FLAG" == *"OFF"* ]]; then
   echo "GUI:         Use ./run_gui.sh for the visual debugger (no Qt6 needed)"
 fi
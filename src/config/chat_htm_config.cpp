@@ -0,0 +1,153 @@
+#include "config/chat_htm_config.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include <yaml-cpp/yaml.h>
+
+#include <htm_flow/config_loader.hpp>
+
+namespace chat_htm {
+
+namespace {
+
+/// Read `node[key]` into `out` if present.
+template <typename T>
+void read(const YAML::Node& node, const char* key, T& out) {
+  if (node && node[key]) out = node[key].as<T>();
+}
+
+}  // namespace
+
+TextMode parse_text_mode(const std::string& name) {
+  if (name == "character") return TextMode::Character;
+  if (name == "word_rows") return TextMode::WordRows;
+  if (name == "word_hash") return TextMode::WordHash;
+  throw std::invalid_argument("ChatHtmConfig: unknown text.mode '" + name +
+                              "' (character|word_rows|word_hash)");
+}
+
+const char* text_mode_name(TextMode mode) {
+  switch (mode) {
+    case TextMode::WordRows: return "word_rows";
+    case TextMode::WordHash: return "word_hash";
+    case TextMode::Character: break;
+  }
+  return "character";
+}
+
+ChatHtmConfig ChatHtmConfig::load(const std::string& path) {
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(path);
+  } catch (const YAML::Exception& e) {
+    throw std::runtime_error("ChatHtmConfig: cannot parse " + path + ": " + e.what());
+  }
+
+  ChatHtmConfig cfg;
+  cfg.region = htm_flow::load_region_config(path);
+  try {
+    const YAML::Node text = root["text"];
+    if (text && text["mode"]) cfg.text_mode = parse_text_mode(text["mode"].as<std::string>());
+    read(text, "lowercase", cfg.normalization.lowercase);
+    read(text, "ascii_only", cfg.normalization.ascii_only);
+
+    // All encoders read the same section; keys belong to one mode or another
+    // (`active_bits` and `cache` are shared).
+    const YAML::Node enc = root["encoder"];
+    read(enc, "active_bits", cfg.scalar.w);
+    read(enc, "min_value", cfg.scalar.min_val);
+    read(enc, "max_value", cfg.scalar.max_val);
+    read(enc, "cache", cfg.scalar.cache);
+    read(enc, "letter_bits", cfg.word_rows.letter_bits);
+    read(enc, "alphabet", cfg.word_rows.alphabet);
+    read(enc, "cache", cfg.word_rows.cache);
+    read(enc, "active_bits", cfg.word_hash.w);
+    read(enc, "trigram_bits", cfg.word_hash.trigram_bits);
+    read(enc, "seed", cfg.word_hash.seed);
+    read(enc, "cache", cfg.word_hash.cache);
+
+    read(root, "enable_feedback", cfg.enable_feedback);
+    if (root["threads"]) {
+      throw std::invalid_argument("ChatHtmConfig: " + path
+                                  + ": 'threads' was renamed to 'worker_threads'");
+    }
+    read(root, "worker_threads", cfg.worker_threads);
+    const YAML::Node gui = root["gui"];
+    read(gui, "theme", cfg.gui_theme);
+  } catch (const YAML::Exception& e) {
+    throw std::runtime_error("ChatHtmConfig: bad value in " + path + ": " + e.what());
+  }
+
+  cfg.fit_encoders_to_input();
+  cfg.validate();
+  return cfg;
+}
+
+void chain_layer_inputs(htm_flow::HTMRegionConfig& region) {
+  for (std::size_t k = 1; k < region.layers.size(); ++k) {
+    const auto& below = region.layers[k - 1];
+    region.layers[k].num_input_rows = below.num_column_rows;
+    region.layers[k].num_input_cols = below.num_column_cols * below.cells_per_column;
+  }
+}
+
+ChatHtmConfig ChatHtmConfig::from_region(htm_flow::HTMRegionConfig region, TextMode mode) {
+  ChatHtmConfig cfg;
+  cfg.region = std::move(region);
+  cfg.text_mode = mode;
+  cfg.fit_encoders_to_input();
+  cfg.validate();
+  return cfg;
+}
+
+void ChatHtmConfig::fit_encoders_to_input() {
+  if (region.layers.empty()) return;
+  const auto& in = region.layers.front();
+  scalar.n = in.num_input_rows * in.num_input_cols;
+  word_rows.rows = in.num_input_rows;
+  word_rows.cols = in.num_input_cols;
+  word_hash.n = in.num_input_rows * in.num_input_cols;
+}
+
+int ChatHtmConfig::input_bits() const {
+  if (region.layers.empty()) return 0;
+  return region.layers.front().num_input_rows * region.layers.front().num_input_cols;
+}
+
+void ChatHtmConfig::validate() const {
+  if (region.layers.empty()) {
+    throw std::invalid_argument("ChatHtmConfig: region has no layers");
+  }
+  if (input_bits() <= 0) {
+    throw std::invalid_argument("ChatHtmConfig: layer 0 input must have rows and cols > 0");
+  }
+  if (worker_threads < 0) {
+    throw std::invalid_argument("ChatHtmConfig: worker_threads must be >= 0 (0 = all cores), got "
+                                + std::to_string(worker_threads));
+  }
+  if (!gui_theme.empty() && gui_theme != "light" && gui_theme != "dark") {
+    throw std::invalid_argument("ChatHtmConfig: gui.theme must be light or dark, got '" +
+                                gui_theme + "'");
+  }
+  // The encoders validate their own parameters; build an uncached one.
+  try {
+    if (text_mode == TextMode::WordRows) {
+      auto p = word_rows;
+      p.cache = false;
+      WordRowEncoder check(p);
+    } else if (text_mode == TextMode::WordHash) {
+      auto p = word_hash;
+      p.cache = false;
+      WordHashEncoder check(p);
+    } else {
+      auto p = scalar;
+      p.cache = false;
+      ScalarEncoder check(p);
+    }
+  } catch (const std::invalid_argument& e) {
+    throw std::invalid_argument(std::string("ChatHtmConfig: encoder: ") + e.what());
+  }
+}
+
+}  // namespace chat_htm
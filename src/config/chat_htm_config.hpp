@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+
+#include <htm_flow/config.hpp>
+
+#include "encoders/scalar_encoder.hpp"
+#include "encoders/word_hash_encoder.hpp"
+#include "encoders/word_row_encoder.hpp"
+#include "text/text_preprocess.hpp"
+
+namespace chat_htm {
+
+/// How text is fed to the region (`text.mode`).
+enum class TextMode {
+  Character,  ///< One byte per step through the ScalarEncoder.
+  WordRows,   ///< One word per step through the WordRowEncoder.
+  WordHash    ///< One word per step through the WordHashEncoder.
+};
+
+/// Everything a chat_htm run reads from its YAML config, parsed once.
+///
+/// The chat_htm sections (`text`, `encoder`, `gui`, `worker_threads`,
+/// `enable_feedback`) are read from a single YAML parse; `region` comes from htm_flow's loader,
+/// which only accepts a file path and so reads the file once more.  Encoder
+/// sizes that must match layer 0 (`scalar.n`, `word_rows.rows/cols`,
+/// `word_hash.n`) are
+/// derived from the region rather than read.
+///
+/// Configs can also be assembled in memory (from_region()), e.g. by the
+/// sweep runner, without touching YAML at all.
+struct ChatHtmConfig {
+  TextMode text_mode{TextMode::Character};
+  TextNormalization normalization;     ///< Character mode only.
+  ScalarEncoder::Params scalar;        ///< Used in character mode.
+  WordRowEncoder::Params word_rows;    ///< Used in word_rows mode.
+  WordHashEncoder::Params word_hash;   ///< Used in word_hash mode.
+  bool enable_feedback{false};         ///< htm_flow's top-level key.
+  /// Cap on the threads chat_htm itself starts (`worker_threads`, 0 = all
+  /// cores): corpus normalization and tokenization, concurrent sweep runs
+  /// and the one-thread-per-layer pipeline.  It does not parallelize a
+  /// layer's step; htm_flow runs each layer on the calling thread.
+  int worker_threads{0};
+  std::string gui_theme;               ///< "light", "dark" or empty (GUI default).
+  htm_flow::HTMRegionConfig region;
+
+  /// Parse and validate `path`.  Throws std::runtime_error if the file
+  /// cannot be read or parsed and std::invalid_argument for bad values.
+  static ChatHtmConfig load(const std::string& path);
+
+  /// Config with default chat_htm sections around `region`, encoders sized
+  /// to its layer 0.  Throws std::invalid_argument if `region` is invalid.
+  static ChatHtmConfig from_region(htm_flow::HTMRegionConfig region,
+                                   TextMode mode = TextMode::Character);
+
+  /// Resize the encoders to layer 0's input (call after editing `region`).
+  void fit_encoders_to_input();
+
+  /// Throws std::invalid_argument describing the first invalid setting,
+  /// including encoder parameters for the active text mode.
+  void validate() const;
+
+  /// Layer 0 input size in bits.
+  int input_bits() const;
+};
+
+/// Parse `character`, `word_rows` or `word_hash`.  Throws std::invalid_argument otherwise.
+TextMode parse_text_mode(const std::string& name);
+const char* text_mode_name(TextMode mode);
+
+/// Size each upper layer's input to the output of the layer below it
+/// (`num_column_rows` rows of `num_column_cols * cells_per_column` cells).
+/// Call after changing a layer's column grid or cells per column.
+void chain_layer_inputs(htm_flow::HTMRegionConfig& region);
+
+}  // namespace chat_htm
@@ -0,0 +1,69 @@
+#include "config/region_footprint.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace chat_htm {
+
+namespace {
+
+constexpr std::int64_t kBytesPerSynapse = 8;  ///< float permanence + int32 index.
+constexpr std::int64_t kBytesPerColumn = 16;  ///< Overlap, boost and duty cycles.
+constexpr std::int64_t kBytesPerCell = 8;     ///< Current and previous state flags.
+
+std::int64_t positive(int v) { return std::max(0, v); }
+
+}  // namespace
+
+std::int64_t LayerFootprint::bytes() const {
+  return (proximal_synapses + distal_synapses) * kBytesPerSynapse + columns * kBytesPerColumn
+         + cells * kBytesPerCell;
+}
+
+std::int64_t RegionFootprint::bytes() const {
+  std::int64_t total = 0;
+  for (const auto& l : layers) total += l.bytes();
+  return total;
+}
+
+std::int64_t RegionFootprint::proximal_synapses() const {
+  std::int64_t total = 0;
+  for (const auto& l : layers) total += l.proximal_synapses;
+  return total;
+}
+
+std::int64_t RegionFootprint::distal_synapses() const {
+  std::int64_t total = 0;
+  for (const auto& l : layers) total += l.distal_synapses;
+  return total;
+}
+
+RegionFootprint estimate_footprint(const htm_flow::HTMRegionConfig& region) {
+  RegionFootprint fp;
+  fp.layers.reserve(region.layers.size());
+  for (const auto& cfg : region.layers) {
+    LayerFootprint l;
+    l.columns = positive(cfg.num_column_rows) * positive(cfg.num_column_cols);
+    l.cells = l.columns * positive(cfg.cells_per_column);
+    l.proximal_synapses = l.columns * positive(cfg.pot_width) * positive(cfg.pot_height);
+    l.distal_synapses =
+        l.cells * positive(cfg.max_segments_per_cell) * positive(cfg.max_synapses_per_segment);
+    fp.layers.push_back(l);
+  }
+  return fp;
+}
+
+std::string format_bytes(std::int64_t bytes) {
+  static const char* const kUnits[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  double v = static_cast<double>(bytes);
+  int unit = 0;
+  while (v >= 1024.0 && unit < 4) {
+    v /= 1024.0;
+    ++unit;
+  }
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), unit == 0 ? "%.0f %s" : "%.1f %s", v, kUnits[unit]);
+  return buf;
+}
+
+}  // namespace chat_htm
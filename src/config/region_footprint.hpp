@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <htm_flow/config.hpp>
+
+namespace chat_htm {
+
+/// Heuristic size of one layer once every cell has grown its maximum
+/// number of distal segments and synapses.
+struct LayerFootprint {
+  std::int64_t columns{0};
+  std::int64_t cells{0};
+  std::int64_t proximal_synapses{0};  ///< columns * pot_width * pot_height.
+  std::int64_t distal_synapses{0};    ///< cells * max_segments_per_cell * max_synapses_per_segment.
+
+  /// Bytes at 8 per synapse (a float permanence and an int32 index), 16
+  /// per column and 8 per cell of state: what a structure-of-arrays arena
+  /// sized from the config up front would need.
+  std::int64_t bytes() const;
+};
+
+/// Configuration-derived memory estimate for a whole region.
+///
+/// htm_flow allocates its synapse structures itself and exposes no
+/// allocator hook or size query, so this is a heuristic from the config and
+/// assumed per-element sizes, not a measurement and not an upper bound:
+/// htm_flow's containers, padding and allocator slack are not counted.  It
+/// shows how configs compare and where memory goes, not what a pod needs.
+struct RegionFootprint {
+  std::vector<LayerFootprint> layers;
+
+  std::int64_t bytes() const;
+  std::int64_t proximal_synapses() const;
+  std::int64_t distal_synapses() const;
+};
+
+/// Estimate `region`'s footprint.  Negative or zero sizes count as zero.
+RegionFootprint estimate_footprint(const htm_flow::HTMRegionConfig& region);
+
+/// `bytes` as a short human-readable size, e.g. "12.3 MiB".
+std::string format_bytes(std::int64_t bytes);
+
+}  // namespace chat_htm
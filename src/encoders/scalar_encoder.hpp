@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstdlib>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "encoders/sdr.hpp"
+#include "encoders/sdr_table.hpp"
+
 namespace chat_htm {
 
 /// Encodes a scalar value into a Sparse Distributed Representation (SDR).
@@ -25,6 +29,7 @@ public:
     int w = 21;          ///< Number of active (1) bits per encoding.
     int min_val = 0;     ///< Minimum input value (inclusive).
     int max_val = 127;   ///< Maximum input value (inclusive).
+    bool cache = false;  ///< Precompute every encoding at construction.
   };
 
   ScalarEncoder() : ScalarEncoder(Params{}) {}
@@ -35,23 +40,13 @@ public:
     // positions 0 .. (n - w).
     num_buckets_ = params_.n - params_.w;
     range_ = params_.max_val - params_.min_val;
+    if (params_.cache) build_table();
   }
 
   /// Encode a scalar value into a binary SDR of length `n`.
   /// Values outside [min_val, max_val] are clamped.
   std::vector<int> encode(int value) const {
-    // Clamp to valid range.
-    if (value < params_.min_val) value = params_.min_val;
-    if (value > params_.max_val) value = params_.max_val;
-
-    // Compute the starting position of the active window.
-    int start = 0;
-    if (range_ > 0) {
-      start = static_cast<int>(
-          static_cast<double>(value - params_.min_val) / range_ * num_buckets_ + 0.5);
-    }
-    if (start > num_buckets_) start = num_buckets_;
-
+    const int start = window_start(value);
     std::vector<int> sdr(static_cast<std::size_t>(params_.n), 0);
     for (int i = start; i < start + params_.w; ++i) {
       sdr[static_cast<std::size_t>(i)] = 1;
@@ -59,16 +54,52 @@ public:
     return sdr;
   }
 
+  /// Encode a scalar value as the ascending list of its `w` active bit
+  /// indices.  `out` is overwritten; its capacity is reused across calls so
+  /// the per-step path does not allocate.
+  void encode_indices(int value, std::vector<int>& out) const {
+    if (cached()) {
+      const SdrView v = table_[row_for(value)];
+      out.assign(v.begin(), v.end());
+      return;
+    }
+    const int start = window_start(value);
+    out.resize(static_cast<std::size_t>(params_.w));
+    for (int i = 0; i < params_.w; ++i) {
+      out[static_cast<std::size_t>(i)] = start + i;
+    }
+  }
+
+  /// Encode a scalar value as a bit-packed Sdr of `n` bits.
+  Sdr encode_sdr(int value) const {
+    Sdr sdr(static_cast<std::size_t>(params_.n));
+    const int start = window_start(value);
+    for (int i = start; i < start + params_.w; ++i) sdr.set(static_cast<std::size_t>(i));
+    return sdr;
+  }
+
+  /// Active bit indices of `value`, viewed directly in the precomputed table.
+  /// Requires the encoder to have been built with `Params::cache = true`.
+  SdrView active_indices(int value) const {
+    if (!cached()) {
+      throw std::logic_error("ScalarEncoder: active_indices() requires Params::cache");
+    }
+    return table_[row_for(value)];
+  }
+
+  /// True if every encoding was precomputed at construction.
+  bool cached() const { return !table_.empty(); }
+
   /// Return the number of active bits that two encoded values share.
-  /// Useful for verifying semantic overlap.
+  /// Useful for verifying semantic overlap.  Equal to
+  /// `encode_sdr(a).overlap(encode_sdr(b))`, computed in O(1).
   int overlap(int val_a, int val_b) const {
-    auto a = encode(val_a);
-    auto b = encode(val_b);
-    int count = 0;
-    for (std::size_t i = 0; i < a.size(); ++i) {
-      if (a[i] && b[i]) ++count;
-    }
-    return count;
+    // Both encodings are contiguous windows of `w` bits, so the overlap
+    // follows from the window starts alone.
+    const int a = cached() ? table_[row_for(val_a)][0] : window_start(val_a);
+    const int b = cached() ? table_[row_for(val_b)][0] : window_start(val_b);
+    const int shared = params_.w - std::abs(a - b);
+    return shared > 0 ? shared : 0;
   }
 
   const Params& params() const { return params_; }
@@ -76,6 +107,40 @@ public:
   int active_bits() const { return params_.w; }
 
 private:
+  /// First active bit of the window for `value` (clamped to the range).
+  int window_start(int value) const {
+    if (value < params_.min_val) value = params_.min_val;
+    if (value > params_.max_val) value = params_.max_val;
+
+    int start = 0;
+    if (range_ > 0) {
+      start = static_cast<int>(
+          static_cast<double>(value - params_.min_val) / range_ * num_buckets_ + 0.5);
+    }
+    if (start > num_buckets_) start = num_buckets_;
+    return start;
+  }
+
+  /// Table row for `value` (clamped to the range).
+  std::size_t row_for(int value) const {
+    if (value < params_.min_val) value = params_.min_val;
+    if (value > params_.max_val) value = params_.max_val;
+    return static_cast<std::size_t>(value - params_.min_val);
+  }
+
+  void build_table() {
+    const int values = params_.max_val - params_.min_val + 1;
+    table_.reserve(static_cast<std::size_t>(values), static_cast<std::size_t>(params_.w));
+    std::vector<int> active(static_cast<std::size_t>(params_.w));
+    for (int v = params_.min_val; v <= params_.max_val; ++v) {
+      const int start = window_start(v);
+      for (int i = 0; i < params_.w; ++i) {
+        active[static_cast<std::size_t>(i)] = start + i;
+      }
+      table_.add(active);
+    }
+  }
+
   void validate() const {
     if (params_.n <= 0)
       throw std::invalid_argument("ScalarEncoder: n must be > 0");
@@ -90,6 +155,7 @@ private:
   Params params_;
   int num_buckets_{0};
   double range_{0.0};
+  SdrTable table_;  ///< One row per value in [min_val, max_val] when cached.
 };
 
 }  // namespace chat_htm
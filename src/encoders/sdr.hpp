@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "encoders/sdr_kernels.hpp"
+#include "encoders/sdr_table.hpp"
+
+namespace chat_htm {
+
+/// Bit-packed binary SDR: `size()` bits in 64-bit words.
+///
+/// A 1080-bit word-row input is 17 words instead of 1080 ints, and
+/// overlap / union / Hamming distance are popcounts over those words (see
+/// sdr_kernels).  Converts to and from the sparse index form (SdrView) that
+/// encoders and TextRuntime pass around.  Bits past size() in the last word
+/// are always zero.
+class Sdr {
+public:
+  Sdr() = default;
+  explicit Sdr(std::size_t size) : size_(size), words_((size + 63) / 64, 0) {}
+
+  /// Sdr of `size` bits with `active` set.  Throws std::out_of_range for
+  /// an index outside [0, size).
+  static Sdr from_indices(std::size_t size, SdrView active) {
+    Sdr s(size);
+    s.set_indices(active);
+    return s;
+  }
+  /// Sdr from a dense 0/1 vector (any non-zero counts as set).
+  static Sdr from_dense(const std::vector<int>& dense) {
+    Sdr s(dense.size());
+    for (std::size_t i = 0; i < dense.size(); ++i) {
+      if (dense[i]) s.words_[i >> 6] |= std::uint64_t{1} << (i & 63);
+    }
+    return s;
+  }
+
+  std::size_t size() const { return size_; }
+  std::size_t num_words() const { return words_.size(); }
+  const std::uint64_t* words() const { return words_.data(); }
+  /// Writable words, for kernels that fill a whole Sdr at once.  Bits past
+  /// size() in the last word must be left zero.
+  std::uint64_t* words() { return words_.data(); }
+
+  bool test(std::size_t i) const { return (words_[i >> 6] >> (i & 63)) & 1u; }
+  void set(std::size_t i) {
+    check(i);
+    words_[i >> 6] |= std::uint64_t{1} << (i & 63);
+  }
+  void clear(std::size_t i) {
+    check(i);
+    words_[i >> 6] &= ~(std::uint64_t{1} << (i & 63));
+  }
+  /// Clear every bit.
+  void reset() { std::fill(words_.begin(), words_.end(), 0); }
+  /// Replace the contents with exactly the bits in `active`.
+  void set_indices(SdrView active) {
+    reset();
+    for (int idx : active) {
+      if (idx < 0) throw std::out_of_range("Sdr: negative index");
+      set(static_cast<std::size_t>(idx));
+    }
+  }
+
+  /// Number of set bits.
+  std::size_t count() const { return sdr_kernels::popcount(words_.data(), words_.size()); }
+  bool empty() const { return count() == 0; }
+
+  /// Ascending active indices written to `out` (overwritten; its capacity
+  /// is reused).
+  void indices(std::vector<int>& out) const {
+    out.clear();
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+      std::uint64_t bits = words_[w];
+      while (bits) {
+        out.push_back(static_cast<int>(w * 64 + static_cast<std::size_t>(sdr_kernels::ctz64(bits))));
+        bits &= bits - 1;
+      }
+    }
+  }
+  std::vector<int> indices() const {
+    std::vector<int> out;
+    indices(out);
+    return out;
+  }
+
+  /// Shared active bits, |a AND b|.
+  std::size_t overlap(const Sdr& other) const {
+    require_same_size(other);
+    return sdr_kernels::and_popcount(words_.data(), other.words_.data(), words_.size());
+  }
+  /// Bits that differ, |a XOR b|.
+  std::size_t hamming(const Sdr& other) const {
+    require_same_size(other);
+    return sdr_kernels::xor_popcount(words_.data(), other.words_.data(), words_.size());
+  }
+  /// Size of the union, |a OR b|, without materializing it.
+  std::size_t union_count(const Sdr& other) const {
+    require_same_size(other);
+    return sdr_kernels::or_popcount(words_.data(), other.words_.data(), words_.size());
+  }
+
+  Sdr& operator|=(const Sdr& other) {
+    require_same_size(other);
+    sdr_kernels::or_into(words_.data(), other.words_.data(), words_.size());
+    return *this;
+  }
+  Sdr& operator&=(const Sdr& other) {
+    require_same_size(other);
+    sdr_kernels::and_into(words_.data(), other.words_.data(), words_.size());
+    return *this;
+  }
+  friend Sdr operator|(Sdr a, const Sdr& b) { return a |= b; }
+  friend Sdr operator&(Sdr a, const Sdr& b) { return a &= b; }
+
+  bool operator==(const Sdr& other) const { return size_ == other.size_ && words_ == other.words_; }
+  bool operator!=(const Sdr& other) const { return !(*this == other); }
+
+private:
+  void check(std::size_t i) const {
+    if (i >= size_) throw std::out_of_range("Sdr: index out of range");
+  }
+  void require_same_size(const Sdr& other) const {
+    if (size_ != other.size_) throw std::invalid_argument("Sdr: size mismatch");
+  }
+
+  std::size_t size_{0};
+  std::vector<std::uint64_t> words_;
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace chat_htm {
+
+/// Read-only view of one sparse encoding (ascending active bit indices).
+///
+/// Points into storage owned elsewhere (an SdrTable or a std::vector<int>);
+/// the view must not outlive that storage.
+struct SdrView {
+  const int* data{nullptr};
+  std::size_t size{0};
+
+  SdrView() = default;
+  SdrView(const int* d, std::size_t n) : data(d), size(n) {}
+  /// Implicit so a scratch std::vector<int> can be passed where a view is expected.
+  SdrView(const std::vector<int>& v) : data(v.data()), size(v.size()) {}
+
+  const int* begin() const { return data; }
+  const int* end() const { return data + size; }
+  bool empty() const { return size == 0; }
+  int operator[](std::size_t i) const { return data[i]; }
+};
+
+/// Contiguous table of sparse encodings addressed by a dense row id.
+///
+/// All rows share one index buffer plus an offsets array, so a lookup is two
+/// loads and the whole table stays cache-friendly.  Used by the encoders'
+/// cached modes to precompute every SDR once.
+class SdrTable {
+public:
+  SdrTable() = default;
+
+  /// Rebuild a table from its raw storage (see indices() / offsets()).
+  static SdrTable from_raw(std::vector<int> indices, std::vector<std::uint32_t> offsets) {
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != indices.size()) {
+      throw std::invalid_argument("SdrTable: offsets do not match indices");
+    }
+    for (std::size_t i = 1; i < offsets.size(); ++i) {
+      if (offsets[i] < offsets[i - 1]) {
+        throw std::invalid_argument("SdrTable: offsets must be ascending");
+      }
+    }
+    SdrTable t;
+    t.indices_ = std::move(indices);
+    t.offsets_ = std::move(offsets);
+    return t;
+  }
+
+  /// Append one encoding and return its row id.
+  std::uint32_t add(SdrView active) {
+    indices_.insert(indices_.end(), active.begin(), active.end());
+    offsets_.push_back(static_cast<std::uint32_t>(indices_.size()));
+    return static_cast<std::uint32_t>(offsets_.size() - 2);
+  }
+
+  /// Pre-size the table for `rows` encodings of roughly `bits_per_row` bits.
+  void reserve(std::size_t rows, std::size_t bits_per_row) {
+    offsets_.reserve(rows + 1);
+    indices_.reserve(rows * bits_per_row);
+  }
+
+  SdrView operator[](std::size_t row) const {
+    const std::uint32_t begin = offsets_[row];
+    return {indices_.data() + begin, static_cast<std::size_t>(offsets_[row + 1] - begin)};
+  }
+
+  SdrView at(std::size_t row) const {
+    if (row >= size()) throw std::out_of_range("SdrTable: row out of range");
+    return (*this)[row];
+  }
+
+  /// Number of encodings stored.
+  std::size_t size() const { return offsets_.size() - 1; }
+  bool empty() const { return size() == 0; }
+
+  void clear() {
+    indices_.clear();
+    offsets_.assign(1, 0);
+  }
+
+  /// Raw storage (used when serialising the table).
+  const std::vector<int>& indices() const { return indices_; }
+  const std::vector<std::uint32_t>& offsets() const { return offsets_; }
+
+private:
+  std::vector<int> indices_;
+  std::vector<std::uint32_t> offsets_{0};
+};
+
+/// Encode every word in `vocabulary` into one table, row `i` holding
+/// `encoder.encode_indices(vocabulary[i])`, so a WordChunker id addresses
+/// its word's encoding directly.  The table keeps no copy of the words; the
+/// chunker's arena already owns them.  Shared by the word encoders'
+/// cache_vocabulary().
+template <class Encoder>
+SdrTable encode_vocabulary(const Encoder& encoder,
+                           const std::vector<std::string_view>& vocabulary,
+                           std::size_t bits_per_row) {
+  SdrTable table;
+  table.reserve(vocabulary.size(), bits_per_row);
+  std::vector<int> active;
+  for (std::string_view word : vocabulary) {
+    encoder.encode_indices(word, active);
+    table.add(active);
+  }
+  return table;
+}
+
+}  // namespace chat_htm
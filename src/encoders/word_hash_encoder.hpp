@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "encoders/sdr.hpp"
+#include "encoders/sdr_table.hpp"
+
+namespace chat_htm {
+
+/// Encodes a word into a fixed-size, fixed-sparsity SDR by hashing.
+///
+/// Every word activates exactly `w` of `n` bits, whatever its length, so the
+/// layer 0 input is sized by the desired sparsity rather than by the longest
+/// word or the vocabulary.  The bits are drawn from a seeded pseudo-random
+/// stream keyed on the word; encoding costs O(w) hash draws, never O(n).
+///
+/// With `trigram_bits > 0`, that many of the `w` bits are instead drawn
+/// round-robin from the character trigrams of `^word$`, so words sharing
+/// spelling (e.g. "learn" / "learning") share bits while the remaining
+/// `w - trigram_bits` whole-word bits keep distinct words apart.
+///
+/// Words are hashed as given (the WordChunker already lowercases them).
+/// With `Params::cache` set, cache_vocabulary() memoizes the encoding of
+/// every known word in one contiguous table, as WordRowEncoder does.
+class WordHashEncoder {
+public:
+  struct Params {
+    int n = 400;            ///< Total bits (layer 0 input size).
+    int w = 21;             ///< Active bits per word.
+    int trigram_bits = 0;   ///< Of the `w` bits, how many come from trigrams.
+    std::uint64_t seed = 0; ///< Changes every encoding; keep fixed per model.
+    bool cache = false;     ///< Memoize whole-word encodings (see cache_vocabulary()).
+  };
+
+  explicit WordHashEncoder(const Params& p) : params_(p) { validate(); }
+
+  std::vector<int> encode(std::string_view word) const {
+    std::vector<int> active;
+    encode_indices(word, active);
+    std::vector<int> sdr(static_cast<std::size_t>(total_bits()), 0);
+    for (int idx : active) {
+      sdr[static_cast<std::size_t>(idx)] = 1;
+    }
+    return sdr;
+  }
+
+  /// Encode a word as a bit-packed Sdr of total_bits() bits.
+  Sdr encode_sdr(std::string_view word) const {
+    std::vector<int> active;
+    encode_indices(word, active);
+    return Sdr::from_indices(static_cast<std::size_t>(total_bits()), active);
+  }
+
+  /// Encode a word as the ascending list of its `w` active bit indices.
+  /// `out` is overwritten and its capacity reused, so repeated calls do not
+  /// allocate.  Colliding draws are redrawn from the same stream, so the
+  /// count is exact.
+  void encode_indices(std::string_view word, std::vector<int>& out) const {
+    out.clear();
+    std::uint64_t word_state = hash_bytes(word, params_.seed);
+    const int trigram_bits = word.empty() ? 0 : params_.trigram_bits;
+    for (int i = 0; i < params_.w - trigram_bits; ++i) {
+      draw_unique(word_state, out);
+    }
+    if (trigram_bits == 0) return;
+
+    // Trigrams of "^word$": word.size() of them, each keyed on its three
+    // bytes (boundary markers included) and drawn from in turn.
+    const std::size_t num_trigrams = word.size();
+    std::uint64_t states[kMaxTrigramStreams];
+    const std::size_t streams = std::min<std::size_t>(num_trigrams, kMaxTrigramStreams);
+    for (std::size_t t = 0; t < streams; ++t) {
+      const char gram[3] = {t == 0 ? '^' : word[t - 1], word[t],
+                            t + 1 < word.size() ? word[t + 1] : '$'};
+      states[t] = hash_bytes(std::string_view(gram, 3), params_.seed ^ kGoldenGamma);
+    }
+    for (int i = 0; i < trigram_bits; ++i) {
+      draw_unique(states[static_cast<std::size_t>(i) % streams], out);
+    }
+  }
+
+  /// Precompute the encoding of every word in `vocabulary`.  Entries must be
+  /// distinct; row `i` of word_table() encodes `vocabulary[i]`, so callers
+  /// holding WordChunker ids can use cached_indices(id) directly.
+  /// Replaces any previously cached words.
+  void cache_vocabulary(const std::vector<std::string_view>& vocabulary) {
+    word_table_ = encode_vocabulary(*this, vocabulary, static_cast<std::size_t>(params_.w));
+  }
+
+  /// True if cache_vocabulary() has been called with a non-empty vocabulary.
+  bool has_word_cache() const { return !word_table_.empty(); }
+
+  /// Memoized encoding of vocabulary entry `id` (see cache_vocabulary()).
+  SdrView cached_indices(std::uint32_t id) const { return word_table_[id]; }
+
+  /// The memoized word encodings, one row per cached word.
+  const SdrTable& word_table() const { return word_table_; }
+
+  const Params& params() const { return params_; }
+  int total_bits() const { return params_.n; }
+
+private:
+  /// Only a word's first kMaxTrigramStreams trigrams are hashed (and only
+  /// the first `trigram_bits` of those ever contribute a bit).
+  static constexpr std::size_t kMaxTrigramStreams = 32;
+  /// splitmix64 stream increment; also salts trigram hashes apart from words.
+  static constexpr std::uint64_t kGoldenGamma = 0x9e3779b97f4a7c15ULL;
+
+  void validate() const {
+    if (params_.n <= 0) throw std::invalid_argument("WordHashEncoder: n must be > 0");
+    if (params_.w <= 0) throw std::invalid_argument("WordHashEncoder: w must be > 0");
+    if (params_.w >= params_.n) throw std::invalid_argument("WordHashEncoder: w must be < n");
+    if (params_.trigram_bits < 0 || params_.trigram_bits > params_.w) {
+      throw std::invalid_argument("WordHashEncoder: trigram_bits must be in [0, w]");
+    }
+  }
+
+  /// FNV-1a over `bytes`, seeded, then finalized so nearby inputs diverge.
+  static std::uint64_t hash_bytes(std::string_view bytes, std::uint64_t seed) {
+    std::uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+    for (char c : bytes) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 0x100000001b3ULL;
+    }
+    return mix(h);
+  }
+
+  /// splitmix64 finalizer.
+  static std::uint64_t mix(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  /// Insert the next bit of `state`'s stream not already in `out`, keeping
+  /// `out` sorted.  The duplicate check is a binary search, so a word costs
+  /// O(w log w) comparisons; the insert shifts at most `w` ints, a short
+  /// memmove.  The sorted result is the same set as drawing then sorting.
+  void draw_unique(std::uint64_t& state, std::vector<int>& out) const {
+    for (;;) {
+      state += kGoldenGamma;
+      const int bit = static_cast<int>(mix(state) % static_cast<std::uint64_t>(params_.n));
+      const auto it = std::lower_bound(out.begin(), out.end(), bit);
+      if (it == out.end() || *it != bit) {
+        out.insert(it, bit);
+        return;
+      }
+    }
+  }
+
+  Params params_;
+  SdrTable word_table_;
+};
+
+}  // namespace chat_htm
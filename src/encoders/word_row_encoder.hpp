@@ -1,16 +1,26 @@
 #pragma once
 
+#include <array>
 #include <cctype>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "encoders/sdr.hpp"
+#include "encoders/sdr_table.hpp"
+
 namespace chat_htm {
 
 /// Encodes a word into a row-wise SDR.
 ///
 /// For each row (character position), one letter-specific non-overlapping
 /// bit block is activated in that row. Rows beyond the word length stay zero.
+///
+/// Letter-to-block lookups go through a 256-entry table built at
+/// construction.  With `Params::cache` set, cache_vocabulary() additionally
+/// memoizes the full encoding of every known word in one contiguous table.
 class WordRowEncoder {
 public:
   struct Params {
@@ -18,24 +28,64 @@ public:
     int cols = 108;
     int letter_bits = 4;
     std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+    bool cache = false;  ///< Memoize whole-word encodings (see cache_vocabulary()).
   };
 
-  explicit WordRowEncoder(const Params& p) : params_(p) { validate(); }
+  explicit WordRowEncoder(const Params& p) : params_(p) {
+    validate();
+    build_bucket_table();
+  }
+
+  std::vector<int> encode(std::string_view word) const {
+    std::vector<int> active;
+    encode_indices(word, active);
+    std::vector<int> sdr(static_cast<std::size_t>(total_bits()), 0);
+    for (int idx : active) {
+      sdr[static_cast<std::size_t>(idx)] = 1;
+    }
+    return sdr;
+  }
+
+  /// Encode a word as a bit-packed Sdr of total_bits() bits.
+  Sdr encode_sdr(std::string_view word) const {
+    std::vector<int> active;
+    encode_indices(word, active);
+    return Sdr::from_indices(static_cast<std::size_t>(total_bits()), active);
+  }
 
-  std::vector<int> encode(const std::string& word) const {
-    std::vector<int> sdr(static_cast<std::size_t>(params_.rows * params_.cols), 0);
+  /// Encode a word as the ascending list of its active bit indices
+  /// (`letter_bits` per encoded row).  `out` is overwritten and its capacity
+  /// reused, so repeated calls do not allocate.
+  void encode_indices(std::string_view word, std::vector<int>& out) const {
+    out.clear();
     for (int r = 0; r < params_.rows; ++r) {
       if (r >= static_cast<int>(word.size())) break;
       const int bucket = bucket_for_char(word[static_cast<std::size_t>(r)]);
-      const int start_col = bucket * params_.letter_bits;
-      const int row_offset = r * params_.cols;
+      const int start = r * params_.cols + bucket * params_.letter_bits;
       for (int i = 0; i < params_.letter_bits; ++i) {
-        sdr[static_cast<std::size_t>(row_offset + start_col + i)] = 1;
+        out.push_back(start + i);
       }
     }
-    return sdr;
   }
 
+  /// Precompute the encoding of every word in `vocabulary`.  Entries must be
+  /// distinct; row `i` of word_table() encodes `vocabulary[i]`, so callers
+  /// holding WordChunker ids can use cached_indices(id) directly.
+  /// Replaces any previously cached words.
+  void cache_vocabulary(const std::vector<std::string_view>& vocabulary) {
+    word_table_ = encode_vocabulary(*this, vocabulary,
+                                    static_cast<std::size_t>(params_.rows * params_.letter_bits));
+  }
+
+  /// True if cache_vocabulary() has been called with a non-empty vocabulary.
+  bool has_word_cache() const { return !word_table_.empty(); }
+
+  /// Memoized encoding of vocabulary entry `id` (see cache_vocabulary()).
+  SdrView cached_indices(std::uint32_t id) const { return word_table_[id]; }
+
+  /// The memoized word encodings, one row per cached word.
+  const SdrTable& word_table() const { return word_table_; }
+
   const Params& params() const { return params_; }
   int total_bits() const { return params_.rows * params_.cols; }
 
@@ -53,15 +103,23 @@ private:
     }
   }
 
+  void build_bucket_table() {
+    for (int c = 0; c < 256; ++c) {
+      char lc = static_cast<char>(std::tolower(c));
+      auto idx = params_.alphabet.find(lc);
+      bucket_of_[static_cast<std::size_t>(c)] =
+          (idx == std::string::npos) ? static_cast<int>(params_.alphabet.size())
+                                     : static_cast<int>(idx);
+    }
+  }
+
   int bucket_for_char(char c) const {
-    unsigned char uc = static_cast<unsigned char>(c);
-    char lc = static_cast<char>(std::tolower(uc));
-    auto idx = params_.alphabet.find(lc);
-    if (idx == std::string::npos) return static_cast<int>(params_.alphabet.size());
-    return static_cast<int>(idx);
+    return bucket_of_[static_cast<unsigned char>(c)];
   }
 
   Params params_;
+  std::array<int, 256> bucket_of_{};  ///< Byte -> letter block (unknown = alphabet size).
+  SdrTable word_table_;
 };
 
 }  // namespace chat_htm
@@ -1,17 +1,28 @@
+#include <cstdint>
 #include <cstdlib>
 #include <algorithm>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
-
-#include <yaml-cpp/yaml.h>
+#include <vector>
 
 #include <htm_flow/config_loader.hpp>
 
+#include "config/chat_htm_config.hpp"
+#include "config/region_footprint.hpp"
 #include "encoders/scalar_encoder.hpp"
 #include "encoders/word_row_encoder.hpp"
+#include "runtime/generator.hpp"
+#include "runtime/metrics_server.hpp"
+#include "runtime/classifier_replicas.hpp"
+#include "runtime/sweep.hpp"
 #include "runtime/text_runtime.hpp"
+#include "text/corpus_cache.hpp"
+#include "text/mapped_text_chunker.hpp"
+#include "text/sharded_corpus.hpp"
 #include "text/text_chunker.hpp"
 #include "text/word_chunker.hpp"
 
@@ -21,15 +32,36 @@
 
 namespace {
 
-enum class TextMode {
-  Character,
-  WordRows
-};
+/// Old flag names, rejected so scripts relying on them learn what the new
+/// flag does not promise.  Prints the error and returns true for one.
+bool renamed_flag(const std::string& arg) {
+  struct Renamed {
+    const char* old_name;
+    const char* message;
+  };
+  static const Renamed kRenamed[] = {
+      {"--no-learn", "--freeze-permanences: it fixes existing permanences, but htm_flow still "
+                     "grows segments, so it is not inference-only"},
+      {"--checkpoint-every", "--progress-every: htm_flow cannot export region state, so the "
+                             "files record progress but cannot resume a run"},
+      {"--checkpoint", "--progress-file"},
+  };
+  for (const auto& r : kRenamed) {
+    if (arg != r.old_name) continue;
+    std::cerr << "Error: " << r.old_name << " is now " << r.message << ".\n";
+    return true;
+  }
+  return false;
+}
 
 void usage(const char* prog) {
   std::cerr
       << "Usage:\n"
-      << "  " << prog << " --input FILE --config FILE [options]\n\n"
+      << "  " << prog << " --input FILE --config FILE [options]\n"
+      << "  " << prog << " --cache FILE --config FILE [options]\n"
+      << "  " << prog << " --shards DIR|MANIFEST --config FILE [options]\n"
+      << "  " << prog << " --input FILE --config FILE --precompile OUT\n"
+      << "  " << prog << " sweep --input FILE --config FILE --grid FILE [sweep options]\n\n"
       << "Required:\n"
       << "  --input  FILE   Path to a text file to feed to the HTM network\n"
       << "  --config FILE   Path to a YAML config file (see configs/)\n\n"
@@ -38,89 +70,347 @@ void usage(const char* prog) {
       << "  --epochs N      Number of passes through the text file (default: 1)\n"
       << "  --gui           Launch the htm_gui debugger for visualization\n"
       << "  --theme MODE    GUI theme: light|dark (CLI overrides YAML gui.theme)\n"
+      << "  --mmap          Memory-map the input file instead of loading it (character mode)\n"
+      << "  --precompile OUT  Write a pre-encoded corpus cache to OUT and exit\n"
+      << "  --cache FILE    Read a corpus cache written by --precompile instead of --input\n"
+      << "  --shards PATH   Stream a corpus of many files instead of --input: a directory\n"
+      << "                  (files in name order) or a manifest listing one path per line\n"
+      << "                  (character mode; the next shard loads in the background)\n"
+      << "  --shuffle-seed S  Visit shards in a seeded per-epoch shuffled order\n"
+      << "  --no-shard-reset  Let sequence context carry across shard boundaries\n"
+      << "  --classifier-replicas N  Experiment: run N replicas in parallel on disjoint\n"
+      << "                  shard subsets (needs --shards) and merge only their\n"
+      << "                  next-symbol classifiers; regions are not merged.  Writes the\n"
+      << "                  merged classifier to --progress-file.  Honors --no-shard-reset\n"
+      << "                  --prefetch and --freeze-permanences; rejects --log and the\n"
+      << "                  other single-run flags\n"
+      << "  --merge-every M Steps per replica between classifier merges (default: 1000)\n"
+      << "  --load-classifier FILE  Start from the classifier saved in a progress file\n"
+      << "                  (e.g. from --classifier-replicas; implies --top-k 1)\n"
       << "  --log           Print per-step logging (character, epoch, accuracy)\n"
+      << "  --log-every N   Log only every Nth step (default: 1)\n"
+      << "  --log-file FILE Write the per-step log to FILE instead of stdout\n"
+      << "  --log-format F  Per-step log format: text|csv|binary (binary needs --log-file)\n"
+      << "  --freeze-permanences  Zero every plasticity rate (spatial, sequence and\n"
+      << "                  temporal pooling), so existing permanences never adapt.  Not\n"
+      << "                  inference-only: htm_flow still grows new segments and synapses\n"
+      << "                  and steps no faster.  The classifier still learns the corpus\n"
+      << "                  unless it was loaded with --load-classifier\n"
+      << "  --prefetch N    Read and encode up to N inputs ahead on a producer thread\n"
+      << "  --top-k K       Decode the K most likely next symbols every step and report\n"
+      << "                  top-1 next-symbol accuracy (shown with --log)\n"
+      << "  --generate N    After the run, feed --prompt and generate N symbols from the\n"
+      << "                  top prediction, reporting per-token latency (implies --top-k 1).\n"
+      << "                  The classifier trains during the run (or comes from\n"
+      << "                  --load-classifier); htm_flow cannot pause learning, so the\n"
+      << "                  region also learns from the prompt and its own output\n"
+      << "  --prompt TEXT   Text to prime generation with (default: continue the corpus)\n"
+      << "  --latency-budget-us US  Count generated tokens slower than US microseconds\n"
+      << "  --pipeline-layers  Step layers as a wavefront, one thread per layer\n"
+      << "                  (layer k lags layer 0 by k steps; needs enable_feedback: false)\n"
+      << "  --progress-every N  Write a progress record every N headless steps (0 = off):\n"
+      << "                  corpus position, accuracy counters and classifier.  Not crash\n"
+      << "                  recovery: htm_flow cannot export region state, so a run cannot\n"
+      << "                  resume from it\n"
+      << "  --progress-file FILE  Progress record path (default: <config name>.progress)\n"
+      << "  --timings-json FILE  Record per-stage step latency (p50/p99) and write it as JSON\n"
+      << "  --timings-every N    Also rewrite the timings file every N headless steps\n"
+      << "  --metrics-port P  Serve Prometheus metrics on 127.0.0.1:P/metrics during\n"
+      << "                  headless runs (steps/sec, accuracy, epoch, RSS, per-layer columns)\n"
+      << "  --metrics-every N Update the served metrics every N steps (default: 100)\n"
+      << "  --accuracy-window N  Samples in the sliding accuracy window (default: 1000)\n"
+      << "  --stop-when-accuracy X  Stop once windowed accuracy is at least X (0-1) and has\n"
+      << "                  changed by under one point across the last two windows\n"
+      << "  --accuracy-every N  Sample prediction accuracy every N steps; 0 disables\n"
+      << "                  (default: 1, i.e. every step).  Raise it to skip the layer 0\n"
+      << "                  snapshot on most steps; accuracy is then a stride-N subsample\n"
+      << "  --footprint     Print a heuristic estimate of the config's region memory per\n"
+      << "                  layer, with every segment full, and exit (needs only --config).\n"
+      << "                  htm_flow's real allocation is not measured and may exceed it\n"
       << "  --list-configs  List available YAML configs in configs/\n"
       << "  -h, --help      Show this help message\n\n"
+      << "Sweep options (chat_htm sweep):\n"
+      << "  --grid FILE     YAML map of parameter: [values] (e.g. cells_per_column: [4, 8])\n"
+      << "  --out FILE      Results CSV (default: sweep_results.csv)\n"
+      << "  --threads N     Concurrent runs (default: the config's worker_threads, else\n"
+      << "                  all cores)\n"
+      << "  --steps, --epochs, --accuracy-every, --freeze-permanences  As for a single run\n\n"
       << "Examples:\n"
       << "  " << prog << " --input data/hello.txt --config configs/small_text.yaml\n"
       << "  " << prog << " --input data/hello.txt --config configs/default_text.yaml --gui\n"
       << "  " << prog << " --input data/hello.txt --config configs/small_text.yaml --epochs 10 --log\n";
 }
 
-/// Parse the text/encoder sections from the YAML config.
-/// These are chat_htm-specific keys that htm_flow's loader silently ignores.
-TextMode parse_text_mode(const std::string& config_path) {
-  try {
-    YAML::Node root = YAML::LoadFile(config_path);
-    if (root["text"] && root["text"]["mode"]) {
-      const std::string mode = root["text"]["mode"].as<std::string>();
-      if (mode == "word_rows") return TextMode::WordRows;
-    }
-  } catch (const YAML::Exception& e) {
-    std::cerr << "Warning: could not parse text mode: " << e.what() << "\n";
+/// Write the runtime's stage timings as JSON, replacing `path`.
+void write_timings(const std::string& path, const chat_htm::TextRuntime& runtime) {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    std::cerr << "Warning: cannot write timings to " << path << "\n";
+    return;
   }
-  return TextMode::Character;
+  out << "{\"timestep\": " << runtime.timestep()
+      << ", \"stages\": " << runtime.timers().to_json() << "}\n";
 }
 
-std::string parse_gui_theme(const std::string& config_path) {
-  try {
-    YAML::Node root = YAML::LoadFile(config_path);
-    if (root["gui"] && root["gui"]["theme"]) {
-      return root["gui"]["theme"].as<std::string>();
+/// `chat_htm sweep`: run every combination of a parameter grid over one
+/// shared corpus and write per-run accuracy and throughput to a CSV.
+int sweep_main(int argc, char* argv[], const char* prog) {
+  std::string input_file;
+  std::string config_file;
+  std::string grid_file;
+  std::string out_file = "sweep_results.csv";
+  int threads = 0;
+  int steps = -1;
+  int epochs = 1;
+  int accuracy_every = 1;
+  bool freeze = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value = [&](const char* what) -> const char* {
+      if (i + 1 >= argc) {
+        std::cerr << arg << " requires " << what << "\n";
+        return nullptr;
+      }
+      return argv[++i];
+    };
+    const char* v = nullptr;
+    if (arg == "-h" || arg == "--help") { usage(prog); return 0; }
+    if (renamed_flag(arg)) return 2;
+    if (arg == "--freeze-permanences") { freeze = true; continue; }
+    if (arg == "--input") { if (!(v = value("a file path"))) return 2; input_file = v; continue; }
+    if (arg == "--config") { if (!(v = value("a file path"))) return 2; config_file = v; continue; }
+    if (arg == "--grid") { if (!(v = value("a file path"))) return 2; grid_file = v; continue; }
+    if (arg == "--out") { if (!(v = value("a file path"))) return 2; out_file = v; continue; }
+    if (arg == "--threads") { if (!(v = value("a number"))) return 2; threads = std::atoi(v); continue; }
+    if (arg == "--steps") { if (!(v = value("a number"))) return 2; steps = std::atoi(v); continue; }
+    if (arg == "--epochs") { if (!(v = value("a number"))) return 2; epochs = std::atoi(v); continue; }
+    if (arg == "--accuracy-every") {
+      if (!(v = value("a number"))) return 2;
+      accuracy_every = std::atoi(v);
+      continue;
     }
-  } catch (const YAML::Exception& e) {
-    std::cerr << "Warning: could not parse gui theme: " << e.what() << "\n";
+    std::cerr << "Unknown sweep argument: " << arg << "\n";
+    usage(prog);
+    return 2;
+  }
+  if (input_file.empty() || config_file.empty() || grid_file.empty()) {
+    std::cerr << "Error: sweep requires --input, --config and --grid.\n\n";
+    usage(prog);
+    return 2;
   }
-  return {};
-}
 
-chat_htm::ScalarEncoder::Params parse_scalar_encoder_params(const std::string& config_path,
-                                                            int layer0_input_bits) {
-  chat_htm::ScalarEncoder::Params p;
-  p.n = layer0_input_bits;  // must match Layer 0 input size
+  chat_htm::ChatHtmConfig base;
+  chat_htm::SweepGrid grid;
+  try {
+    base = chat_htm::ChatHtmConfig::load(config_file);
+    grid = chat_htm::SweepGrid::from_yaml(grid_file);
+    grid.check_text_mode(base.text_mode);
+  } catch (const std::exception& e) {
+    std::cerr << "Error loading sweep: " << e.what() << "\n";
+    return 1;
+  }
+  for (auto& layer_cfg : base.region.layers) layer_cfg.log_timings = false;
+  if (freeze) chat_htm::freeze_permanences(base.region);
+
+  const std::string name = std::filesystem::path(config_file).stem().string();
 
+  // Load the corpus once; every run iterates a copy that shares its buffer.
+  std::unique_ptr<chat_htm::TextChunker> text;
+  std::unique_ptr<chat_htm::WordChunker> words;
   try {
-    YAML::Node root = YAML::LoadFile(config_path);
-    if (root["encoder"]) {
-      const auto& enc = root["encoder"];
-      if (enc["active_bits"]) p.w = enc["active_bits"].as<int>();
-      if (enc["min_value"]) p.min_val = enc["min_value"].as<int>();
-      if (enc["max_value"]) p.max_val = enc["max_value"].as<int>();
+    if (base.text_mode != chat_htm::TextMode::Character) {
+      words = std::make_unique<chat_htm::WordChunker>(input_file, base.worker_threads);
+    } else {
+      text = std::make_unique<chat_htm::TextChunker>(input_file, base.normalization,
+                                                     base.worker_threads);
     }
-  } catch (const YAML::Exception& e) {
-    std::cerr << "Warning: could not parse encoder section: " << e.what() << "\n";
+  } catch (const std::exception& e) {
+    std::cerr << "Error loading input: " << e.what() << "\n";
+    return 1;
   }
+  const std::size_t corpus_size = words ? words->size() : text->size();
+  const std::int64_t total_steps =
+      steps >= 0 ? steps : static_cast<std::int64_t>(corpus_size) * epochs;
+
+  std::cout << "Sweep:   " << grid.size() << " runs of " << total_steps << " steps over "
+            << input_file << " (" << corpus_size << (words ? " words" : " characters") << ")\n";
 
-  return p;
+  auto run_one = [&](const std::vector<double>& values, chat_htm::SweepResult& r) {
+    auto cfg = base;
+    grid.apply(values, cfg);
+    std::unique_ptr<chat_htm::TextRuntime> runtime;
+    if (cfg.text_mode == chat_htm::TextMode::WordHash) {
+      runtime = std::make_unique<chat_htm::TextRuntime>(
+          cfg.region, std::make_unique<chat_htm::WordChunker>(*words),
+          chat_htm::WordHashEncoder(cfg.word_hash), name);
+    } else if (words) {
+      runtime = std::make_unique<chat_htm::TextRuntime>(
+          cfg.region, std::make_unique<chat_htm::WordChunker>(*words),
+          chat_htm::WordRowEncoder(cfg.word_rows), name);
+    } else {
+      runtime = std::make_unique<chat_htm::TextRuntime>(
+          cfg.region, std::make_unique<chat_htm::TextChunker>(*text),
+          chat_htm::ScalarEncoder(cfg.scalar), name);
+    }
+    runtime->set_accuracy_interval(accuracy_every);
+    // step() takes an int; a sweep over a large corpus needs several calls.
+    constexpr std::int64_t kMaxChunk = std::numeric_limits<int>::max();
+    for (std::int64_t left = total_steps; left > 0;) {
+      const auto n = static_cast<int>(std::min(left, kMaxChunk));
+      runtime->step(n);
+      left -= n;
+    }
+    r.steps = static_cast<std::size_t>(total_steps);
+    r.accuracy = runtime->prediction_accuracy();
+  };
+  auto on_done = [&](const chat_htm::SweepResult& r) {
+    std::cout << "Run " << (r.run + 1) << "/" << grid.size();
+    for (std::size_t a = 0; a < grid.axes().size(); ++a) {
+      std::cout << "  " << grid.axes()[a].key << "=" << r.values[a];
+    }
+    if (!r.error.empty()) {
+      std::cout << "  FAILED: " << r.error << "\n";
+    } else {
+      std::cout << "  accuracy=" << (r.accuracy * 100.0) << "%  steps/sec=" << r.steps_per_sec()
+                << "\n";
+    }
+  };
+
+  // --threads overrides the config's worker cap.
+  const int workers = threads > 0 ? threads : base.worker_threads;
+  const auto results = chat_htm::run_sweep(grid, workers, run_one, on_done);
+  try {
+    chat_htm::write_sweep_csv(out_file, grid, results);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  const auto failed = std::count_if(results.begin(), results.end(),
+                                    [](const chat_htm::SweepResult& r) { return !r.error.empty(); });
+  std::cout << "\nWrote " << out_file << " (" << results.size() << " runs, " << failed
+            << " failed)\n";
+  return failed == 0 ? 0 : 1;
 }
 
-chat_htm::WordRowEncoder::Params parse_word_row_encoder_params(const std::string& config_path,
-                                                               int input_rows, int input_cols) {
-  chat_htm::WordRowEncoder::Params p;
-  p.rows = input_rows;
-  p.cols = input_cols;
+/// `--classifier-replicas N`: run N replicas on disjoint shard subsets,
+/// merging only their classifiers every `merge_every` steps, and write the
+/// merged classifier as a progress file.  The regions are never merged.
+int run_classifier_replicas(const chat_htm::ChatHtmConfig& config, const std::string& shards_path,
+                            const chat_htm::ShardedCorpus::Options& shard_opts, int replicas,
+                            int merge_every, int steps, int epochs, int top_k, int accuracy_every,
+                            bool shard_reset, int prefetch, const std::string& progress_file,
+                            const std::string& name) {
+  std::unique_ptr<chat_htm::ClassifierReplicas> group;
+  std::size_t largest = 0;
   try {
-    YAML::Node root = YAML::LoadFile(config_path);
-    if (root["encoder"]) {
-      const auto& enc = root["encoder"];
-      if (enc["letter_bits"]) p.letter_bits = enc["letter_bits"].as<int>();
-      if (enc["alphabet"]) p.alphabet = enc["alphabet"].as<std::string>();
+    const auto shards = chat_htm::ShardedCorpus::list_shards(shards_path);
+    if (shards.size() < static_cast<std::size_t>(replicas)) {
+      throw std::invalid_argument("--classifier-replicas " + std::to_string(replicas)
+                                  + " needs at least as many shards, found "
+                                  + std::to_string(shards.size()));
     }
-  } catch (const YAML::Exception& e) {
-    std::cerr << "Warning: could not parse word-row encoder section: " << e.what() << "\n";
+    chat_htm::ClassifierReplicas::Options opts;
+    opts.merge_every = merge_every;
+    opts.threads = config.worker_threads;
+    group = std::make_unique<chat_htm::ClassifierReplicas>(opts);
+    chat_htm::ScalarEncoder encoder(config.scalar);
+    for (int r = 0; r < replicas; ++r) {
+      // Round-robin keeps the slices disjoint and similar in shard count.
+      std::vector<std::string> slice;
+      for (std::size_t i = static_cast<std::size_t>(r); i < shards.size();
+           i += static_cast<std::size_t>(replicas)) {
+        slice.push_back(shards[i]);
+      }
+      auto corpus = std::make_unique<chat_htm::ShardedCorpus>(std::move(slice), shard_opts);
+      largest = std::max(largest, corpus->total_size());
+      auto runtime = std::make_unique<chat_htm::TextRuntime>(
+          config.region, std::move(corpus), encoder, name + "_r" + std::to_string(r));
+      runtime->set_accuracy_interval(accuracy_every);
+      runtime->set_classifier(top_k);
+      runtime->set_shard_reset(shard_reset);
+      runtime->set_prefetch(prefetch);
+      group->add(std::move(runtime));
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error creating replicas: " << e.what() << "\n";
+    return 1;
+  }
+
+  const std::int64_t total_steps =
+      steps >= 0 ? steps : static_cast<std::int64_t>(largest) * epochs;
+  std::cout << "Classifier replicas: " << replicas << " over " << shards_path << ", "
+            << total_steps << " steps each, classifiers merged every " << merge_every
+            << " steps\n(experimental: regions are not merged; each learns its own slice)\n\n";
+  try {
+    group->run(total_steps);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+
+  for (std::size_t r = 0; r < group->size(); ++r) {
+    const auto& rt = group->replica(r);
+    std::cout << "Replica " << r << ": accuracy=" << (rt.prediction_accuracy() * 100.0)
+              << "%  next-symbol top-1=" << (rt.classifier_accuracy() * 100.0) << "%  epoch="
+              << rt.input_epoch() << "\n";
   }
-  return p;
+  std::cout << "Mean prediction accuracy: " << (group->mean_accuracy() * 100.0) << "%\n"
+            << "Merged classifier: " << group->merges() << " merges, "
+            << group->merged().observations() << " observations\n";
+  try {
+    group->replica(0).save_progress(progress_file);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+  std::cout << "Progress file: " << progress_file
+            << " (merged classifier only, no region state; load with --load-classifier)\n";
+  return 0;
 }
 
 }  // namespace
 
 int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "sweep") {
+    return sweep_main(argc - 1, argv + 1, argv[0]);
+  }
+
   std::string input_file;
   std::string config_file;
+  std::string precompile_file;
+  std::string cache_file;
+  std::string shards_path;
+  std::string shuffle_seed;
+  bool shard_reset = true;
+  int replicas = 1;
+  int merge_every = 1000;
+  std::string classifier_file;
   int steps = -1;    // -1 means "whole file"
   int epochs = 1;
   bool use_gui = false;
   bool log = false;
+  bool use_mmap = false;
+  bool freeze = false;
+  int accuracy_every = 1;
+  int progress_every = 0;
+  int prefetch = 0;
+  int top_k = 0;
+  int generate_tokens = 0;
+  int metrics_port = -1;
+  bool footprint = false;
+  int accuracy_window = 1000;
+  double stop_accuracy = -1.0;
+  int metrics_every = 100;
+  std::string prompt;
+  double latency_budget_us = 0.0;
+  bool pipeline_layers = false;
+  std::string progress_file;
+  std::string timings_file;
+  int timings_every = 0;
+  int log_every = 1;
+  std::string log_file;
+  std::string log_format = "text";
   std::string cli_theme;
 
   // --- Parse arguments ---
@@ -152,6 +442,41 @@ int main(int argc, char* argv[]) {
       config_file = argv[++i];
       continue;
     }
+    if (arg == "--precompile") {
+      if (i + 1 >= argc) { std::cerr << "--precompile requires an output path\n"; return 2; }
+      precompile_file = argv[++i];
+      continue;
+    }
+    if (arg == "--cache") {
+      if (i + 1 >= argc) { std::cerr << "--cache requires a file path\n"; return 2; }
+      cache_file = argv[++i];
+      continue;
+    }
+    if (arg == "--shards") {
+      if (i + 1 >= argc) { std::cerr << "--shards requires a directory or manifest path\n"; return 2; }
+      shards_path = argv[++i];
+      continue;
+    }
+    if (arg == "--classifier-replicas") {
+      if (i + 1 >= argc) { std::cerr << "--classifier-replicas requires a number\n"; return 2; }
+      replicas = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--merge-every") {
+      if (i + 1 >= argc) { std::cerr << "--merge-every requires a number\n"; return 2; }
+      merge_every = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--load-classifier") {
+      if (i + 1 >= argc) { std::cerr << "--load-classifier requires a file path\n"; return 2; }
+      classifier_file = argv[++i];
+      continue;
+    }
+    if (arg == "--shuffle-seed") {
+      if (i + 1 >= argc) { std::cerr << "--shuffle-seed requires a number\n"; return 2; }
+      shuffle_seed = argv[++i];
+      continue;
+    }
     if (arg == "--steps") {
       if (i + 1 >= argc) { std::cerr << "--steps requires a number\n"; return 2; }
       steps = std::atoi(argv[++i]);
@@ -162,6 +487,91 @@ int main(int argc, char* argv[]) {
       epochs = std::atoi(argv[++i]);
       continue;
     }
+    if (arg == "--accuracy-every") {
+      if (i + 1 >= argc) { std::cerr << "--accuracy-every requires a number\n"; return 2; }
+      accuracy_every = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--prefetch") {
+      if (i + 1 >= argc) { std::cerr << "--prefetch requires a number\n"; return 2; }
+      prefetch = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--top-k") {
+      if (i + 1 >= argc) { std::cerr << "--top-k requires a number\n"; return 2; }
+      top_k = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--accuracy-window") {
+      if (i + 1 >= argc) { std::cerr << "--accuracy-window requires a number\n"; return 2; }
+      accuracy_window = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--stop-when-accuracy") {
+      if (i + 1 >= argc) { std::cerr << "--stop-when-accuracy requires a number\n"; return 2; }
+      stop_accuracy = std::atof(argv[++i]);
+      continue;
+    }
+    if (arg == "--metrics-port") {
+      if (i + 1 >= argc) { std::cerr << "--metrics-port requires a number\n"; return 2; }
+      metrics_port = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--metrics-every") {
+      if (i + 1 >= argc) { std::cerr << "--metrics-every requires a number\n"; return 2; }
+      metrics_every = std::max(1, std::atoi(argv[++i]));
+      continue;
+    }
+    if (arg == "--generate") {
+      if (i + 1 >= argc) { std::cerr << "--generate requires a number\n"; return 2; }
+      generate_tokens = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--prompt") {
+      if (i + 1 >= argc) { std::cerr << "--prompt requires text\n"; return 2; }
+      prompt = argv[++i];
+      continue;
+    }
+    if (arg == "--latency-budget-us") {
+      if (i + 1 >= argc) { std::cerr << "--latency-budget-us requires a number\n"; return 2; }
+      latency_budget_us = std::atof(argv[++i]);
+      continue;
+    }
+    if (arg == "--progress-every") {
+      if (i + 1 >= argc) { std::cerr << "--progress-every requires a number\n"; return 2; }
+      progress_every = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--progress-file") {
+      if (i + 1 >= argc) { std::cerr << "--progress-file requires a file path\n"; return 2; }
+      progress_file = argv[++i];
+      continue;
+    }
+    if (arg == "--log-every") {
+      if (i + 1 >= argc) { std::cerr << "--log-every requires a number\n"; return 2; }
+      log_every = std::atoi(argv[++i]);
+      continue;
+    }
+    if (arg == "--log-file") {
+      if (i + 1 >= argc) { std::cerr << "--log-file requires a file path\n"; return 2; }
+      log_file = argv[++i];
+      continue;
+    }
+    if (arg == "--log-format") {
+      if (i + 1 >= argc) { std::cerr << "--log-format requires a value: text|csv|binary\n"; return 2; }
+      log_format = argv[++i];
+      continue;
+    }
+    if (arg == "--timings-json") {
+      if (i + 1 >= argc) { std::cerr << "--timings-json requires a file path\n"; return 2; }
+      timings_file = argv[++i];
+      continue;
+    }
+    if (arg == "--timings-every") {
+      if (i + 1 >= argc) { std::cerr << "--timings-every requires a number\n"; return 2; }
+      timings_every = std::atoi(argv[++i]);
+      continue;
+    }
     if (arg == "--theme") {
       if (i + 1 >= argc) { std::cerr << "--theme requires a value: light|dark\n"; return 2; }
       cli_theme = argv[++i];
@@ -169,68 +579,247 @@ int main(int argc, char* argv[]) {
     }
     if (arg == "--gui") { use_gui = true; continue; }
     if (arg == "--log") { log = true; continue; }
+    if (arg == "--mmap") { use_mmap = true; continue; }
+    if (renamed_flag(arg)) return 2;
+    if (arg == "--freeze-permanences") { freeze = true; continue; }
+    if (arg == "--no-shard-reset") { shard_reset = false; continue; }
+    if (arg == "--footprint") { footprint = true; continue; }
+    if (arg == "--pipeline-layers") { pipeline_layers = true; continue; }
 
     std::cerr << "Unknown argument: " << arg << "\n";
     usage(argv[0]);
     return 2;
   }
 
-  if (input_file.empty() || config_file.empty()) {
-    std::cerr << "Error: --input and --config are required.\n\n";
+  const int sources = !input_file.empty() + !cache_file.empty() + !shards_path.empty();
+  if (config_file.empty() || (!footprint && sources != 1)) {
+    std::cerr << "Error: --config and exactly one of --input / --cache / --shards are required.\n\n";
+    usage(argv[0]);
+    return 2;
+  }
+  if (!shards_path.empty() && use_mmap) {
+    std::cerr << "Error: --shards cannot be combined with --mmap.\n\n";
+    usage(argv[0]);
+    return 2;
+  }
+  if (replicas != 1 && (replicas < 1 || shards_path.empty() || use_gui || merge_every <= 0)) {
+    std::cerr << "Error: --classifier-replicas needs N >= 1, --shards, a positive --merge-every "
+                 "and no --gui.\n\n";
+    usage(argv[0]);
+    return 2;
+  }
+  if (!shuffle_seed.empty() && shards_path.empty()) {
+    std::cerr << "Error: --shuffle-seed requires --shards.\n\n";
+    usage(argv[0]);
+    return 2;
+  }
+  if (!precompile_file.empty() && input_file.empty()) {
+    std::cerr << "Error: --precompile requires --input.\n\n";
     usage(argv[0]);
     return 2;
   }
 
   // --- Load configuration ---
-  htm_flow::HTMRegionConfig region_cfg;
+  chat_htm::ChatHtmConfig config;
   try {
-    region_cfg = htm_flow::load_region_config(config_file);
+    config = chat_htm::ChatHtmConfig::load(config_file);
   } catch (const std::exception& e) {
     std::cerr << "Error loading config: " << e.what() << "\n";
     return 1;
   }
+  htm_flow::HTMRegionConfig& region_cfg = config.region;
+  if (footprint) {
+    const auto region_footprint = chat_htm::estimate_footprint(region_cfg);
+    std::cout << "Heuristic region memory estimate for " << config_file
+              << " (from the config at assumed per-synapse sizes; not a bound):\n";
+    for (std::size_t k = 0; k < region_footprint.layers.size(); ++k) {
+      const auto& l = region_footprint.layers[k];
+      std::cout << "  layer " << k << ": " << l.columns << " columns, " << l.cells << " cells, "
+                << l.proximal_synapses << " proximal + " << l.distal_synapses
+                << " distal synapses = " << chat_htm::format_bytes(l.bytes()) << "\n";
+    }
+    std::cout << "  total:   " << chat_htm::format_bytes(region_footprint.bytes()) << "\n";
+    return 0;
+  }
 
   // Apply logging setting
   for (auto& layer_cfg : region_cfg.layers) {
     layer_cfg.log_timings = (!use_gui) || log;
   }
+  if (freeze) {
+    chat_htm::freeze_permanences(region_cfg);
+  }
 
-  // Compute Layer 0 input size
-  const int input_rows = region_cfg.layers[0].num_input_rows;
-  const int input_cols = region_cfg.layers[0].num_input_cols;
-  const int input_bits = input_rows * input_cols;
-  const TextMode text_mode = parse_text_mode(config_file);
-  const std::string yaml_theme = parse_gui_theme(config_file);
-  const std::string effective_theme = cli_theme.empty() ? yaml_theme : cli_theme;
+  const std::string effective_theme = cli_theme.empty() ? config.gui_theme : cli_theme;
 
   std::cout << "Config:  " << config_file << " (" << region_cfg.layers.size() << " layer"
             << (region_cfg.layers.size() > 1 ? "s" : "") << ")\n";
-  std::cout << "Input:   " << input_file << "\n";
-  std::unique_ptr<chat_htm::TextRuntime> runtime;
+  if (config.worker_threads > 0) {
+    std::cout << "Threads: up to " << config.worker_threads << " (worker_threads)\n";
+  }
+  if (freeze) std::cout << "Learning: permanences frozen (segments still grow)\n";
+  if (shards_path.empty()) {
+    std::cout << "Input:   " << (cache_file.empty() ? input_file : cache_file + " (cache)") << "\n";
+  }
   std::string name = std::filesystem::path(config_file).stem().string();
+  if (progress_file.empty()) progress_file = name + ".progress";
+  chat_htm::ShardedCorpus::Options shard_opts;
+  shard_opts.shuffle = !shuffle_seed.empty();
+  shard_opts.norm = config.normalization;
+  shard_opts.threads = config.worker_threads;
+  if (shard_opts.shuffle) {
+    try {
+      shard_opts.seed = std::stoull(shuffle_seed);
+    } catch (const std::exception&) {
+      std::cerr << "Error: --shuffle-seed must be a non-negative integer\n";
+      return 2;
+    }
+  }
+  if (replicas > 1) {
+    if (config.text_mode != chat_htm::TextMode::Character) {
+      std::cerr << "Error: --classifier-replicas supports character mode only\n";
+      return 2;
+    }
+    // Flags of a single headless run that have no per-replica meaning here.
+    const std::vector<std::pair<bool, const char*>> single_run_only = {
+        {log || !log_file.empty(), "--log / --log-file"},
+        {generate_tokens > 0, "--generate"},
+        {!classifier_file.empty(), "--load-classifier"},
+        {pipeline_layers, "--pipeline-layers"},
+        {progress_every > 0, "--progress-every"},
+        {!timings_file.empty(), "--timings-json"},
+        {metrics_port >= 0, "--metrics-port"},
+        {stop_accuracy >= 0.0, "--stop-when-accuracy"},
+    };
+    for (const auto& [set, flag] : single_run_only) {
+      if (set) {
+        std::cerr << "Error: " << flag << " is not supported with --classifier-replicas\n";
+        return 2;
+      }
+    }
+    // Replicas always learn the classifier: it is what gets merged.
+    return run_classifier_replicas(config, shards_path, shard_opts, replicas, merge_every, steps,
+                                   epochs, std::max(1, top_k), accuracy_every, shard_reset,
+                                   prefetch, progress_file, name);
+  }
+  std::unique_ptr<chat_htm::TextRuntime> runtime;
   try {
-    if (text_mode == TextMode::WordRows) {
-      auto enc_params = parse_word_row_encoder_params(config_file, input_rows, input_cols);
+    if (!shards_path.empty() && config.text_mode != chat_htm::TextMode::Character) {
+      throw std::invalid_argument("--shards supports character mode only; text.mode is "
+                                  + std::string(chat_htm::text_mode_name(config.text_mode)));
+    }
+    if (config.text_mode == chat_htm::TextMode::WordRows) {
+      const auto& enc_params = config.word_rows;
       chat_htm::WordRowEncoder encoder(enc_params);
-      auto chunker = std::make_unique<chat_htm::WordChunker>(input_file);
+      std::unique_ptr<chat_htm::CorpusCache> cache;
+      std::unique_ptr<chat_htm::WordChunker> chunker;
+      if (!cache_file.empty()) {
+        cache = std::make_unique<chat_htm::CorpusCache>(cache_file);
+        cache->require_params(chat_htm::corpus_cache_hash(enc_params));
+        chunker = cache->word_chunker();
+      } else {
+        chunker = std::make_unique<chat_htm::WordChunker>(input_file, config.worker_threads);
+      }
+      if (!precompile_file.empty()) {
+        chat_htm::write_corpus_cache(precompile_file, *chunker, encoder);
+        std::cout << "Wrote corpus cache " << precompile_file << ": " << chunker->size()
+                  << " words, " << chunker->vocabulary_size() << " distinct\n";
+        return 0;
+      }
+      const std::size_t max_word_len = chunker->max_word_length();
+      const std::size_t vocab_size = chunker->vocabulary_size();
       runtime = std::make_unique<chat_htm::TextRuntime>(
           region_cfg, std::move(chunker), encoder, name);
+      if (cache) runtime->set_symbol_table(cache->sdr_table());
       std::cout << "Mode:    word_rows\n";
       std::cout << "Encoder: rows=" << enc_params.rows
                 << " cols=" << enc_params.cols
                 << " letter_bits=" << enc_params.letter_bits
-                << " alphabet_size=" << enc_params.alphabet.size() << "\n";
-      std::cout << "Text:    " << runtime->input_size() << " words\n\n";
-    } else {
-      auto enc_params = parse_scalar_encoder_params(config_file, input_bits);
-      chat_htm::ScalarEncoder encoder(enc_params);
-      auto chunker = std::make_unique<chat_htm::TextChunker>(input_file);
+                << " alphabet_size=" << enc_params.alphabet.size()
+                << (enc_params.cache ? " cached" : "") << "\n";
+      std::cout << "Text:    " << runtime->input_size() << " words, " << vocab_size
+                << " distinct, max length " << max_word_len << "\n\n";
+      if (static_cast<int>(max_word_len) > enc_params.rows) {
+        std::cerr << "Warning: longest word has " << max_word_len << " letters but input.rows is "
+                  << enc_params.rows << "; letters past row " << enc_params.rows
+                  << " are dropped.\n\n";
+      }
+    } else if (config.text_mode == chat_htm::TextMode::WordHash) {
+      const auto& enc_params = config.word_hash;
+      chat_htm::WordHashEncoder encoder(enc_params);
+      std::unique_ptr<chat_htm::CorpusCache> cache;
+      std::unique_ptr<chat_htm::WordChunker> chunker;
+      if (!cache_file.empty()) {
+        cache = std::make_unique<chat_htm::CorpusCache>(cache_file);
+        cache->require_params(chat_htm::corpus_cache_hash(enc_params));
+        chunker = cache->word_chunker();
+      } else {
+        chunker = std::make_unique<chat_htm::WordChunker>(input_file, config.worker_threads);
+      }
+      if (!precompile_file.empty()) {
+        chat_htm::write_corpus_cache(precompile_file, *chunker, encoder);
+        std::cout << "Wrote corpus cache " << precompile_file << ": " << chunker->size()
+                  << " words, " << chunker->vocabulary_size() << " distinct\n";
+        return 0;
+      }
+      const std::size_t vocab_size = chunker->vocabulary_size();
       runtime = std::make_unique<chat_htm::TextRuntime>(
           region_cfg, std::move(chunker), encoder, name);
-      std::cout << "Mode:    character\n";
+      if (cache) runtime->set_symbol_table(cache->sdr_table());
+      std::cout << "Mode:    word_hash\n";
+      std::cout << "Encoder: n=" << enc_params.n << " w=" << enc_params.w
+                << " trigram_bits=" << enc_params.trigram_bits << " seed=" << enc_params.seed
+                << (enc_params.cache ? " cached" : "") << "\n";
+      std::cout << "Text:    " << runtime->input_size() << " words, " << vocab_size
+                << " distinct\n\n";
+    } else {
+      const auto& enc_params = config.scalar;
+      chat_htm::ScalarEncoder encoder(enc_params);
+      const auto& norm = config.normalization;
+      if (!cache_file.empty()) {
+        chat_htm::CorpusCache cache(cache_file);
+        cache.require_params(chat_htm::corpus_cache_hash(enc_params, norm));
+        runtime = std::make_unique<chat_htm::TextRuntime>(
+            region_cfg, cache.character_chunker(), encoder, name);
+        runtime->set_symbol_table(cache.sdr_table());
+      } else if (!precompile_file.empty()) {
+        chat_htm::TextChunker chunker(input_file, norm, config.worker_threads);
+        chat_htm::write_corpus_cache(precompile_file, chunker, encoder, norm);
+        std::cout << "Wrote corpus cache " << precompile_file << ": " << chunker.size()
+                  << " characters\n";
+        return 0;
+      } else if (!shards_path.empty()) {
+        auto corpus = std::make_unique<chat_htm::ShardedCorpus>(
+            chat_htm::ShardedCorpus::list_shards(shards_path), shard_opts);
+        std::cout << "Input:   " << shards_path << " (" << corpus->num_shards() << " shards, "
+                  << corpus->total_size() << " characters"
+                  << (shard_opts.shuffle ? ", shuffled with seed " + shuffle_seed : "") << ")\n";
+        runtime = std::make_unique<chat_htm::TextRuntime>(
+            region_cfg, std::move(corpus), encoder, name);
+        runtime->set_shard_reset(shard_reset);
+      } else if (use_mmap) {
+        auto chunker = std::make_unique<chat_htm::MappedTextChunker>(input_file, norm);
+        runtime = std::make_unique<chat_htm::TextRuntime>(
+            region_cfg, std::move(chunker), encoder, name);
+      } else {
+        auto chunker =
+            std::make_unique<chat_htm::TextChunker>(input_file, norm, config.worker_threads);
+        runtime = std::make_unique<chat_htm::TextRuntime>(
+            region_cfg, std::move(chunker), encoder, name);
+      }
+      std::cout << "Mode:    character"
+                << (!cache_file.empty() ? " (cache)" : use_mmap ? " (mmap)"
+                    : runtime->is_sharded() ? " (sharded)" : "") << "\n";
       std::cout << "Encoder: n=" << enc_params.n << " w=" << enc_params.w
-                << " range=[" << enc_params.min_val << "," << enc_params.max_val << "]\n";
-      std::cout << "Text:    " << runtime->input_size() << " characters\n\n";
+                << " range=[" << enc_params.min_val << "," << enc_params.max_val << "]"
+                << (enc_params.cache ? " cached" : "") << "\n";
+      if (runtime->is_sharded()) {
+        std::cout << "Text:    " << runtime->input_size() << " characters in the first shard, "
+                  << (shard_reset ? "sequence reset at each shard\n\n"
+                                  : "no reset between shards\n\n");
+      } else {
+        std::cout << "Text:    " << runtime->input_size() << " characters\n\n";
+      }
     }
   } catch (const std::exception& e) {
     std::cerr << "Error creating runtime: " << e.what() << "\n";
@@ -238,14 +827,67 @@ int main(int argc, char* argv[]) {
   }
 
   // Compute total steps
-  int total_steps = steps;
+  // Sharded corpora can exceed INT_MAX characters per epoch.
+  std::int64_t total_steps = steps;
   if (total_steps < 0) {
-    total_steps = static_cast<int>(runtime->input_size()) * epochs;
+    const std::size_t epoch_size =
+        runtime->is_sharded() ? runtime->shards().total_size() : runtime->input_size();
+    total_steps = static_cast<std::int64_t>(epoch_size) * epochs;
+  }
+
+  runtime->set_accuracy_interval(accuracy_every);
+  if (accuracy_window <= 0) {
+    std::cerr << "Error: --accuracy-window must be positive\n";
+    return 2;
   }
+  runtime->set_accuracy_window(static_cast<std::size_t>(accuracy_window));
+
+  // Generation decodes with the classifier, so it must learn during the run,
+  // region learning or not.  Only a loaded classifier is frozen by
+  // --freeze-permanences.
+  if ((generate_tokens > 0 || !classifier_file.empty()) && top_k <= 0) top_k = 1;
+  runtime->set_classifier(top_k);
+  runtime->set_classifier_learning(!freeze || classifier_file.empty());
+  if (!classifier_file.empty()) {
+    try {
+      if (!runtime->load_classifier(classifier_file)) {
+        std::cerr << "Warning: " << classifier_file << " has no classifier; starting empty.\n";
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "Error loading classifier: " << e.what() << "\n";
+      return 1;
+    }
+  }
+  runtime->set_prefetch(prefetch);
+  if (pipeline_layers) {
+    if (config.enable_feedback) {
+      std::cerr << "Warning: --pipeline-layers ignored: the config enables feedback, which "
+                   "needs every layer on the same timestep.\n";
+    } else if (config.worker_threads > 0
+               && static_cast<int>(region_cfg.layers.size()) > config.worker_threads) {
+      std::cerr << "Warning: --pipeline-layers ignored: it needs one thread per layer ("
+                << region_cfg.layers.size() << ") but the config's worker_threads is "
+                << config.worker_threads << ".\n";
+    } else if (region_cfg.layers.size() > 1) {
+      runtime->set_layer_pipeline(true);
+      std::cout << "Layers:  pipelined across " << region_cfg.layers.size() << " threads\n";
+    }
+  }
+
+  if (!timings_file.empty()) runtime->timers().set_enabled(true);
 
   // Enable per-step text logging (works in both GUI and headless modes)
-  if (log) {
-    runtime->set_log_text(true);
+  if (log || !log_file.empty()) {
+    try {
+      chat_htm::StepLogger::Options log_opts;
+      log_opts.format = chat_htm::StepLogger::parse_format(log_format);
+      log_opts.path = log_file;
+      log_opts.every = log_every;
+      runtime->set_step_log(log_opts);
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << "\n";
+      return 2;
+    }
   }
 
   // --- GUI mode ---
@@ -269,22 +911,155 @@ int main(int argc, char* argv[]) {
   }
 
   // --- Headless mode ---
-  int log_interval = std::max(1, total_steps / 20);  // Log ~20 times
-  for (int i = 0; i < total_steps; ++i) {
+  std::unique_ptr<chat_htm::MetricsServer> metrics;
+  if (metrics_port >= 0) {
+    try {
+      chat_htm::MetricsServer::Options metrics_opts;
+      metrics_opts.port = metrics_port;
+      metrics = std::make_unique<chat_htm::MetricsServer>(metrics_opts, runtime->num_layers());
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << "\n";
+      return 1;
+    }
+    metrics->publish(*runtime);
+    std::cout << "Metrics: http://127.0.0.1:" << metrics->port() << "/metrics\n";
+  }
+  const std::int64_t log_interval = std::max<std::int64_t>(1, total_steps / 20);  // ~20 lines
+  std::int64_t steps_done = total_steps;
+  bool stopped_early = false;
+  for (std::int64_t i = 0; i < total_steps; ++i) {
     runtime->step(1);
+    const auto& tracker = runtime->accuracy_tracker();
+    stopped_early = stop_accuracy >= 0.0 && tracker.window_full()
+                    && tracker.window_accuracy() >= stop_accuracy && tracker.plateaued(0.01);
+    const bool last = stopped_early || i == total_steps - 1;
 
-    if (log && (i % log_interval == 0 || i == total_steps - 1)) {
+    if (progress_every > 0 && ((i + 1) % progress_every == 0 || last)) {
+      try {
+        runtime->save_progress(progress_file);
+      } catch (const std::exception& e) {
+        std::cerr << "Warning: progress record failed: " << e.what() << "\n";
+      }
+    }
+    if (metrics && ((i + 1) % metrics_every == 0 || last)) {
+      metrics->publish(*runtime);
+    }
+    if (!timings_file.empty() && timings_every > 0 && (i + 1) % timings_every == 0) {
+      write_timings(timings_file, *runtime);
+    }
+
+    if (log && (i % log_interval == 0 || last)) {
+      runtime->flush_log();  // Keep queued step lines ahead of the progress line.
       std::cout << "Step " << (i + 1) << "/" << total_steps
                 << "  epoch=" << runtime->input_epoch()
                 << "  accuracy=" << (runtime->prediction_accuracy() * 100.0) << "%"
-                << "  | " << runtime->input_context()
-                << "\n";
+                << "  window=" << (tracker.window_accuracy() * 100.0) << "%"
+                << "  ema=" << (tracker.ema() * 100.0) << "%"
+                << "  | " << runtime->input_context();
+      if (top_k > 0) {
+        std::cout << "  | next:";
+        for (const auto& p : runtime->predictions()) {
+          std::cout << " '" << runtime->symbol_text(p.symbol) << "'";
+        }
+      }
+      std::cout << "\n";
+    }
+    if (stopped_early) {
+      steps_done = i + 1;
+      break;
     }
   }
 
-  std::cout << "\nDone. " << total_steps << " steps processed.\n";
+  runtime->flush_log();
+  if (stopped_early) {
+    std::cout << "\nStopped early: windowed accuracy "
+              << (runtime->accuracy_tracker().window_accuracy() * 100.0) << "% reached "
+              << (stop_accuracy * 100.0) << "% and plateaued.\n";
+  }
+  std::cout << "\nDone. " << steps_done << " steps processed.\n";
   std::cout << "Final prediction accuracy: "
             << (runtime->prediction_accuracy() * 100.0) << "%\n";
+  {
+    const auto& tracker = runtime->accuracy_tracker();
+    std::cout << "Recent accuracy: window=" << (tracker.window_accuracy() * 100.0)
+              << "% (last " << tracker.window_size() << " samples)  ema="
+              << (tracker.ema() * 100.0) << "%\n";
+    const auto& epochs_seen = tracker.per_epoch();
+    if (epochs_seen.size() > 1) {
+      // The first epoch and the most recent ones show the trend on long runs.
+      const std::size_t tail_from = epochs_seen.size() > 10 ? epochs_seen.size() - 9 : 1;
+      std::cout << "Per-epoch accuracy:";
+      for (std::size_t e = 0; e < epochs_seen.size(); ++e) {
+        if (e > 0 && e < tail_from) {
+          if (e == 1) std::cout << "  ...";
+          continue;
+        }
+        if (epochs_seen[e].total == 0) continue;
+        std::cout << "  " << e << "=" << (epochs_seen[e].accuracy() * 100.0) << "%";
+      }
+      std::cout << "\n";
+    }
+    // The least predictable symbols, among those seen often enough to judge.
+    std::vector<std::uint32_t> hardest;
+    const auto& per_symbol = tracker.per_symbol();
+    for (std::size_t sym = 0; sym < per_symbol.size(); ++sym) {
+      if (per_symbol[sym].total >= 20) hardest.push_back(static_cast<std::uint32_t>(sym));
+    }
+    const std::size_t shown = std::min<std::size_t>(5, hardest.size());
+    std::partial_sort(hardest.begin(), hardest.begin() + static_cast<std::ptrdiff_t>(shown),
+                      hardest.end(), [&](std::uint32_t a, std::uint32_t b) {
+                        return per_symbol[a].accuracy() < per_symbol[b].accuracy();
+                      });
+    if (shown > 0) {
+      std::cout << "Hardest symbols:";
+      for (std::size_t h = 0; h < shown; ++h) {
+        std::cout << "  '" << runtime->symbol_text(hardest[h])
+                  << "'=" << (per_symbol[hardest[h]].accuracy() * 100.0) << "%";
+      }
+      std::cout << "\n";
+    }
+  }
+  if (top_k > 0) {
+    std::cout << "Next-symbol top-1 accuracy: " << (runtime->classifier_accuracy() * 100.0)
+              << "%\n";
+  }
+  if (!timings_file.empty()) {
+    write_timings(timings_file, *runtime);
+    std::cout << "Timings: " << timings_file << "\n";
+  }
+
+  if (generate_tokens > 0) {
+    chat_htm::GenerateOptions gen_opts;
+    gen_opts.tokens = generate_tokens;
+    gen_opts.budget_ns = static_cast<std::uint64_t>(std::max(0.0, latency_budget_us) * 1e3);
+    // htm_flow has no runtime learning switch, so the region trained above
+    // keeps learning from what it generates.
+    gen_opts.allow_region_learning = true;
+    if (!runtime->permanences_frozen()) {
+      std::cerr << "Warning: htm_flow cannot pause learning; the region also learns from the "
+                   "prompt and the generated text.\n";
+    }
+    // Prompts go through the same per-byte normalization as the corpus.
+    if (config.text_mode == chat_htm::TextMode::Character) config.normalization.apply(prompt);
+    const auto gen = chat_htm::generate(*runtime, prompt, gen_opts);
+    if (!prompt.empty() && gen.prompt.empty()) {
+      std::cerr << "Warning: no prompt words are in the vocabulary; continuing from the corpus.\n";
+    }
+    std::cout << "\nPrompt:    " << prompt << "\n"
+              << "Generated: " << gen.text << "\n";
+    if (gen.stalled) {
+      std::cout << "Stopped after " << gen.symbols.size() << " of " << generate_tokens
+                << " symbols: nothing was predicted.\n";
+    }
+    const auto& lat = gen.latency;
+    std::cout << "Per-token latency: " << lat.count() << " tokens  mean=" << lat.mean_ns() / 1e3
+              << "us  p50=" << lat.percentile(50) / 1e3 << "us  p99=" << lat.percentile(99) / 1e3
+              << "us  max=" << lat.max_ns() / 1e3 << "us";
+    if (gen_opts.budget_ns > 0) {
+      std::cout << "  over " << latency_budget_us << "us budget: " << gen.over_budget;
+    }
+    std::cout << "\n";
+  }
 
   return 0;
 }
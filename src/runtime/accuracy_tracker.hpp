@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace chat_htm {
+
+/// Prediction accuracy views that stay informative on long runs.
+///
+/// The cumulative rate converges after the first epoch and hides both
+/// progress and regressions, so alongside it this keeps accuracy over the
+/// last `window` samples, an exponential moving average, and counts per
+/// epoch and per symbol.  record() is O(1) (per-epoch and per-symbol
+/// tables grow on first use).  Samples are accuracy samples, so with
+/// `--accuracy-every N` a window spans N times as many steps.
+class AccuracyTracker {
+public:
+  /// Hits and samples for one bucket.
+  struct Counts {
+    std::uint64_t correct{0};
+    std::uint64_t total{0};
+    double accuracy() const {
+      return total ? static_cast<double>(correct) / static_cast<double>(total) : 0.0;
+    }
+  };
+
+  /// Throws std::invalid_argument for a zero window or an alpha outside (0, 1].
+  explicit AccuracyTracker(std::size_t window = 1000, double ema_alpha = 0.01)
+      : ring_(window), alpha_(ema_alpha) {
+    if (window == 0) throw std::invalid_argument("AccuracyTracker: window must be > 0");
+    if (!(ema_alpha > 0.0 && ema_alpha <= 1.0)) {
+      throw std::invalid_argument("AccuracyTracker: ema_alpha must be in (0, 1]");
+    }
+  }
+
+  void record(bool correct, int epoch, std::uint32_t symbol) {
+    const std::uint8_t hit = correct ? 1 : 0;
+    if (fill_ == ring_.size()) {
+      window_correct_ -= ring_[head_];
+    } else {
+      ++fill_;
+    }
+    ring_[head_] = hit;
+    window_correct_ += hit;
+    head_ = head_ + 1 == ring_.size() ? 0 : head_ + 1;
+
+    ema_ = samples_ == 0 ? hit : ema_ + alpha_ * (hit - ema_);
+    ++samples_;
+    total_.correct += hit;
+    ++total_.total;
+
+    if (epoch >= 0) bump(per_epoch_, static_cast<std::size_t>(epoch), hit);
+    bump(per_symbol_, symbol, hit);
+
+    if (++since_window_ == ring_.size()) {
+      since_window_ = 0;
+      previous_window_ = last_window_;
+      last_window_ = window_accuracy();
+      ++completed_windows_;
+    }
+  }
+
+  std::uint64_t samples() const { return samples_; }
+  /// Since the first sample (same as TextRuntime::prediction_accuracy()).
+  double accuracy() const { return total_.accuracy(); }
+
+  std::size_t window_size() const { return ring_.size(); }
+  bool window_full() const { return fill_ == ring_.size(); }
+  /// Over the last min(samples, window) samples.
+  double window_accuracy() const {
+    return fill_ ? static_cast<double>(window_correct_) / static_cast<double>(fill_) : 0.0;
+  }
+  double ema() const { return ema_; }
+
+  /// True once two back-to-back full windows differ by less than
+  /// `min_delta` (e.g. 0.01 = one percentage point).
+  bool plateaued(double min_delta) const {
+    return completed_windows_ >= 2 && std::fabs(last_window_ - previous_window_) < min_delta;
+  }
+
+  /// Indexed by epoch / by symbol; entries never seen have total == 0.
+  const std::vector<Counts>& per_epoch() const { return per_epoch_; }
+  const std::vector<Counts>& per_symbol() const { return per_symbol_; }
+
+  void reset() { *this = AccuracyTracker(ring_.size(), alpha_); }
+
+private:
+  static void bump(std::vector<Counts>& table, std::size_t idx, std::uint8_t hit) {
+    if (idx >= table.size()) table.resize(idx + 1);
+    table[idx].correct += hit;
+    ++table[idx].total;
+  }
+
+  std::vector<std::uint8_t> ring_;  ///< Last window_size() outcomes.
+  std::size_t head_{0};
+  std::size_t fill_{0};
+  std::size_t window_correct_{0};
+
+  double alpha_;
+  double ema_{0.0};
+
+  std::uint64_t samples_{0};
+  Counts total_;
+  std::vector<Counts> per_epoch_;
+  std::vector<Counts> per_symbol_;
+
+  std::size_t since_window_{0};
+  std::uint64_t completed_windows_{0};
+  double last_window_{0.0};
+  double previous_window_{0.0};
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,45 @@
+#include "runtime/classifier_replicas.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace chat_htm {
+
+ClassifierReplicas::ClassifierReplicas(const Options& opts) : opts_(opts), batch_(opts.threads) {
+  if (opts_.merge_every <= 0) {
+    throw std::invalid_argument("ClassifierReplicas: merge_every must be > 0");
+  }
+}
+
+TextRuntime& ClassifierReplicas::add(std::unique_ptr<TextRuntime> replica) {
+  if (replica && replica->classifier_top_k() <= 0) {
+    throw std::invalid_argument("ClassifierReplicas: replicas need the classifier on (set_classifier)");
+  }
+  return batch_.add(std::move(replica));
+}
+
+void ClassifierReplicas::run(std::int64_t steps) {
+  std::int64_t done = 0;
+  while (done < steps) {
+    const auto n = static_cast<int>(std::min<std::int64_t>(opts_.merge_every, steps - done));
+    batch_.step(n);
+    done += n;
+    merge();
+  }
+}
+
+void ClassifierReplicas::merge() {
+  // Each replica holds merged_ plus its own counts since the last merge.
+  SymbolClassifier next = merged_;
+  for (std::size_t i = 0; i < batch_.size(); ++i) {
+    next.merge(batch_.stream(i).classifier(), &merged_);
+  }
+  merged_ = std::move(next);
+  for (std::size_t i = 0; i < batch_.size(); ++i) {
+    batch_.stream(i).replace_classifier(merged_);
+  }
+  ++merges_;
+}
+
+}  // namespace chat_htm
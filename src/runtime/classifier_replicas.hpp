@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "runtime/runtime_batch.hpp"
+#include "runtime/symbol_classifier.hpp"
+#include "runtime/text_runtime.hpp"
+
+namespace chat_htm {
+
+/// Classifier-only merge experiment: replicas of one config, each on its
+/// own slice of the corpus, stepped in parallel, with only their
+/// next-symbol classifiers shared.
+///
+/// This is not data-parallel training of the HTM model.  htm_flow keeps
+/// permanences and segments private, so the regions are never merged:
+/// each replica's spatial and sequence memory learns from its own slice
+/// alone, and the regions drift apart as they learn.  What is merged,
+/// every `merge_every` steps, is the SymbolClassifier: each replica's
+/// counts learned since the last merge are summed into one shared
+/// classifier, which is copied back to every replica.
+///
+/// Replicas built from the same config start from the same initial
+/// connectivity (htm_flow builds a layer deterministically from its
+/// config; the integration tests check that two fresh replicas activate
+/// the same layer 0 columns on the same input), so early on their column codes are similar enough for a
+/// shared decoder to help; whether it still helps later is what the
+/// experiment measures.  save_progress() on a replica writes the merged
+/// classifier and no region state.
+class ClassifierReplicas {
+public:
+  struct Options {
+    int merge_every = 1000;  ///< Steps per replica between classifier merges.
+    int threads = 0;         ///< Replicas stepped at once (0 = all cores).
+  };
+
+  explicit ClassifierReplicas(const Options& opts);
+
+  /// Add a replica and return it.  Throws std::invalid_argument on null or
+  /// if its classifier is off (set_classifier()), since that is what merges.
+  TextRuntime& add(std::unique_ptr<TextRuntime> replica);
+
+  /// Step every replica `steps` times, merging every `merge_every` steps
+  /// and once more at the end.  Exceptions from a replica propagate.
+  void run(std::int64_t steps);
+
+  /// Fold what each replica learned since the last merge into merged() and
+  /// hand the result back to every replica.
+  void merge();
+
+  const SymbolClassifier& merged() const { return merged_; }
+  std::uint64_t merges() const { return merges_; }
+  std::size_t size() const { return batch_.size(); }
+  TextRuntime& replica(std::size_t i) { return batch_.stream(i); }
+  const TextRuntime& replica(std::size_t i) const { return batch_.stream(i); }
+  /// Mean of the replicas' cumulative prediction accuracies.
+  double mean_accuracy() const { return batch_.mean_accuracy(); }
+
+private:
+  Options opts_;
+  TextRuntimeBatch batch_;
+  SymbolClassifier merged_;
+  std::uint64_t merges_{0};
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <htm_gui/runtime.hpp>
+
+namespace chat_htm {
+
+namespace column_kernels {
+
+/// Overwrite `words[0 .. (n + 63) / 64)` with bit c set iff column c of
+/// `masks` has a predictive cell.  Bits past `n` in the last word are zero.
+///
+/// TextRuntime packs layer 0 snapshots this way for the classifier decode.
+/// Columns are packed 64 per word with no per-bit read-modify-write, so the
+/// scan is one pass over the masks whatever the layer shape.
+inline void pack_predictive(const htm_gui::ColumnCellMasks* masks, std::size_t n,
+                            std::uint64_t* words) {
+  const std::size_t full = n / 64;
+  for (std::size_t w = 0; w < full; ++w) {
+    const htm_gui::ColumnCellMasks* block = masks + w * 64;
+    std::uint64_t bits = 0;
+    for (int j = 0; j < 64; ++j) {
+      bits |= static_cast<std::uint64_t>(block[j].predictive != 0) << j;
+    }
+    words[w] = bits;
+  }
+  if (const std::size_t rest = n - full * 64; rest != 0) {
+    const htm_gui::ColumnCellMasks* block = masks + full * 64;
+    std::uint64_t bits = 0;
+    for (std::size_t j = 0; j < rest; ++j) {
+      bits |= static_cast<std::uint64_t>(block[j].predictive != 0) << j;
+    }
+    words[full] = bits;
+  }
+}
+
+}  // namespace column_kernels
+
+}  // namespace chat_htm
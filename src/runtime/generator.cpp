@@ -0,0 +1,45 @@
+#include "runtime/generator.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace chat_htm {
+
+Generation generate(TextRuntime& runtime, std::string_view prompt, const GenerateOptions& opts) {
+  if (runtime.classifier_top_k() <= 0) {
+    throw std::invalid_argument("generate: the runtime's classifier is off (set_classifier)");
+  }
+  if (!runtime.permanences_frozen() && !opts.allow_region_learning) {
+    throw std::invalid_argument(
+        "generate: the region learns and cannot be paused; build it with freeze_permanences() "
+        "or set allow_region_learning");
+  }
+  Generation g;
+  g.prompt = runtime.text_symbols(prompt);
+  for (std::uint32_t s : g.prompt) runtime.feed(s);
+
+  const bool words = runtime.input_mode() != TextRuntime::InputMode::Character;
+  g.symbols.reserve(static_cast<std::size_t>(opts.tokens > 0 ? opts.tokens : 0));
+  for (int i = 0; i < opts.tokens; ++i) {
+    if (runtime.predictions().empty()) {
+      g.stalled = true;
+      break;
+    }
+    const std::uint32_t next = runtime.predictions().front().symbol;
+    const auto start = std::chrono::steady_clock::now();
+    runtime.feed(next);
+    const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    g.latency.record(ns);
+    if (opts.budget_ns > 0 && ns > opts.budget_ns) ++g.over_budget;
+    g.symbols.push_back(next);
+  }
+
+  for (std::size_t i = 0; i < g.symbols.size(); ++i) {
+    if (words && i > 0) g.text += ' ';
+    g.text += runtime.symbol_text(g.symbols[i]);
+  }
+  return g;
+}
+
+}  // namespace chat_htm
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "runtime/stage_timers.hpp"
+#include "runtime/text_runtime.hpp"
+
+namespace chat_htm {
+
+/// Settings for generate().
+struct GenerateOptions {
+  int tokens{0};               ///< Symbols to generate after the prompt.
+  std::uint64_t budget_ns{0};  ///< Per-token latency budget (0 = none).
+  /// Accept a learning region.  htm_flow cannot pause learning, so such a
+  /// region also learns from the prompt and its own output.
+  bool allow_region_learning{false};
+};
+
+/// Output of one generate() call.
+struct Generation {
+  std::vector<std::uint32_t> prompt;   ///< Prompt symbols that were fed.
+  std::vector<std::uint32_t> symbols;  ///< Generated symbols, in order.
+  std::string text;                    ///< `symbols` as text (words space-separated).
+  LatencyHistogram latency;            ///< One sample per generated token.
+  std::size_t over_budget{0};          ///< Tokens slower than the budget.
+  /// True if generation stopped early because nothing was predicted.
+  bool stalled{false};
+};
+
+/// Autoregressive text generation (`--generate N --prompt TEXT`).
+///
+/// Feeds the prompt to `runtime` through TextRuntime::feed(), then
+/// repeatedly takes the classifier's top prediction and feeds it back, so
+/// each token costs one region step, one decode and a full layer 0 snapshot
+/// copy (htm_flow exposes predictive cells no other way).
+/// An empty prompt continues from the runtime's current predictions.  The
+/// classifier must be on and trained (set_classifier() before stepping the
+/// corpus, or loaded); it does not learn while generating.  htm_flow has no
+/// runtime learning switch, so permanences only stay fixed when the region
+/// was built with freeze_permanences(), and even then htm_flow may grow new
+/// segments from the generated text.  Throws std::invalid_argument
+/// if the classifier is off, or if the region learns and
+/// `allow_region_learning` is not set.
+Generation generate(TextRuntime& runtime, std::string_view prompt, const GenerateOptions& opts);
+
+}  // namespace chat_htm
@@ -0,0 +1,91 @@
+#include "runtime/layer_pipeline.hpp"
+
+#include <utility>
+
+namespace chat_htm {
+
+LayerPipeline::LayerPipeline(htm_flow::HTMRegion& region, std::int64_t start_tick)
+    : region_(region),
+      start_tick_(start_tick),
+      inputs_(static_cast<std::size_t>(region.num_layers())) {
+  workers_.reserve(inputs_.size() > 0 ? inputs_.size() - 1 : 0);
+  for (int k = 1; k < num_layers(); ++k) {
+    workers_.emplace_back(&LayerPipeline::worker, this, k);
+  }
+}
+
+LayerPipeline::~LayerPipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& t : workers_) t.join();
+}
+
+void LayerPipeline::tick() {
+  // Capture last tick's outputs before anything steps, so every layer sees
+  // a consistent wavefront.  Layer k has input once layer k-1 has run.
+  for (int k = 1; k < num_layers(); ++k) {
+    inputs_[static_cast<std::size_t>(k)] =
+        ticks_ >= k ? region_.layer(k - 1).output() : nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = static_cast<int>(workers_.size());
+    ++generation_;
+  }
+  start_cv_.notify_all();
+
+  std::exception_ptr error;
+  try {
+    step_layer(0);
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [&] { return pending_ == 0; });
+  if (!error) error = std::exchange(error_, nullptr);
+  error_ = nullptr;
+  lock.unlock();
+
+  ++ticks_;
+  if (error) std::rethrow_exception(error);
+}
+
+void LayerPipeline::step_layer(int layer) {
+  auto& l = region_.layer(layer);
+  if (layer > 0) {
+    auto& in = inputs_[static_cast<std::size_t>(layer)];
+    if (!in) return;  // Still filling the pipeline.
+    l.set_input(std::move(in));
+  }
+  l.step(1);
+}
+
+void LayerPipeline::worker(int layer) {
+  std::uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+    }
+    std::exception_ptr error;
+    try {
+      step_layer(layer);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (error && !error_) error_ = error;
+      if (--pending_ == 0) done_cv_.notify_one();
+    }
+  }
+}
+
+}  // namespace chat_htm
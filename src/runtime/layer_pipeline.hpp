@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <htm_flow/htm_region.hpp>
+
+namespace chat_htm {
+
+/// Wavefront execution of an HTMRegion's layers, one thread per layer.
+///
+/// Each tick steps every layer concurrently: layer 0 consumes the input for
+/// tick t while layer k consumes the output layer k-1 produced on the
+/// previous tick.  Layer k therefore runs k ticks behind layer 0 (one step
+/// of latency per layer) and does not step at all until its first input
+/// exists.  With N layers a tick costs roughly one layer's step instead of
+/// N, at the price of the latency.
+///
+/// Layers are driven directly through `HTMRegion::layer(k)`, bypassing
+/// `HTMRegion::step()`, so this is only equivalent to the region's own
+/// feed-forward schedule when feedback is disabled, and the region's
+/// timestep() does not advance; use ticks() instead.
+class LayerPipeline {
+public:
+  /// @param start_tick Tick count to continue from (e.g. region.timestep()).
+  LayerPipeline(htm_flow::HTMRegion& region, std::int64_t start_tick = 0);
+  ~LayerPipeline();
+
+  LayerPipeline(const LayerPipeline&) = delete;
+  LayerPipeline& operator=(const LayerPipeline&) = delete;
+
+  /// Step every layer once.  Layer 0's input must already be set.  An
+  /// exception from any layer is rethrown here.
+  void tick();
+
+  std::int64_t ticks() const { return start_tick_ + ticks_; }
+  int num_layers() const { return static_cast<int>(inputs_.size()); }
+
+private:
+  void worker(int layer);
+  void step_layer(int layer);
+
+  htm_flow::HTMRegion& region_;
+  std::int64_t start_tick_;
+  std::int64_t ticks_{0};
+  /// Input handed to each layer for the current tick (index 0 unused).
+  std::vector<std::shared_ptr<const std::vector<int>>> inputs_;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  std::uint64_t generation_{0};
+  int pending_{0};
+  bool stop_{false};
+  std::exception_ptr error_;
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,184 @@
+#include "runtime/metrics_server.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "runtime/text_runtime.hpp"
+
+namespace chat_htm {
+
+RunMetrics::RunMetrics(int layers)
+    : num_layers(layers < 0 ? 0 : layers),
+      active_columns(std::make_unique<std::atomic<int>[]>(static_cast<std::size_t>(num_layers))),
+      predictive_columns(std::make_unique<std::atomic<int>[]>(static_cast<std::size_t>(num_layers))) {
+  for (int k = 0; k < num_layers; ++k) {
+    active_columns[k].store(0, std::memory_order_relaxed);
+    predictive_columns[k].store(0, std::memory_order_relaxed);
+  }
+}
+
+MetricsServer::MetricsServer(const Options& opts, int num_layers)
+    : opts_(opts), metrics_(num_layers) {
+  listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    throw std::runtime_error(std::string("MetricsServer: socket failed: ") + std::strerror(errno));
+  }
+  const int one = 1;
+  ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<std::uint16_t>(opts_.port));
+  if (::inet_pton(AF_INET, opts_.host.c_str(), &addr.sin_addr) != 1) {
+    ::close(listen_fd_);
+    throw std::runtime_error("MetricsServer: bad IPv4 address: " + opts_.host);
+  }
+  if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+      || ::listen(listen_fd_, 8) != 0) {
+    const std::string err = std::strerror(errno);
+    ::close(listen_fd_);
+    throw std::runtime_error("MetricsServer: cannot listen on " + opts_.host + ":"
+                             + std::to_string(opts_.port) + ": " + err);
+  }
+  socklen_t len = sizeof(addr);
+  ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+  port_ = ntohs(addr.sin_port);
+  thread_ = std::thread(&MetricsServer::serve, this);
+}
+
+MetricsServer::~MetricsServer() {
+  stop_.store(true);
+  if (thread_.joinable()) thread_.join();
+  if (listen_fd_ >= 0) ::close(listen_fd_);
+}
+
+void MetricsServer::publish(const TextRuntime& runtime) {
+  const auto now = std::chrono::steady_clock::now();
+  const std::int64_t steps = runtime.timestep();
+  const std::int64_t correct = runtime.correct_predictions();
+  const std::int64_t total = runtime.total_predictions();
+
+  if (published_) {
+    const double secs = std::chrono::duration<double>(now - last_publish_).count();
+    if (secs > 0.0) {
+      metrics_.steps_per_sec.store(static_cast<double>(steps - last_steps_) / secs,
+                                   std::memory_order_relaxed);
+    }
+  }
+  last_publish_ = now;
+  last_steps_ = steps;
+  published_ = true;
+
+  // Accuracy over the window is the change in the cumulative counters
+  // since the oldest sample still inside it.
+  window_.push_back({steps, correct, total});
+  while (window_.size() > 1 && steps - window_.front().steps > opts_.window_steps) {
+    window_.pop_front();
+  }
+  const Sample& oldest = window_.front();
+  const std::int64_t window_total = total - oldest.total;
+  metrics_.window_samples.store(window_total, std::memory_order_relaxed);
+  metrics_.window_accuracy.store(
+      window_total > 0 ? static_cast<double>(correct - oldest.correct) / window_total : 0.0,
+      std::memory_order_relaxed);
+
+  metrics_.steps.store(steps, std::memory_order_relaxed);
+  metrics_.epoch.store(runtime.input_epoch(), std::memory_order_relaxed);
+  metrics_.accuracy.store(runtime.prediction_accuracy(), std::memory_order_relaxed);
+
+  const int layers = std::min(metrics_.num_layers, runtime.num_layers());
+  for (int k = 0; k < layers; ++k) {
+    const auto snap = runtime.region().layer(k).snapshot();
+    int predictive = 0;
+    for (const auto& cells : snap.column_cell_masks) predictive += cells.predictive != 0;
+    metrics_.active_columns[k].store(static_cast<int>(snap.active_column_indices.size()),
+                                     std::memory_order_relaxed);
+    metrics_.predictive_columns[k].store(predictive, std::memory_order_relaxed);
+  }
+}
+
+std::string MetricsServer::render(const RunMetrics& m, std::int64_t rss_bytes) {
+  std::ostringstream out;
+  auto gauge = [&](const char* name, const char* help, const char* type, auto value) {
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n'
+        << name << ' ' << value << '\n';
+  };
+  const auto relaxed = std::memory_order_relaxed;
+  gauge("chat_htm_steps_total", "Region steps taken.", "counter", m.steps.load(relaxed));
+  gauge("chat_htm_epoch", "Passes completed over the input.", "gauge", m.epoch.load(relaxed));
+  gauge("chat_htm_steps_per_second", "Step rate over the last publish interval.", "gauge",
+        m.steps_per_sec.load(relaxed));
+  gauge("chat_htm_prediction_accuracy", "Cumulative prediction accuracy (0-1).", "gauge",
+        m.accuracy.load(relaxed));
+  gauge("chat_htm_prediction_accuracy_window", "Prediction accuracy over the recent window.",
+        "gauge", m.window_accuracy.load(relaxed));
+  gauge("chat_htm_prediction_window_samples", "Accuracy samples in the recent window.", "gauge",
+        m.window_samples.load(relaxed));
+  if (rss_bytes >= 0) {
+    gauge("chat_htm_resident_bytes", "Resident set size of the process.", "gauge", rss_bytes);
+  }
+  out << "# HELP chat_htm_active_columns Active columns per layer.\n"
+      << "# TYPE chat_htm_active_columns gauge\n";
+  for (int k = 0; k < m.num_layers; ++k) {
+    out << "chat_htm_active_columns{layer=\"" << k << "\"} " << m.active_columns[k].load(relaxed)
+        << '\n';
+  }
+  out << "# HELP chat_htm_predictive_columns Columns with a predictive cell per layer.\n"
+      << "# TYPE chat_htm_predictive_columns gauge\n";
+  for (int k = 0; k < m.num_layers; ++k) {
+    out << "chat_htm_predictive_columns{layer=\"" << k << "\"} "
+        << m.predictive_columns[k].load(relaxed) << '\n';
+  }
+  return out.str();
+}
+
+std::int64_t MetricsServer::resident_bytes() {
+  std::ifstream statm("/proc/self/statm");
+  std::int64_t pages = 0, resident = 0;
+  if (!(statm >> pages >> resident)) return -1;
+  return resident * static_cast<std::int64_t>(::sysconf(_SC_PAGESIZE));
+}
+
+void MetricsServer::serve() {
+  while (!stop_.load()) {
+    // Wake up regularly so the destructor never waits long.
+    pollfd pfd{listen_fd_, POLLIN, 0};
+    if (::poll(&pfd, 1, 100) <= 0) continue;
+    const int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) continue;
+    // A client that never sends its request must not stall the server.
+    timeval timeout{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char request[1024];
+    const ssize_t n = ::recv(fd, request, sizeof(request) - 1, 0);
+    const std::string line = n > 0 ? std::string(request, static_cast<std::size_t>(n)) : "";
+    std::string response;
+    if (line.rfind("GET /metrics", 0) == 0 || line.rfind("GET / ", 0) == 0) {
+      const std::string body = render(metrics_, resident_bytes());
+      response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                 + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    } else {
+      response = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+    std::size_t sent = 0;
+    while (sent < response.size()) {
+      const ssize_t w = ::send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+      if (w <= 0) break;
+      sent += static_cast<std::size_t>(w);
+    }
+    ::close(fd);
+  }
+}
+
+}  // namespace chat_htm
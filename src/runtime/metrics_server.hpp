@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace chat_htm {
+
+class TextRuntime;
+
+/// Gauges for one run, written by the stepping thread and read by the
+/// metrics server.  Every field is an independent relaxed atomic: a scrape
+/// may mix values from neighbouring publishes, but nobody ever blocks.
+struct RunMetrics {
+  explicit RunMetrics(int num_layers);
+
+  std::atomic<std::int64_t> steps{0};
+  std::atomic<std::int64_t> epoch{0};
+  std::atomic<double> steps_per_sec{0.0};     ///< Over the last publish interval.
+  std::atomic<double> accuracy{0.0};          ///< Cumulative prediction_accuracy().
+  std::atomic<double> window_accuracy{0.0};   ///< Over the last `window_steps`.
+  std::atomic<std::int64_t> window_samples{0};
+  int num_layers{0};
+  std::unique_ptr<std::atomic<int>[]> active_columns;      ///< Per layer.
+  std::unique_ptr<std::atomic<int>[]> predictive_columns;  ///< Per layer.
+};
+
+/// Prometheus text-format endpoint for long headless runs (`--metrics-port`).
+///
+/// A background thread answers `GET /metrics` with the current RunMetrics
+/// plus the process RSS; the stepping thread only calls publish() every
+/// few hundred steps, which stores a handful of atomics and takes one
+/// snapshot per layer for the column counts.  Linux/POSIX sockets only.
+class MetricsServer {
+public:
+  struct Options {
+    std::string host = "127.0.0.1";
+    int port = 0;                  ///< 0 = pick a free port (see port()).
+    std::int64_t window_steps = 1000;
+  };
+
+  /// Binds and starts serving.  Throws std::runtime_error if the socket
+  /// cannot be opened or bound.
+  MetricsServer(const Options& opts, int num_layers);
+  ~MetricsServer();
+
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+
+  /// Port actually bound.
+  int port() const { return port_; }
+  RunMetrics& metrics() { return metrics_; }
+  const RunMetrics& metrics() const { return metrics_; }
+
+  /// Update the gauges from `runtime`.  Stepping thread only.
+  void publish(const TextRuntime& runtime);
+
+  /// Prometheus exposition text for `m`; `rss_bytes` < 0 omits RSS.
+  static std::string render(const RunMetrics& m, std::int64_t rss_bytes);
+  /// Resident set size of this process, or -1 if unavailable.
+  static std::int64_t resident_bytes();
+
+private:
+  void serve();
+
+  struct Sample {
+    std::int64_t steps;
+    std::int64_t correct;
+    std::int64_t total;
+  };
+
+  Options opts_;
+  RunMetrics metrics_;
+  int listen_fd_{-1};
+  int port_{0};
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+
+  // publish() state, stepping thread only.
+  std::deque<Sample> window_;
+  std::chrono::steady_clock::time_point last_publish_;
+  std::int64_t last_steps_{0};
+  bool published_{false};
+};
+
+}  // namespace chat_htm
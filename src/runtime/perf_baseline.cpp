@@ -0,0 +1,100 @@
+#include "runtime/perf_baseline.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <yaml-cpp/yaml.h>
+
+namespace chat_htm {
+
+namespace {
+
+/// Case names are plain keys ("char/c400/l1/learn/t1"); escape just enough
+/// to keep the output valid JSON whatever they hold.
+std::string quoted(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out.push_back('\\');
+    out.push_back(c);
+  }
+  out.push_back('"');
+  return out;
+}
+
+}  // namespace
+
+std::string perf_results_json(const std::vector<PerfResult>& results) {
+  std::ostringstream out;
+  out << "{\"version\": 1, \"cases\": [";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const PerfResult& r = results[i];
+    out << (i ? "," : "") << "\n  {\"name\": " << quoted(r.name)
+        << ", \"steps_per_sec\": " << r.steps_per_sec
+        << ", \"startup_ms\": " << r.startup_ms
+        << ", \"peak_rss_kib\": " << r.peak_rss_kib << "}";
+  }
+  out << (results.empty() ? "]}\n" : "\n]}\n");
+  return out.str();
+}
+
+std::vector<PerfResult> load_perf_results(const std::string& path) {
+  // JSON is a subset of YAML, so the config parser reads it as is.
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(path);
+  } catch (const YAML::Exception& e) {
+    throw std::runtime_error("perf baseline: cannot read " + path + ": " + e.what());
+  }
+  const YAML::Node cases = root["cases"];
+  if (!cases || !cases.IsSequence()) {
+    throw std::runtime_error("perf baseline: " + path + " has no \"cases\" list");
+  }
+  std::vector<PerfResult> out;
+  out.reserve(cases.size());
+  for (const auto& c : cases) {
+    try {
+      PerfResult r;
+      r.name = c["name"].as<std::string>();
+      r.steps_per_sec = c["steps_per_sec"].as<double>();
+      r.startup_ms = c["startup_ms"].as<double>();
+      r.peak_rss_kib = c["peak_rss_kib"].as<std::int64_t>();
+      out.push_back(std::move(r));
+    } catch (const YAML::Exception& e) {
+      throw std::runtime_error("perf baseline: " + path + ": malformed case: " + e.what());
+    }
+  }
+  return out;
+}
+
+PerfComparison compare_perf(const std::vector<PerfResult>& baseline,
+                            const std::vector<PerfResult>& measured,
+                            const PerfTolerance& tolerance) {
+  std::unordered_map<std::string, const PerfResult*> by_name;
+  for (const PerfResult& b : baseline) by_name[b.name] = &b;
+
+  PerfComparison cmp;
+  for (const PerfResult& m : measured) {
+    auto it = by_name.find(m.name);
+    if (it == by_name.end()) {
+      cmp.unmatched.push_back(m.name);
+      continue;
+    }
+    const PerfResult& b = *it->second;
+    if (m.steps_per_sec < b.steps_per_sec * (1.0 - tolerance.steps_per_sec_drop)) {
+      cmp.regressions.push_back({m.name, "steps_per_sec", b.steps_per_sec, m.steps_per_sec});
+    }
+    if (static_cast<double>(m.peak_rss_kib)
+        > static_cast<double>(b.peak_rss_kib) * (1.0 + tolerance.peak_rss_growth)) {
+      cmp.regressions.push_back({m.name, "peak_rss_kib", static_cast<double>(b.peak_rss_kib),
+                                 static_cast<double>(m.peak_rss_kib)});
+    }
+    if (m.startup_ms > b.startup_ms * (1.0 + tolerance.startup_growth)
+        && m.startup_ms - b.startup_ms > tolerance.startup_floor_ms) {
+      cmp.regressions.push_back({m.name, "startup_ms", b.startup_ms, m.startup_ms});
+    }
+  }
+  return cmp;
+}
+
+}  // namespace chat_htm
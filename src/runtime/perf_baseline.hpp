@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chat_htm {
+
+/// One measured case of the throughput harness (chat_htm_perf).
+struct PerfResult {
+  std::string name;            ///< Case key, e.g. "char/c400/l1/learn/t1".
+  double steps_per_sec{0.0};   ///< Aggregate over all streams of the case.
+  double startup_ms{0.0};      ///< Config load to the end of the first step.
+  std::int64_t peak_rss_kib{0};
+};
+
+/// How far a result may move from its baseline before it counts as a
+/// regression.  Fractions are relative to the baseline value.
+struct PerfTolerance {
+  double steps_per_sec_drop = 0.15;  ///< Fail below baseline * (1 - this).
+  double peak_rss_growth = 0.10;     ///< Fail above baseline * (1 + this).
+  double startup_growth = 0.25;      ///< Fail above baseline * (1 + this) ...
+  double startup_floor_ms = 5.0;     ///< ... and more than this many ms slower.
+};
+
+/// One metric of one case that moved past its tolerance.
+struct PerfRegression {
+  std::string name;
+  std::string metric;  ///< "steps_per_sec", "peak_rss_kib" or "startup_ms".
+  double baseline{0.0};
+  double measured{0.0};
+};
+
+struct PerfComparison {
+  std::vector<PerfRegression> regressions;
+  std::vector<std::string> unmatched;  ///< Measured cases with no baseline entry.
+  /// No regressions and, when `require_baseline`, no unmatched cases: a
+  /// case the baseline does not cover has not been checked at all.
+  bool ok(bool require_baseline = true) const {
+    return regressions.empty() && (!require_baseline || unmatched.empty());
+  }
+};
+
+/// Results as JSON: `{"version": 1, "cases": [{"name": ..., ...}, ...]}`.
+std::string perf_results_json(const std::vector<PerfResult>& results);
+
+/// Read a file written from perf_results_json().  Throws std::runtime_error
+/// if it cannot be read or a case is malformed.
+std::vector<PerfResult> load_perf_results(const std::string& path);
+
+/// Check every measured case against the baseline case of the same name.
+/// Cases missing from the baseline are listed in `unmatched`; whether they
+/// fail is up to PerfComparison::ok().
+PerfComparison compare_perf(const std::vector<PerfResult>& baseline,
+                            const std::vector<PerfResult>& measured,
+                            const PerfTolerance& tolerance = {});
+
+}  // namespace chat_htm
@@ -0,0 +1,104 @@
+#include "runtime/runtime_batch.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "text/text_preprocess.hpp"
+
+namespace chat_htm {
+
+TextRuntimeBatch::~TextRuntimeBatch() { stop_workers(); }
+
+TextRuntime& TextRuntimeBatch::add(std::unique_ptr<TextRuntime> runtime) {
+  if (!runtime) {
+    throw std::invalid_argument("TextRuntimeBatch: runtime must not be null");
+  }
+  streams_.push_back(std::move(runtime));
+  return *streams_.back();
+}
+
+void TextRuntimeBatch::step(int n) {
+  if (n <= 0 || streams_.empty()) return;
+  if (grouped_streams_ != streams_.size()) start_workers();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    steps_ = n;
+    pending_ = static_cast<int>(workers_.size());
+    ++generation_;
+  }
+  start_cv_.notify_all();
+
+  std::exception_ptr error = step_group(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [&] { return pending_ == 0; });
+  if (!error) error = error_;
+  error_ = nullptr;
+  lock.unlock();
+
+  if (error) std::rethrow_exception(error);
+}
+
+void TextRuntimeBatch::start_workers() {
+  stop_workers();
+  const std::size_t count = streams_.size();
+  const auto n = std::min(count, static_cast<std::size_t>(preprocess::worker_count(threads_)));
+  groups_.clear();
+  for (std::size_t w = 0; w < n; ++w) {
+    groups_.emplace_back(count * w / n, count * (w + 1) / n);
+  }
+  grouped_streams_ = count;
+
+  stop_ = false;
+  workers_.reserve(n > 0 ? n - 1 : 0);
+  for (std::size_t w = 1; w < n; ++w) {
+    workers_.emplace_back(&TextRuntimeBatch::worker, this, w, generation_);
+  }
+}
+
+void TextRuntimeBatch::stop_workers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& t : workers_) t.join();
+  workers_.clear();
+}
+
+std::exception_ptr TextRuntimeBatch::step_group(std::size_t group) {
+  const auto [first, last] = groups_[group];
+  try {
+    for (std::size_t i = first; i < last; ++i) streams_[i]->step(steps_);
+  } catch (...) {
+    return std::current_exception();
+  }
+  return nullptr;
+}
+
+void TextRuntimeBatch::worker(std::size_t group, std::uint64_t seen) {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+    }
+    std::exception_ptr error = step_group(group);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (error && !error_) error_ = error;
+      if (--pending_ == 0) done_cv_.notify_one();
+    }
+  }
+}
+
+double TextRuntimeBatch::mean_accuracy() const {
+  if (streams_.empty()) return 0.0;
+  double sum = 0.0;
+  for (const auto& s : streams_) sum += s->prediction_accuracy();
+  return sum / static_cast<double>(streams_.size());
+}
+
+}  // namespace chat_htm
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "runtime/text_runtime.hpp"
+
+namespace chat_htm {
+
+/// Steps K independent TextRuntime streams (e.g. one per document being
+/// scored) side by side.
+///
+/// Streams are divided into contiguous groups, one per worker, and each
+/// worker advances its streams `n` steps before the call returns.  The
+/// workers are started on the first step() and kept until the batch is
+/// destroyed (or restarted once if streams are added later), so a call
+/// costs one wake-up and one join per worker rather than a thread spawn;
+/// group 0 runs on the calling thread.  Streams share nothing and are
+/// never touched by two workers, so each keeps its own region, cursor and
+/// accuracy counters.
+///
+/// htm_flow keeps each region's connectivity private, so streams cannot
+/// share one synapse matrix; the batch parallelizes whole regions instead.
+/// Per-step text logging (set_log_text) interleaves between streams.
+class TextRuntimeBatch {
+public:
+  /// @param threads Worker count (0 = all cores); never more than streams.
+  explicit TextRuntimeBatch(int threads = 0) : threads_(threads) {}
+  ~TextRuntimeBatch();
+
+  TextRuntimeBatch(const TextRuntimeBatch&) = delete;
+  TextRuntimeBatch& operator=(const TextRuntimeBatch&) = delete;
+
+  /// Add a stream and return it.  Throws std::invalid_argument on null.
+  TextRuntime& add(std::unique_ptr<TextRuntime> runtime);
+
+  std::size_t size() const { return streams_.size(); }
+  bool empty() const { return streams_.empty(); }
+  TextRuntime& stream(std::size_t i) { return *streams_.at(i); }
+  const TextRuntime& stream(std::size_t i) const { return *streams_.at(i); }
+
+  /// Advance every stream by `n` steps.  An exception from any stream is
+  /// rethrown here after all workers have stopped.
+  void step(int n = 1);
+
+  /// Mean of the streams' cumulative prediction accuracies.
+  double mean_accuracy() const;
+
+  /// Worker threads currently running, besides the caller (0 before the
+  /// first step()).
+  std::size_t pool_size() const { return workers_.size(); }
+
+private:
+  /// Split the streams into groups and start one worker per extra group.
+  void start_workers();
+  void stop_workers();
+  /// Step `group` on every generation after `seen` until stopped.
+  void worker(std::size_t group, std::uint64_t seen);
+  /// Step group `group` by steps_; returns the first exception, if any.
+  std::exception_ptr step_group(std::size_t group);
+
+  std::vector<std::unique_ptr<TextRuntime>> streams_;
+  int threads_;
+
+  /// Stream ranges [first, second), one per worker; built by start_workers().
+  std::vector<std::pair<std::size_t, std::size_t>> groups_;
+  std::size_t grouped_streams_{0};  ///< streams_.size() when groups_ was built.
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  std::uint64_t generation_{0};
+  int steps_{0};  ///< `n` of the step() in progress.
+  int pending_{0};
+  bool stop_{false};
+  std::exception_ptr error_;
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,79 @@
+#include "runtime/snapshot_delta.hpp"
+
+#include <utility>
+
+namespace chat_htm {
+
+void SnapshotDelta::apply(htm_gui::Snapshot& view) const {
+  if (full) {
+    view.column_cell_masks.assign(num_columns, htm_gui::ColumnCellMasks{});
+    view.active_column_indices.clear();
+  }
+  // Merge the sorted change list into the sorted active list.
+  std::vector<int> active;
+  active.reserve(view.active_column_indices.size() + columns.size());
+  auto it = view.active_column_indices.begin();
+  const auto end = view.active_column_indices.end();
+  for (const ColumnChange& ch : columns) {
+    while (it != end && *it < ch.column) active.push_back(*it++);
+    if (it != end && *it == ch.column) ++it;
+    if (ch.active) active.push_back(ch.column);
+    if (ch.column >= 0 && static_cast<std::size_t>(ch.column) < view.column_cell_masks.size()) {
+      view.column_cell_masks[static_cast<std::size_t>(ch.column)] = ch.cells;
+    }
+  }
+  active.insert(active.end(), it, end);
+  view.active_column_indices = std::move(active);
+}
+
+const SnapshotDelta& SnapshotTracker::update(const htm_gui::Snapshot& snap, std::uint64_t since,
+                                             int layer, std::uint64_t version) {
+  const std::size_t num_columns = snap.column_cell_masks.size();
+  const bool full = since == 0 || since != version_ || layer != layer_
+                    || num_columns != cells_.size();
+
+  if (next_active_.size() != num_columns) {
+    next_active_ = Sdr(num_columns);
+  } else {
+    next_active_.reset();
+  }
+  for (int idx : snap.active_column_indices) {
+    if (idx >= 0 && static_cast<std::size_t>(idx) < num_columns) {
+      next_active_.set(static_cast<std::size_t>(idx));
+    }
+  }
+
+  delta_.base_version = full ? 0 : since;
+  delta_.version = version;
+  delta_.layer = layer;
+  delta_.full = full;
+  delta_.num_columns = num_columns;
+  delta_.columns.clear();
+  for (std::size_t c = 0; c < num_columns; ++c) {
+    const auto& cells = snap.column_cell_masks[c];
+    const bool active = next_active_.test(c);
+    if (!full && active == active_.test(c) && cells.active == cells_[c].active
+        && cells.predictive == cells_[c].predictive) {
+      continue;
+    }
+    delta_.columns.push_back({static_cast<int>(c), active, cells});
+  }
+
+  std::swap(active_, next_active_);
+  cells_ = snap.column_cell_masks;
+  version_ = version;
+  layer_ = layer;
+  return delta_;
+}
+
+const SnapshotDelta& SnapshotTracker::unchanged() {
+  delta_.base_version = version_;
+  delta_.version = version_;
+  delta_.layer = layer_;
+  delta_.full = false;
+  delta_.num_columns = cells_.size();
+  delta_.columns.clear();
+  return delta_;
+}
+
+}  // namespace chat_htm
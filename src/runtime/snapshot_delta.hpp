@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <htm_gui/runtime.hpp>
+
+#include "encoders/sdr.hpp"
+
+namespace chat_htm {
+
+/// One column whose state differs from the base snapshot.
+struct ColumnChange {
+  int column{0};
+  bool active{false};
+  htm_gui::ColumnCellMasks cells;
+};
+
+/// Changes to one layer's column and cell state between two versions.
+///
+/// A `full` delta (a keyframe) lists every column and replaces the
+/// receiver's view; otherwise only changed columns are listed, in
+/// ascending order, and apply on top of the view at `base_version`.
+struct SnapshotDelta {
+  std::uint64_t base_version{0};
+  std::uint64_t version{0};
+  int layer{0};
+  bool full{false};
+  std::size_t num_columns{0};
+  std::vector<ColumnChange> columns;
+
+  /// Bring `view` from `base_version` to `version`.  active_column_indices
+  /// comes out sorted.
+  void apply(htm_gui::Snapshot& view) const;
+};
+
+/// Server side of the versioned snapshot API: remembers the state it last
+/// reported and diffs each new snapshot against it.
+///
+/// A tracker serves one receiver.  A request for any version other than
+/// the last one reported (a new receiver, a layer switch, a dropped delta)
+/// gets a keyframe.
+class SnapshotTracker {
+public:
+  /// Version of the state last reported (0 = none yet).
+  std::uint64_t version() const { return version_; }
+  int layer() const { return layer_; }
+
+  /// True if a request for `since` can be answered from the current state
+  /// without a new snapshot: nothing has stepped since it was reported.
+  bool current(std::uint64_t since, int layer, std::uint64_t version) const {
+    return since != 0 && since == version_ && version == version_ && layer == layer_;
+  }
+
+  /// Diff `snap`, taken at `version` of `layer`, against the last reported
+  /// state and make it the new base.  The returned delta is reused by the
+  /// next call.
+  const SnapshotDelta& update(const htm_gui::Snapshot& snap, std::uint64_t since, int layer,
+                              std::uint64_t version);
+  /// Empty delta for a receiver that is already up to date.
+  const SnapshotDelta& unchanged();
+
+  void reset() { *this = SnapshotTracker{}; }
+
+private:
+  std::uint64_t version_{0};
+  int layer_{-1};
+  Sdr active_{0};
+  Sdr next_active_{0};
+  std::vector<htm_gui::ColumnCellMasks> cells_;
+  SnapshotDelta delta_;
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace chat_htm {
+
+/// Fixed-capacity single-producer / single-consumer ring buffer.
+///
+/// Slots are constructed once and reused in place: the producer fills the
+/// slot returned by `write_slot()` and calls `publish()`, the consumer reads
+/// `read_slot()` and calls `release()`.  Neither side blocks or allocates;
+/// a null slot means the ring is full (producer) or empty (consumer), and
+/// the caller decides how to wait.
+///
+/// Exactly one thread may call the producer methods and exactly one the
+/// consumer methods.
+template <typename T>
+class SpscRing {
+public:
+  /// Capacity is rounded up to a power of two (minimum 2).
+  explicit SpscRing(std::size_t capacity) {
+    std::size_t n = 2;
+    while (n < capacity) n <<= 1;
+    slots_.resize(n);
+    mask_ = n - 1;
+  }
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  std::size_t capacity() const { return slots_.size(); }
+
+  /// Next free slot, or nullptr if the ring is full.  Producer only.
+  T* write_slot() {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == slots_.size()) return nullptr;
+    return &slots_[head & mask_];
+  }
+  /// Make the slot from write_slot() visible to the consumer.
+  void publish() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  /// Oldest published slot, or nullptr if the ring is empty.  Consumer only.
+  T* read_slot() {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == tail) return nullptr;
+    return &slots_[tail & mask_];
+  }
+  /// Hand the slot from read_slot() back to the producer.
+  void release() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+private:
+  std::vector<T> slots_;
+  std::size_t mask_{0};
+  alignas(64) std::atomic<std::size_t> head_{0};  ///< Next slot to write.
+  alignas(64) std::atomic<std::size_t> tail_{0};  ///< Next slot to read.
+};
+
+}  // namespace chat_htm
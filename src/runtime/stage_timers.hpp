@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace chat_htm {
+
+/// Fixed-size latency histogram with log-linear buckets.
+///
+/// Each power of two is split into 4 sub-buckets, so any recorded value is
+/// reported within ~19% of its true value, and record() is a few integer
+/// operations with no allocation.  Values are nanoseconds.
+class LatencyHistogram {
+public:
+  void record(std::uint64_t ns) {
+    ++buckets_[bucket_of(ns)];
+    ++count_;
+    total_ += ns;
+    min_ = std::min(min_, ns);
+    max_ = std::max(max_, ns);
+  }
+
+  std::uint64_t count() const { return count_; }
+  std::uint64_t total_ns() const { return total_; }
+  std::uint64_t min_ns() const { return count_ ? min_ : 0; }
+  std::uint64_t max_ns() const { return max_; }
+  double mean_ns() const { return count_ ? static_cast<double>(total_) / count_ : 0.0; }
+
+  /// Approximate `p`-th percentile (0..100) in nanoseconds: the midpoint of
+  /// the bucket holding that rank, clamped to the observed min/max.  p=0 and
+  /// p=100 are the exact min and max.
+  double percentile(double p) const {
+    if (count_ == 0) return 0.0;
+    if (p <= 0.0) return static_cast<double>(min_);
+    if (p >= 100.0) return static_cast<double>(max_);
+    const auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(count_ - 1));
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+      seen += buckets_[b];
+      if (seen > rank) {
+        const double mid = 0.5 * (static_cast<double>(lower_bound(b)) + static_cast<double>(lower_bound(b + 1)));
+        return std::min(static_cast<double>(max_), std::max(static_cast<double>(min_), mid));
+      }
+    }
+    return static_cast<double>(max_);
+  }
+
+  void reset() { *this = LatencyHistogram{}; }
+
+private:
+  static constexpr int kSubBits = 2;
+  static constexpr std::size_t kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+  /// Values below 2^kSubBits get their own bucket; above that, bucket =
+  /// (octave, top kSubBits bits below the leading one).
+  static std::size_t bucket_of(std::uint64_t v) {
+    if (v < (1u << kSubBits)) return static_cast<std::size_t>(v);
+    int msb = 63;
+    while (!(v >> msb)) --msb;
+    const int shift = msb - kSubBits;
+    const auto sub = static_cast<std::size_t>((v >> shift) & ((1u << kSubBits) - 1));
+    return (static_cast<std::size_t>(shift + 1) << kSubBits) + sub;
+  }
+
+  /// Smallest value that maps to bucket `b` (inverse of bucket_of()).
+  static std::uint64_t lower_bound(std::size_t b) {
+    if (b < (1u << kSubBits)) return b;
+    const int shift = static_cast<int>(b >> kSubBits) - 1;
+    const std::uint64_t sub = b & ((1u << kSubBits) - 1);
+    if (shift + kSubBits >= 64) return std::numeric_limits<std::uint64_t>::max();
+    return ((std::uint64_t{1} << kSubBits) | sub) << shift;
+  }
+
+  std::array<std::uint64_t, kBuckets> buckets_{};
+  std::uint64_t count_{0};
+  std::uint64_t total_{0};
+  std::uint64_t min_{std::numeric_limits<std::uint64_t>::max()};
+  std::uint64_t max_{0};
+};
+
+/// Per-stage timing registry for TextRuntime::step().
+///
+/// Disabled by default; when disabled a ScopedTimer costs one branch.
+/// Only the stepping thread records, so no synchronization is needed.
+/// htm_flow's internal stages (overlap, inhibition, learning, ...) are not
+/// visible from here; `region_step` covers all of them together.
+class StageTimers {
+public:
+  enum Stage : int {
+    kRead,          ///< Chunker next() (character or word id).
+    kEncode,        ///< Symbol -> active indices (table, cache or encoder).
+    kPrefetchWait,  ///< Waiting for the prefetch producer (replaces read+encode).
+    kSetInput,      ///< Sparse update of the dense layer 0 input.
+    kRegionStep,    ///< HTMRegion::step() or one LayerPipeline tick.
+    kAccuracy,      ///< Layer 0 snapshot for the accuracy metric.
+    kClassify,      ///< Next-symbol classifier: snapshot, learn and decode.
+    kStageCount
+  };
+
+  static const char* name(Stage s) {
+    static const char* const kNames[kStageCount] = {
+        "read",        "encode",   "prefetch_wait", "set_input",
+        "region_step", "accuracy", "classify"};
+    return kNames[s];
+  }
+
+  void set_enabled(bool on) { enabled_ = on; }
+  bool enabled() const { return enabled_; }
+
+  LatencyHistogram& operator[](Stage s) { return stages_[s]; }
+  const LatencyHistogram& operator[](Stage s) const { return stages_[s]; }
+
+  void reset() {
+    for (auto& h : stages_) h.reset();
+  }
+
+  /// Stages with at least one sample, as a JSON object keyed by stage name.
+  /// Times are microseconds.
+  std::string to_json() const {
+    std::ostringstream out;
+    out << "{";
+    bool first = true;
+    for (int s = 0; s < kStageCount; ++s) {
+      const auto& h = stages_[s];
+      if (h.count() == 0) continue;
+      out << (first ? "" : ",") << "\n  \"" << name(static_cast<Stage>(s)) << "\": {"
+          << "\"count\": " << h.count()
+          << ", \"total_ms\": " << h.total_ns() / 1e6
+          << ", \"mean_us\": " << h.mean_ns() / 1e3
+          << ", \"p50_us\": " << h.percentile(50) / 1e3
+          << ", \"p99_us\": " << h.percentile(99) / 1e3
+          << ", \"max_us\": " << h.max_ns() / 1e3 << "}";
+      first = false;
+    }
+    out << (first ? "}" : "\n}");
+    return out.str();
+  }
+
+  /// Records the lifetime of the scope into one stage, if timing is on.
+  class ScopedTimer {
+  public:
+    ScopedTimer(StageTimers& timers, Stage stage)
+        : hist_(timers.enabled_ ? &timers.stages_[stage] : nullptr) {
+      if (hist_) start_ = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+      if (hist_) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        hist_->record(static_cast<std::uint64_t>(ns));
+      }
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  private:
+    LatencyHistogram* hist_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+private:
+  bool enabled_{false};
+  std::array<LatencyHistogram, kStageCount> stages_{};
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,133 @@
+#include "runtime/step_logger.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace chat_htm {
+
+namespace {
+
+constexpr char kLogMagic[8] = {'C', 'H', 'T', 'M', 'L', 'O', 'G', '\0'};
+constexpr std::uint32_t kLogVersion = 1;
+/// Output is handed to the stream once this much has been formatted.
+constexpr std::size_t kWriteBlock = 64 * 1024;
+
+void append_csv_field(const std::string& s, std::string& out) {
+  out += '"';
+  for (char c : s) {
+    if (c == '"') out += '"';
+    out += c;
+  }
+  out += '"';
+}
+
+}  // namespace
+
+StepLogger::StepLogger(const Options& opts, ContextFn context)
+    : opts_(opts), context_(std::move(context)), out_(&std::cout), ring_(opts.capacity) {
+  if (opts_.every <= 0) throw std::invalid_argument("StepLogger: every must be > 0");
+  if (opts_.format == Format::Binary && opts_.path.empty()) {
+    throw std::invalid_argument("StepLogger: binary logs need a file path");
+  }
+  if (!opts_.path.empty()) {
+    const auto mode = opts_.format == Format::Binary ? std::ios::binary | std::ios::trunc
+                                                     : std::ios::trunc;
+    file_.open(opts_.path, mode);
+    if (!file_.is_open()) throw std::runtime_error("StepLogger: cannot open log file: " + opts_.path);
+    out_ = &file_;
+  }
+  if (opts_.format == Format::Binary) {
+    const std::uint32_t header[2] = {kLogVersion, static_cast<std::uint32_t>(sizeof(StepRecord))};
+    out_->write(kLogMagic, sizeof(kLogMagic));
+    out_->write(reinterpret_cast<const char*>(header), sizeof(header));
+  } else if (opts_.format == Format::Csv) {
+    *out_ << "step,epoch,accuracy,position,context\n";
+  }
+  writer_ = std::thread(&StepLogger::writer_loop, this);
+}
+
+StepLogger::~StepLogger() {
+  stop_.store(true, std::memory_order_release);
+  if (writer_.joinable()) writer_.join();
+}
+
+StepLogger::Format StepLogger::parse_format(const std::string& name) {
+  if (name == "text") return Format::Text;
+  if (name == "csv") return Format::Csv;
+  if (name == "binary") return Format::Binary;
+  throw std::invalid_argument("StepLogger: unknown log format '" + name + "' (text|csv|binary)");
+}
+
+void StepLogger::log(const StepRecord& r) {
+  StepRecord* slot = ring_.write_slot();
+  while (!slot) {
+    std::this_thread::yield();
+    slot = ring_.write_slot();
+  }
+  *slot = r;
+  ring_.publish();
+  ++logged_;
+}
+
+void StepLogger::flush() {
+  while (written() < logged_) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+void StepLogger::writer_loop() {
+  std::string buf;
+  buf.reserve(kWriteBlock + 256);
+  std::uint64_t pending = 0;  // Formatted but not yet flushed.
+  for (;;) {
+    // Read stop_ before draining so nothing published before it is missed.
+    const bool stopping = stop_.load(std::memory_order_acquire);
+    while (const StepRecord* r = ring_.read_slot()) {
+      format(*r, buf);
+      ring_.release();
+      ++pending;
+      if (buf.size() >= kWriteBlock) write_out(buf);
+    }
+    if (pending > 0) {
+      write_out(buf);
+      out_->flush();
+      written_.fetch_add(std::exchange(pending, 0), std::memory_order_release);
+    }
+    if (stopping) return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void StepLogger::format(const StepRecord& r, std::string& out) const {
+  if (opts_.format == Format::Binary) {
+    out.append(reinterpret_cast<const char*>(&r), sizeof(r));
+    return;
+  }
+  char num[96];
+  if (opts_.format == Format::Csv) {
+    std::snprintf(num, sizeof(num), "%lld,%lld,%.6f,%llu,", static_cast<long long>(r.step),
+                  static_cast<long long>(r.epoch), r.accuracy(),
+                  static_cast<unsigned long long>(r.position));
+    out += num;
+    append_csv_field(context_ ? context_(r.position) : std::string(), out);
+    out += '\n';
+    return;
+  }
+  std::snprintf(num, sizeof(num), "[text] step=%lld  epoch=%lld  accuracy=%.1f%%  | ",
+                static_cast<long long>(r.step), static_cast<long long>(r.epoch),
+                r.accuracy() * 100.0);
+  out += num;
+  if (context_) out += context_(r.position);
+  out += '\n';
+}
+
+void StepLogger::write_out(std::string& buf) {
+  out_->write(buf.data(), static_cast<std::streamsize>(buf.size()));
+  buf.clear();
+}
+
+}  // namespace chat_htm
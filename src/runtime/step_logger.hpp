@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "runtime/spsc_ring.hpp"
+
+namespace chat_htm {
+
+/// One logged step.  Fixed size and trivially copyable so the stepping
+/// thread only stores a few integers; text is formatted by the writer.
+struct StepRecord {
+  std::int64_t step{0};          ///< TextRuntime::timestep() after the step.
+  std::int64_t epoch{0};
+  std::uint64_t position{0};     ///< Input cursor after the step.
+  std::int64_t correct{0};       ///< Cumulative accuracy counters.
+  std::int64_t total{0};
+
+  double accuracy() const { return total > 0 ? static_cast<double>(correct) / total : 0.0; }
+};
+
+/// Buffered, asynchronous per-step log sink (`--log`, `--log-file`).
+///
+/// log() copies a StepRecord into a preallocated SpscRing and returns; a
+/// background thread turns records into text, CSV or binary, batches the
+/// output and writes it in large blocks, flushing only when it runs dry.
+/// When the ring is full log() waits for the writer rather than dropping
+/// records.  Only one thread may call log().
+///
+/// Formats:
+///  - Text:   `[text] step=N  epoch=E  accuracy=A%  | context` (the old --log line)
+///  - Csv:    header `step,epoch,accuracy,position,context`, one row per record
+///  - Binary: 8-byte magic `CHTMLOG\0`, uint32 version, uint32 record size,
+///            then raw StepRecords in host byte order (no context)
+class StepLogger {
+public:
+  enum class Format { Text, Csv, Binary };
+
+  struct Options {
+    Format format = Format::Text;
+    std::string path;            ///< Empty = stdout (text and CSV only).
+    int every = 1;               ///< Log steps where step % every == 0.
+    std::size_t capacity = 4096; ///< Ring slots (rounded up to a power of two).
+  };
+
+  /// Context string for an input position, called on the writer thread.
+  /// Must only read state that is immutable while the logger runs.
+  using ContextFn = std::function<std::string(std::uint64_t position)>;
+
+  /// Throws std::invalid_argument for bad options and std::runtime_error if
+  /// the file cannot be opened.
+  StepLogger(const Options& opts, ContextFn context);
+  /// Drains every queued record, then stops the writer.
+  ~StepLogger();
+
+  StepLogger(const StepLogger&) = delete;
+  StepLogger& operator=(const StepLogger&) = delete;
+
+  /// Parse `text`, `csv` or `binary`.  Throws std::invalid_argument otherwise.
+  static Format parse_format(const std::string& name);
+
+  const Options& options() const { return opts_; }
+  /// True if `step` falls on the sampling interval.
+  bool wants(std::int64_t step) const { return step % opts_.every == 0; }
+
+  /// Queue one record.
+  void log(const StepRecord& r);
+  /// Block until everything queued so far has been written and flushed.
+  void flush();
+
+  /// Records queued / written and flushed so far.
+  std::uint64_t logged() const { return logged_; }
+  std::uint64_t written() const { return written_.load(std::memory_order_acquire); }
+
+private:
+  void writer_loop();
+  void format(const StepRecord& r, std::string& out) const;
+  void write_out(std::string& buf);
+
+  Options opts_;
+  ContextFn context_;
+  std::ofstream file_;
+  std::ostream* out_;
+  SpscRing<StepRecord> ring_;
+  std::uint64_t logged_{0};
+  std::atomic<std::uint64_t> written_{0};
+  std::atomic<bool> stop_{false};
+  std::thread writer_;
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,247 @@
+#include "runtime/sweep.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <yaml-cpp/yaml.h>
+
+#include "text/text_preprocess.hpp"
+
+namespace chat_htm {
+
+namespace {
+
+template <typename T>
+struct LayerField {
+  const char* key;
+  T htm_flow::HTMLayerConfig::*member;
+};
+
+using L = htm_flow::HTMLayerConfig;
+
+const LayerField<int> kIntFields[] = {
+    {"num_column_rows", &L::num_column_rows},
+    {"num_column_cols", &L::num_column_cols},
+    {"pot_width", &L::pot_width},
+    {"pot_height", &L::pot_height},
+    {"min_overlap", &L::min_overlap},
+    {"inhibition_width", &L::inhibition_width},
+    {"inhibition_height", &L::inhibition_height},
+    {"desired_local_activity", &L::desired_local_activity},
+    {"cells_per_column", &L::cells_per_column},
+    {"max_segments_per_cell", &L::max_segments_per_cell},
+    {"max_synapses_per_segment", &L::max_synapses_per_segment},
+    {"activation_threshold", &L::activation_threshold},
+};
+
+const LayerField<float> kFloatFields[] = {
+    {"connected_perm", &L::connected_perm},
+    {"spatial_permanence_inc", &L::spatial_permanence_inc},
+    {"spatial_permanence_dec", &L::spatial_permanence_dec},
+    {"sequence_permanence_inc", &L::sequence_permanence_inc},
+    {"sequence_permanence_dec", &L::sequence_permanence_dec},
+};
+
+const char* const kEncoderKeys[] = {
+    "encoder.active_bits", "encoder.min_value", "encoder.max_value", "encoder.letter_bits",
+    "encoder.trigram_bits",
+};
+
+/// Whether the encoder of `mode` reads encoder key `key`.
+bool encoder_key_applies(const std::string& key, TextMode mode) {
+  switch (mode) {
+    case TextMode::WordRows:
+      return key == "encoder.letter_bits";
+    case TextMode::WordHash:
+      return key == "encoder.active_bits" || key == "encoder.trigram_bits";
+    case TextMode::Character:
+      break;
+  }
+  return key == "encoder.active_bits" || key == "encoder.min_value" || key == "encoder.max_value";
+}
+
+template <typename T, std::size_t N>
+const LayerField<T>* find_field(const LayerField<T> (&fields)[N], const std::string& key) {
+  for (const auto& f : fields) {
+    if (key == f.key) return &f;
+  }
+  return nullptr;
+}
+
+/// Set `key` on every layer; false if it is not a layer field.
+bool set_layer_field(htm_flow::HTMRegionConfig& region, const std::string& key, double v) {
+  if (const auto* f = find_field(kIntFields, key)) {
+    for (auto& layer : region.layers) layer.*(f->member) = static_cast<int>(v);
+    return true;
+  }
+  if (const auto* f = find_field(kFloatFields, key)) {
+    for (auto& layer : region.layers) layer.*(f->member) = static_cast<float>(v);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+SweepGrid SweepGrid::from_yaml(const std::string& path) {
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(path);
+  } catch (const YAML::Exception& e) {
+    throw std::runtime_error("SweepGrid: cannot load " + path + ": " + e.what());
+  }
+  if (!root.IsMap()) {
+    throw std::runtime_error("SweepGrid: " + path + " must be a map of key: [values]");
+  }
+  SweepGrid grid;
+  for (const auto& kv : root) {
+    const auto key = kv.first.as<std::string>();
+    std::vector<double> values;
+    try {
+      if (kv.second.IsSequence()) {
+        for (const auto& v : kv.second) values.push_back(v.as<double>());
+      } else {
+        values.push_back(kv.second.as<double>());
+      }
+    } catch (const YAML::Exception&) {
+      throw std::runtime_error("SweepGrid: " + path + ": values for '" + key + "' must be numbers");
+    }
+    try {
+      grid.add_axis(key, std::move(values));
+    } catch (const std::invalid_argument& e) {
+      throw std::runtime_error(path + ": " + e.what());
+    }
+  }
+  return grid;
+}
+
+void SweepGrid::add_axis(const std::string& key, std::vector<double> values) {
+  if (!is_known_key(key)) {
+    throw std::invalid_argument("SweepGrid: unknown parameter '" + key + "'");
+  }
+  if (values.empty()) {
+    throw std::invalid_argument("SweepGrid: parameter '" + key + "' has no values");
+  }
+  axes_.push_back({key, std::move(values)});
+}
+
+std::size_t SweepGrid::size() const {
+  std::size_t n = 1;
+  for (const auto& a : axes_) n *= a.values.size();
+  return n;
+}
+
+std::vector<double> SweepGrid::combination(std::size_t run) const {
+  std::vector<double> out(axes_.size());
+  for (std::size_t i = axes_.size(); i-- > 0;) {
+    const std::size_t n = axes_[i].values.size();
+    out[i] = axes_[i].values[run % n];
+    run /= n;
+  }
+  return out;
+}
+
+bool SweepGrid::is_known_key(const std::string& key) {
+  if (find_field(kIntFields, key) || find_field(kFloatFields, key)) return true;
+  return std::find(std::begin(kEncoderKeys), std::end(kEncoderKeys), key) != std::end(kEncoderKeys);
+}
+
+void SweepGrid::check_text_mode(TextMode mode) const {
+  for (const auto& a : axes_) {
+    const bool encoder_key =
+        std::find(std::begin(kEncoderKeys), std::end(kEncoderKeys), a.key) != std::end(kEncoderKeys);
+    if (encoder_key && !encoder_key_applies(a.key, mode)) {
+      throw std::invalid_argument("SweepGrid: '" + a.key + "' has no effect in "
+                                  + text_mode_name(mode) + " mode");
+    }
+  }
+}
+
+void SweepGrid::apply(const std::vector<double>& values, htm_flow::HTMRegionConfig& region,
+                      ScalarEncoder::Params& scalar, WordRowEncoder::Params& word,
+                      WordHashEncoder::Params* hash) const {
+  for (std::size_t i = 0; i < axes_.size() && i < values.size(); ++i) {
+    const std::string& key = axes_[i].key;
+    const double v = values[i];
+    if (set_layer_field(region, key, v)) continue;
+    if (key == "encoder.active_bits") {
+      scalar.w = static_cast<int>(v);
+      if (hash) hash->w = static_cast<int>(v);
+    } else if (key == "encoder.min_value") {
+      scalar.min_val = static_cast<int>(v);
+    } else if (key == "encoder.max_value") {
+      scalar.max_val = static_cast<int>(v);
+    } else if (key == "encoder.letter_bits") {
+      word.letter_bits = static_cast<int>(v);
+      word.cols = word.letter_bits * (static_cast<int>(word.alphabet.size()) + 1);
+      if (!region.layers.empty()) region.layers.front().num_input_cols = word.cols;
+    } else if (key == "encoder.trigram_bits") {
+      if (hash) hash->trigram_bits = static_cast<int>(v);
+    }
+  }
+  chain_layer_inputs(region);
+}
+
+std::vector<SweepResult> run_sweep(
+    const SweepGrid& grid, int threads,
+    const std::function<void(const std::vector<double>&, SweepResult&)>& run_one,
+    const std::function<void(const SweepResult&)>& on_done) {
+  const std::size_t runs = grid.size();
+  std::vector<SweepResult> results(runs);
+  std::atomic<std::size_t> next{0};
+  std::mutex done_mutex;
+
+  auto worker = [&] {
+    for (std::size_t run = next.fetch_add(1); run < runs; run = next.fetch_add(1)) {
+      SweepResult& r = results[run];
+      r.run = run;
+      r.values = grid.combination(run);
+      const auto start = std::chrono::steady_clock::now();
+      try {
+        run_one(r.values, r);
+      } catch (const std::exception& e) {
+        r.error = e.what();
+      }
+      r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (on_done) {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        on_done(r);
+      }
+    }
+  };
+
+  const auto n = std::min(runs, static_cast<std::size_t>(preprocess::worker_count(threads)));
+  std::vector<std::thread> pool;
+  pool.reserve(n > 0 ? n - 1 : 0);
+  for (std::size_t i = 1; i < n; ++i) pool.emplace_back(worker);
+  worker();
+  for (auto& t : pool) t.join();
+  return results;
+}
+
+void write_sweep_csv(const std::string& path, const SweepGrid& grid,
+                     const std::vector<SweepResult>& results) {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out.is_open()) {
+    throw std::runtime_error("write_sweep_csv: cannot write " + path);
+  }
+  out << "run";
+  for (const auto& a : grid.axes()) out << ',' << a.key;
+  out << ",steps,accuracy,seconds,steps_per_sec,error\n";
+  for (const auto& r : results) {
+    out << r.run;
+    for (double v : r.values) out << ',' << v;
+    std::string err = r.error;
+    std::replace(err.begin(), err.end(), '"', '\'');
+    out << ',' << r.steps << ',' << r.accuracy << ',' << r.seconds << ',' << r.steps_per_sec()
+        << ",\"" << err << "\"\n";
+  }
+  if (!out) throw std::runtime_error("write_sweep_csv: write failed: " + path);
+}
+
+}  // namespace chat_htm
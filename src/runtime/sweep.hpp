@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <htm_flow/config.hpp>
+
+#include "config/chat_htm_config.hpp"
+#include "encoders/scalar_encoder.hpp"
+#include "encoders/word_hash_encoder.hpp"
+#include "encoders/word_row_encoder.hpp"
+
+namespace chat_htm {
+
+/// One swept parameter and the values it takes.
+struct SweepAxis {
+  std::string key;
+  std::vector<double> values;
+};
+
+/// Cartesian parameter grid for `chat_htm sweep`.
+///
+/// Keys are either htm_flow layer fields, applied to every layer
+/// (`cells_per_column`, `activation_threshold`, `spatial_permanence_inc`,
+/// ...), or encoder settings prefixed with `encoder.` (`encoder.active_bits`,
+/// `encoder.min_value`, `encoder.max_value`, `encoder.letter_bits`,
+/// `encoder.trigram_bits`).  Encoder keys only apply to the encoder of one
+/// text mode; check_text_mode() rejects the others.
+/// Combinations are numbered in row-major order: the last axis varies
+/// fastest.
+class SweepGrid {
+public:
+  /// Load a YAML map of `key: [values...]`.  Throws std::runtime_error on a
+  /// missing file or a malformed grid.
+  static SweepGrid from_yaml(const std::string& path);
+
+  /// Throws std::invalid_argument for an unknown key or an empty value list.
+  void add_axis(const std::string& key, std::vector<double> values);
+
+  const std::vector<SweepAxis>& axes() const { return axes_; }
+  /// Number of combinations (1 for an empty grid: the base config alone).
+  std::size_t size() const;
+  /// Parameter values of combination `run`, one per axis.
+  std::vector<double> combination(std::size_t run) const;
+
+  /// True if `key` names a parameter apply() understands.
+  static bool is_known_key(const std::string& key);
+
+  /// Throw std::invalid_argument if an axis is an encoder key that the
+  /// encoder of `mode` does not read, so a sweep cannot run combinations
+  /// that differ only in an ignored setting.
+  void check_text_mode(TextMode mode) const;
+
+  /// Apply combination values to copies of the base settings.
+  /// `encoder.active_bits` sets both `scalar.w` and, if given, `hash->w`.
+  /// `encoder.letter_bits` also resizes the word rows input to
+  /// `letter_bits * (alphabet + 1)` columns, in `word.cols` and in layer 0's
+  /// `num_input_cols`, which WordRowEncoder requires to match.  Upper
+  /// layers' inputs are then re-sized to the layer below
+  /// (chain_layer_inputs()), so sweeping the column grid or
+  /// `cells_per_column` keeps a multi-layer region consistent.
+  void apply(const std::vector<double>& values, htm_flow::HTMRegionConfig& region,
+             ScalarEncoder::Params& scalar, WordRowEncoder::Params& word,
+             WordHashEncoder::Params* hash = nullptr) const;
+  /// Same, applied to a copy of a whole run config.
+  void apply(const std::vector<double>& values, ChatHtmConfig& cfg) const {
+    apply(values, cfg.region, cfg.scalar, cfg.word_rows, &cfg.word_hash);
+  }
+
+private:
+  std::vector<SweepAxis> axes_;
+};
+
+/// Outcome of one sweep run.
+struct SweepResult {
+  std::size_t run{0};
+  std::vector<double> values;  ///< One per grid axis.
+  std::size_t steps{0};
+  double accuracy{0.0};
+  double seconds{0.0};         ///< Wall time of the run, including region setup.
+  std::string error;           ///< Non-empty if the run threw.
+
+  double steps_per_sec() const { return seconds > 0.0 ? static_cast<double>(steps) / seconds : 0.0; }
+};
+
+/// Run every grid combination on `threads` workers (0 = all cores).
+///
+/// Workers pull the next unclaimed run from a shared counter, so long and
+/// short runs balance across threads.  `run_one(values, result)` builds and
+/// steps one runtime and fills `result.steps` and `result.accuracy`; an
+/// exception is recorded in `result.error` and the sweep continues.
+/// `on_done`, if set, is called (serialized) as each run finishes.
+std::vector<SweepResult> run_sweep(
+    const SweepGrid& grid, int threads,
+    const std::function<void(const std::vector<double>&, SweepResult&)>& run_one,
+    const std::function<void(const SweepResult&)>& on_done = {});
+
+/// Write results as CSV: run, one column per axis, steps, accuracy,
+/// seconds, steps_per_sec, error.  Throws std::runtime_error on I/O failure.
+void write_sweep_csv(const std::string& path, const SweepGrid& grid,
+                     const std::vector<SweepResult>& results);
+
+}  // namespace chat_htm
@@ -0,0 +1,156 @@
+#include "runtime/symbol_classifier.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace chat_htm {
+
+namespace {
+
+template <typename T>
+void put(std::ostream& out, T v) {
+  out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+T get(std::istream& in) {
+  T v{};
+  if (!in.read(reinterpret_cast<char*>(&v), sizeof(v))) {
+    throw std::runtime_error("SymbolClassifier: truncated classifier data");
+  }
+  return v;
+}
+
+}  // namespace
+
+SymbolClassifier::SymbolClassifier(std::size_t num_columns, std::size_t num_symbols)
+    : postings_(num_columns), column_totals_(num_columns, 0), scores_(num_symbols, 0.0f) {}
+
+void SymbolClassifier::learn(SdrView active, std::uint32_t symbol) {
+  if (symbol >= scores_.size()) scores_.resize(static_cast<std::size_t>(symbol) + 1, 0.0f);
+  for (int c : active) {
+    if (c < 0 || static_cast<std::size_t>(c) >= postings_.size()) continue;
+    auto& list = postings_[static_cast<std::size_t>(c)];
+    // A column's postings stay short (the few symbols whose SDRs map to
+    // it), so a linear scan beats any keyed container.
+    auto it = std::find_if(list.begin(), list.end(),
+                           [symbol](const Posting& p) { return p.symbol == symbol; });
+    if (it == list.end()) {
+      list.push_back({symbol, 1});
+    } else {
+      ++it->count;
+    }
+    ++column_totals_[static_cast<std::size_t>(c)];
+    ++observations_;
+  }
+}
+
+void SymbolClassifier::decode(SdrView columns, std::size_t k, std::vector<Prediction>& out) {
+  out.clear();
+  std::size_t used = 0;
+  for (int c : columns) {
+    if (c < 0 || static_cast<std::size_t>(c) >= postings_.size()) continue;
+    const std::uint32_t total = column_totals_[static_cast<std::size_t>(c)];
+    if (total == 0) continue;
+    ++used;
+    const float inv = 1.0f / static_cast<float>(total);
+    for (const Posting& p : postings_[static_cast<std::size_t>(c)]) {
+      if (scores_[p.symbol] == 0.0f) touched_.push_back(p.symbol);
+      scores_[p.symbol] += static_cast<float>(p.count) * inv;
+    }
+  }
+  if (used > 0 && k > 0) {
+    const float norm = 1.0f / static_cast<float>(used);
+    out.reserve(touched_.size());
+    for (std::uint32_t s : touched_) out.push_back({s, scores_[s] * norm});
+    const auto better = [](const Prediction& a, const Prediction& b) {
+      return a.score != b.score ? a.score > b.score : a.symbol < b.symbol;
+    };
+    const std::size_t keep = std::min(k, out.size());
+    std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(keep), out.end(),
+                      better);
+    out.resize(keep);
+  }
+  for (std::uint32_t s : touched_) scores_[s] = 0.0f;
+  touched_.clear();
+}
+
+void SymbolClassifier::merge(const SymbolClassifier& other, const SymbolClassifier* base) {
+  if (other.postings_.size() > postings_.size()) {
+    postings_.resize(other.postings_.size());
+    column_totals_.resize(other.postings_.size(), 0);
+  }
+  if (other.scores_.size() > scores_.size()) scores_.resize(other.scores_.size(), 0.0f);
+  for (std::size_t c = 0; c < other.postings_.size(); ++c) {
+    auto& list = postings_[c];
+    for (const Posting& p : other.postings_[c]) {
+      const std::uint32_t seen = base ? base->count(c, p.symbol) : 0;
+      if (p.count <= seen) continue;
+      const std::uint32_t add = p.count - seen;
+      auto it = std::find_if(list.begin(), list.end(),
+                             [&p](const Posting& q) { return q.symbol == p.symbol; });
+      if (it == list.end()) {
+        list.push_back({p.symbol, add});
+      } else {
+        it->count += add;
+      }
+      column_totals_[c] += add;
+      observations_ += add;
+    }
+  }
+}
+
+std::uint32_t SymbolClassifier::count(std::size_t column, std::uint32_t symbol) const {
+  if (column >= postings_.size()) return 0;
+  for (const Posting& p : postings_[column]) {
+    if (p.symbol == symbol) return p.count;
+  }
+  return 0;
+}
+
+void SymbolClassifier::write(std::ostream& out) const {
+  put<std::uint64_t>(out, postings_.size());
+  put<std::uint64_t>(out, scores_.size());
+  for (const auto& list : postings_) {
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(list.size()));
+    for (const Posting& p : list) {
+      put(out, p.symbol);
+      put(out, p.count);
+    }
+  }
+}
+
+SymbolClassifier SymbolClassifier::read(std::istream& in) {
+  const auto columns = get<std::uint64_t>(in);
+  const auto symbols = get<std::uint64_t>(in);
+  // A layer has far fewer columns and symbols than this; anything larger
+  // is a corrupt stream, not something to allocate for.
+  constexpr std::uint64_t kLimit = std::uint64_t{1} << 32;
+  if (columns >= kLimit || symbols >= kLimit) {
+    throw std::runtime_error("SymbolClassifier: malformed classifier data");
+  }
+  SymbolClassifier c(static_cast<std::size_t>(columns), static_cast<std::size_t>(symbols));
+  for (std::size_t col = 0; col < c.postings_.size(); ++col) {
+    const auto n = get<std::uint32_t>(in);
+    auto& list = c.postings_[col];
+    for (std::uint32_t i = 0; i < n; ++i) {
+      const auto symbol = get<std::uint32_t>(in);
+      const auto count = get<std::uint32_t>(in);
+      if (symbol >= symbols) throw std::runtime_error("SymbolClassifier: symbol out of range");
+      list.push_back({symbol, count});
+      c.column_totals_[col] += count;
+      c.observations_ += count;
+    }
+  }
+  return c;
+}
+
+void SymbolClassifier::clear() {
+  for (auto& list : postings_) list.clear();
+  std::fill(column_totals_.begin(), column_totals_.end(), 0);
+  observations_ = 0;
+}
+
+}  // namespace chat_htm
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "encoders/sdr_table.hpp"
+
+namespace chat_htm {
+
+/// Decodes a set of columns into a ranked list of symbols (byte values or
+/// word ids), e.g. layer 0's predictive columns into the likely next input.
+///
+/// learn() records which columns were active while each symbol was the
+/// input, building an inverted index: per column, the symbols seen with
+/// it and how often.  decode() scores a symbol by summing P(symbol | column)
+/// over the given columns, normalized by the column count, so scores lie
+/// in [0, 1].  Only the postings of those columns are touched, so decoding
+/// cost depends on how many symbols share the columns, not on vocabulary
+/// size.
+class SymbolClassifier {
+public:
+  struct Prediction {
+    std::uint32_t symbol{0};
+    float score{0.0f};
+  };
+
+  SymbolClassifier() = default;
+  /// @param num_symbols Initial symbol capacity; learn() grows it as needed.
+  SymbolClassifier(std::size_t num_columns, std::size_t num_symbols);
+
+  /// Count `symbol` once for every column in `active`.  Out-of-range
+  /// columns are ignored.
+  void learn(SdrView active, std::uint32_t symbol);
+
+  /// Up to `k` highest-scoring symbols for `columns`, best first (ties go
+  /// to the smaller symbol).  `out` is overwritten; its capacity is reused.
+  void decode(SdrView columns, std::size_t k, std::vector<Prediction>& out);
+
+  /// Add `other`'s counts to this classifier, growing it to fit.  With
+  /// `base`, only what `other` learned since it was a copy of `base` is
+  /// added, so replicas that started from the same merged state can be
+  /// folded back without double counting it.
+  void merge(const SymbolClassifier& other, const SymbolClassifier* base = nullptr);
+
+  /// Times `symbol` was learned with `column` (0 if out of range).
+  std::uint32_t count(std::size_t column, std::uint32_t symbol) const;
+
+  /// Binary form of the learned counts (host byte order).  read() throws
+  /// std::runtime_error on a truncated or malformed stream.
+  void write(std::ostream& out) const;
+  static SymbolClassifier read(std::istream& in);
+
+  std::size_t num_columns() const { return postings_.size(); }
+  std::size_t num_symbols() const { return scores_.size(); }
+  /// Total learn() column observations.
+  std::uint64_t observations() const { return observations_; }
+  void clear();
+
+private:
+  struct Posting {
+    std::uint32_t symbol;
+    std::uint32_t count;
+  };
+
+  std::vector<std::vector<Posting>> postings_;  ///< Per column, unordered.
+  std::vector<std::uint32_t> column_totals_;
+  std::uint64_t observations_{0};
+
+  // decode() scratch: dense scores plus the symbols actually touched.
+  std::vector<float> scores_;
+  std::vector<std::uint32_t> touched_;
+};
+
+}  // namespace chat_htm
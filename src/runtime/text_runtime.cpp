@@ -1,12 +1,95 @@
 #include "runtime/text_runtime.hpp"
 
 #include <algorithm>
-#include <iomanip>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 
 namespace chat_htm {
 
+namespace {
+
+/// Unchanged since these files were called checkpoints, so older files
+/// still load.
+constexpr char kProgressMagic[8] = {'C', 'H', 'T', 'M', 'C', 'K', 'P', '\0'};
+/// Version 2 appends the classifier section; version 1 files (no
+/// classifier) still load.
+constexpr std::uint32_t kProgressVersion = 2;
+
+struct ProgressFile {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t size;  ///< sizeof(TextRuntime::ProgressRecord) when written.
+  TextRuntime::ProgressRecord state;
+  // Version 2: std::uint32_t has_classifier, then SymbolClassifier::write().
+};
+
+/// Open `path` and read its fixed block, leaving `in` at the classifier
+/// section.  Throws std::runtime_error on a bad or incompatible file.
+ProgressFile open_progress(const std::string& path, std::ifstream& in) {
+  in.open(path, std::ios::binary);
+  if (!in.is_open()) {
+    throw std::runtime_error("TextRuntime: cannot open progress file: " + path);
+  }
+  ProgressFile file{};
+  in.read(reinterpret_cast<char*>(&file), sizeof(file));
+  if (!in || std::memcmp(file.magic, kProgressMagic, sizeof(kProgressMagic)) != 0) {
+    throw std::runtime_error("TextRuntime: not a progress file: " + path);
+  }
+  if (file.version < 1 || file.version > kProgressVersion
+      || file.size != sizeof(TextRuntime::ProgressRecord)) {
+    throw std::runtime_error("TextRuntime: progress file " + path
+                             + " was written by an incompatible build");
+  }
+  return file;
+}
+
+/// The classifier section of an open progress file, if it has one.
+bool read_progress_classifier(const ProgressFile& file, std::ifstream& in,
+                                const std::string& path, SymbolClassifier& out) {
+  if (file.version < 2) return false;
+  std::uint32_t has_classifier = 0;
+  in.read(reinterpret_cast<char*>(&has_classifier), sizeof(has_classifier));
+  if (!in) throw std::runtime_error("TextRuntime: truncated progress file: " + path);
+  if (!has_classifier) return false;
+  try {
+    out = SymbolClassifier::read(in);
+  } catch (const std::runtime_error& e) {
+    throw std::runtime_error("TextRuntime: progress file " + path + ": " + e.what());
+  }
+  return true;
+}
+
+}  // namespace
+
+void freeze_permanences(htm_flow::HTMRegionConfig& cfg) {
+  for (auto& layer : cfg.layers) {
+    layer.spatial_permanence_inc = 0.0f;
+    layer.spatial_permanence_dec = 0.0f;
+    layer.active_col_permanence_dec = 0.0f;
+    layer.sequence_permanence_inc = 0.0f;
+    layer.sequence_permanence_dec = 0.0f;
+    layer.temp_spatial_permanence_inc = 0.0f;
+    layer.temp_sequence_permanence_inc = 0.0f;
+    layer.temp_sequence_permanence_dec = 0.0f;
+  }
+}
+
+bool permanences_frozen(const htm_flow::HTMRegionConfig& cfg) {
+  return std::all_of(cfg.layers.begin(), cfg.layers.end(), [](const htm_flow::HTMLayerConfig& l) {
+    return l.spatial_permanence_inc == 0.0f && l.spatial_permanence_dec == 0.0f
+           && l.active_col_permanence_dec == 0.0f && l.sequence_permanence_inc == 0.0f
+           && l.sequence_permanence_dec == 0.0f && l.temp_spatial_permanence_inc == 0.0f
+           && l.temp_sequence_permanence_inc == 0.0f && l.temp_sequence_permanence_dec == 0.0f;
+  });
+}
+
 TextRuntime::TextRuntime(const htm_flow::HTMRegionConfig& cfg,
                          std::unique_ptr<TextChunker> chunker,
                          const ScalarEncoder& encoder,
@@ -15,11 +98,40 @@ TextRuntime::TextRuntime(const htm_flow::HTMRegionConfig& cfg,
       chunker_(std::move(chunker)),
       encoder_(encoder),
       word_encoder_(WordRowEncoder::Params{}),
+      word_hash_encoder_(WordHashEncoder::Params{}),
       input_mode_(InputMode::Character),
-      name_(name) {
+      name_(name),
+      permanences_frozen_(chat_htm::permanences_frozen(cfg)) {
   if (!chunker_) {
     throw std::invalid_argument("TextRuntime: chunker must not be null");
   }
+  input_bits_.assign(static_cast<std::size_t>(encoder_.total_bits()), 0);
+}
+
+TextRuntime::TextRuntime(const htm_flow::HTMRegionConfig& cfg,
+                         std::unique_ptr<MappedTextChunker> chunker,
+                         const ScalarEncoder& encoder,
+                         const std::string& name)
+    : region_(std::make_unique<htm_flow::HTMRegion>(cfg, name)),
+      mapped_chunker_(std::move(chunker)),
+      encoder_(encoder),
+      word_encoder_(WordRowEncoder::Params{}),
+      word_hash_encoder_(WordHashEncoder::Params{}),
+      input_mode_(InputMode::Character),
+      name_(name),
+      permanences_frozen_(chat_htm::permanences_frozen(cfg)) {
+  if (!mapped_chunker_) {
+    throw std::invalid_argument("TextRuntime: chunker must not be null");
+  }
+  input_bits_.assign(static_cast<std::size_t>(encoder_.total_bits()), 0);
+}
+
+TextRuntime::TextRuntime(const htm_flow::HTMRegionConfig& cfg,
+                         std::unique_ptr<ShardedCorpus> corpus,
+                         const ScalarEncoder& encoder,
+                         const std::string& name)
+    : TextRuntime(cfg, corpus ? corpus->next_shard() : nullptr, encoder, name) {
+  shards_ = std::move(corpus);
 }
 
 TextRuntime::TextRuntime(const htm_flow::HTMRegionConfig& cfg,
@@ -30,11 +142,44 @@ TextRuntime::TextRuntime(const htm_flow::HTMRegionConfig& cfg,
       word_chunker_(std::move(chunker)),
       encoder_(ScalarEncoder::Params{}),
       word_encoder_(encoder),
+      word_hash_encoder_(WordHashEncoder::Params{}),
       input_mode_(InputMode::WordRows),
-      name_(name) {
+      name_(name),
+      permanences_frozen_(chat_htm::permanences_frozen(cfg)) {
+  if (!word_chunker_) {
+    throw std::invalid_argument("TextRuntime: word chunker must not be null");
+  }
+  input_bits_.assign(static_cast<std::size_t>(word_encoder_.total_bits()), 0);
+  if (word_encoder_.params().cache) {
+    word_encoder_.cache_vocabulary(word_chunker_->vocabulary());
+  }
+}
+
+TextRuntime::TextRuntime(const htm_flow::HTMRegionConfig& cfg,
+                         std::unique_ptr<WordChunker> chunker,
+                         const WordHashEncoder& encoder,
+                         const std::string& name)
+    : region_(std::make_unique<htm_flow::HTMRegion>(cfg, name)),
+      word_chunker_(std::move(chunker)),
+      encoder_(ScalarEncoder::Params{}),
+      word_encoder_(WordRowEncoder::Params{}),
+      word_hash_encoder_(encoder),
+      input_mode_(InputMode::WordHash),
+      name_(name),
+      permanences_frozen_(chat_htm::permanences_frozen(cfg)) {
   if (!word_chunker_) {
     throw std::invalid_argument("TextRuntime: word chunker must not be null");
   }
+  input_bits_.assign(static_cast<std::size_t>(word_hash_encoder_.total_bits()), 0);
+  if (word_hash_encoder_.params().cache) {
+    word_hash_encoder_.cache_vocabulary(word_chunker_->vocabulary());
+  }
+}
+
+TextRuntime::~TextRuntime() {
+  step_logger_.reset();
+  stop_prefetch();
+  pipeline_.reset();
 }
 
 htm_gui::Snapshot TextRuntime::snapshot() const {
@@ -46,57 +191,264 @@ htm_gui::Snapshot TextRuntime::snapshot() const {
 
 void TextRuntime::step(int n) {
   if (!region_ || n <= 0) return;
-  if (input_mode_ == InputMode::Character && !chunker_) return;
-  if (input_mode_ == InputMode::WordRows && !word_chunker_) return;
+  if (input_mode_ == InputMode::Character && !chunker_ && !mapped_chunker_) return;
+  if (input_mode_ != InputMode::Character && !word_chunker_) return;
 
   for (int i = 0; i < n; ++i) {
-    if (total_predictions_ > 0 || region_->timestep() > 0) {
-      const auto& layer0 = region_->layer(0);
-      auto snap = layer0.snapshot();
-      if (!snap.column_cell_masks.empty()) {
-        int predicted_and_active = 0;
-        int total_active = 0;
-        for (int idx : snap.active_column_indices) {
-          if (idx >= 0 && idx < static_cast<int>(snap.column_cell_masks.size())) {
-            ++total_active;
-            if (snap.column_cell_masks[static_cast<std::size_t>(idx)].predictive != 0) {
-              ++predicted_and_active;
-            }
-          }
+    if (std::exchange(skip_next_sample_, false)) {
+      // Nothing to measure: the previous step fed the empty reset input.
+    } else if (should_sample_accuracy()) {
+      PredictionMetrics m;
+      bool measured = has_pending_metrics_;
+      if (measured) {
+        m = pending_metrics_;
+      } else {
+        StageTimers::ScopedTimer t(timers_, StageTimers::kAccuracy);
+        measured = measure_prediction(m);
+      }
+      if (measured) {
+        record_prediction(m);
+      }
+    }
+    has_pending_metrics_ = false;
+
+    const int epoch = input_epoch();
+    std::uint32_t fed;
+
+    if (prefetch_ring_) {
+      PrefetchSlot* slot;
+      {
+        StageTimers::ScopedTimer t(timers_, StageTimers::kPrefetchWait);
+        slot = prefetch_ring_->read_slot();
+        while (!slot) {
+          std::this_thread::yield();
+          slot = prefetch_ring_->read_slot();
         }
-        if (total_active > 0 && predicted_and_active > total_active / 2) {
-          ++correct_predictions_;
+      }
+      // The producer reads ahead through at()/token(); advance the real
+      // cursor here so position, epoch and context reflect consumed input.
+      if (input_mode_ == InputMode::Character) {
+        next_char();
+        last_char_ = static_cast<char>(slot->symbol);
+      } else {
+        word_chunker_->next_id();
+        last_word_ = word_chunker_->word(slot->symbol);
+      }
+      fed = slot->symbol;
+      {
+        StageTimers::ScopedTimer t(timers_, StageTimers::kSetInput);
+        set_input_indices(slot->active);
+      }
+      prefetch_ring_->release();
+    } else {
+      std::uint32_t symbol;
+      {
+        StageTimers::ScopedTimer t(timers_, StageTimers::kRead);
+        if (input_mode_ == InputMode::Character) {
+          symbol = static_cast<std::uint32_t>(next_char());
+          last_char_ = static_cast<char>(symbol);
+        } else {
+          symbol = word_chunker_->next_id();
+          last_word_ = word_chunker_->word(symbol);
         }
-        ++total_predictions_;
       }
+      fed = symbol;
+      SdrView active;
+      {
+        StageTimers::ScopedTimer t(timers_, StageTimers::kEncode);
+        active = lookup_or_encode(symbol, next_active_);
+      }
+      StageTimers::ScopedTimer t(timers_, StageTimers::kSetInput);
+      set_input_indices(active);
     }
 
-    std::vector<int> sdr;
-    if (input_mode_ == InputMode::Character) {
-      if (!chunker_) return;
-      int char_val = chunker_->next();
-      last_char_ = static_cast<char>(char_val);
-      sdr = encoder_.encode(char_val);
-    } else {
-      if (!word_chunker_) return;
-      last_word_ = word_chunker_->next();
-      sdr = word_encoder_.encode(last_word_);
+    last_symbol_ = fed;
+    last_epoch_ = epoch;
+
+    {
+      StageTimers::ScopedTimer t(timers_, StageTimers::kRegionStep);
+      step_region();
+    }
+
+    if (classifier_top_k_ > 0) {
+      StageTimers::ScopedTimer t(timers_, StageTimers::kClassify);
+      if (!predictions_.empty()) {
+        ++classifier_total_;
+        if (predictions_.front().symbol == fed) ++classifier_hits_;
+      }
+      classify_step(fed);
+    }
+
+    // Log text context after each sampled step if enabled.
+    if (step_logger_) {
+      const std::int64_t t = timestep();
+      if (step_logger_->wants(t)) {
+        StepRecord r;
+        r.step = t;
+        r.epoch = input_epoch();
+        r.position = input_position();
+        r.correct = correct_predictions_;
+        r.total = total_predictions_;
+        step_logger_->log(r);
+      }
+    }
+
+    if (shards_ && chunker_->position() == 0) advance_shard();
+  }
+}
+
+void TextRuntime::advance_shard() {
+  // The log writer reads context from the current shard; drain it first.
+  flush_log();
+  // The producer has read past the boundary into a wrap of this shard.
+  stop_prefetch();
+  auto next = shards_->next_shard();
+  next->seek(0, shards_->epoch(), chunker_->total_steps());
+  chunker_ = std::move(next);
+  ++shard_switches_;
+
+  if (shard_reset_) {
+    set_input_indices(SdrView{});
+    StageTimers::ScopedTimer t(timers_, StageTimers::kRegionStep);
+    step_region();
+    skip_next_sample_ = true;
+    has_pending_metrics_ = false;
+    predictions_.clear();
+  }
+  if (prefetch_depth_ > 0) start_prefetch();
+}
+
+void TextRuntime::set_symbol_table(SdrTable table) {
+  const std::size_t required =
+      (input_mode_ == InputMode::Character) ? 256 : (word_chunker_ ? word_chunker_->vocabulary_size() : 0);
+  if (table.size() < required) {
+    throw std::invalid_argument("TextRuntime: symbol table has " + std::to_string(table.size())
+                                + " rows, need " + std::to_string(required));
+  }
+  for (int idx : table.indices()) {
+    if (idx < 0 || static_cast<std::size_t>(idx) >= input_bits_.size()) {
+      throw std::invalid_argument("TextRuntime: symbol table index out of range for layer 0 input");
     }
-    region_->set_input(sdr);
+  }
+  stop_prefetch();
+  symbol_table_ = std::move(table);
+  if (prefetch_depth_ > 0) start_prefetch();
+}
+
+void TextRuntime::set_log_text(bool enabled) {
+  if (enabled) {
+    if (!step_logger_) set_step_log({});
+  } else {
+    step_logger_.reset();
+  }
+}
+
+void TextRuntime::set_step_log(const StepLogger::Options& opts) {
+  step_logger_.reset();  // Drain the old log before opening the new one.
+  step_logger_ = std::make_unique<StepLogger>(
+      opts, [this](std::uint64_t pos) { return input_context_at(static_cast<std::size_t>(pos)); });
+}
+
+void TextRuntime::flush_log() {
+  if (step_logger_) step_logger_->flush();
+}
+
+void TextRuntime::set_layer_pipeline(bool enabled) {
+  if (enabled == layer_pipeline()) return;
+  if (enabled) {
+    pipeline_ = std::make_unique<LayerPipeline>(*region_);
+  } else {
+    pipeline_.reset();
+  }
+}
+
+void TextRuntime::step_region() {
+  if (pipeline_) {
+    pipeline_->tick();
+  } else {
     region_->step(1);
+  }
+  ++timestep_;
+}
 
-    // Log text context after each step if enabled.
-    if (log_text_) {
-      std::cout << "[text] step=" << region_->timestep()
-                << "  epoch=" << input_epoch()
-                << "  accuracy=" << std::fixed << std::setprecision(1)
-                << (prediction_accuracy() * 100.0) << "%"
-                << "  | " << input_context()
-                << std::endl;
+void TextRuntime::set_prefetch(int depth) {
+  stop_prefetch();
+  prefetch_depth_ = std::max(0, depth);
+  if (prefetch_depth_ > 0) start_prefetch();
+}
+
+void TextRuntime::start_prefetch() {
+  prefetch_ring_ = std::make_unique<SpscRing<PrefetchSlot>>(static_cast<std::size_t>(prefetch_depth_));
+  prefetch_stop_.store(false);
+  prefetch_thread_ = std::thread(&TextRuntime::prefetch_loop, this, input_position());
+}
+
+void TextRuntime::stop_prefetch() {
+  if (prefetch_thread_.joinable()) {
+    prefetch_stop_.store(true);
+    prefetch_thread_.join();
+  }
+  prefetch_ring_.reset();
+}
+
+void TextRuntime::prefetch_loop(std::size_t start) {
+  const std::size_t size = input_size();
+  std::size_t idx = start;
+  int idle = 0;
+  while (!prefetch_stop_.load(std::memory_order_relaxed)) {
+    PrefetchSlot* slot = prefetch_ring_->write_slot();
+    if (!slot) {
+      // Full: the region is the bottleneck.  Back off to a short sleep so a
+      // waiting producer does not compete with htm_flow for a core.
+      if (++idle < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+      continue;
     }
+    idle = 0;
+    slot->symbol = symbol_at(idx);
+    const SdrView active = lookup_or_encode(slot->symbol, slot->active);
+    if (active.data != slot->active.data()) slot->active.assign(active.begin(), active.end());
+    prefetch_ring_->publish();
+    idx = (idx + 1) % size;
   }
 }
 
+std::uint32_t TextRuntime::symbol_at(std::size_t idx) const {
+  if (input_mode_ != InputMode::Character) return word_chunker_->token(idx);
+  return static_cast<std::uint32_t>(mapped_chunker_ ? mapped_chunker_->at(idx) : chunker_->at(idx));
+}
+
+SdrView TextRuntime::lookup_or_encode(std::uint32_t symbol, std::vector<int>& scratch) const {
+  if (!symbol_table_.empty()) return symbol_table_[symbol];
+  if (input_mode_ == InputMode::Character) {
+    if (encoder_.cached()) return encoder_.active_indices(static_cast<int>(symbol));
+    encoder_.encode_indices(static_cast<int>(symbol), scratch);
+    return scratch;
+  }
+  if (input_mode_ == InputMode::WordHash) {
+    if (word_hash_encoder_.has_word_cache()) return word_hash_encoder_.cached_indices(symbol);
+    word_hash_encoder_.encode_indices(word_chunker_->word(symbol), scratch);
+    return scratch;
+  }
+  if (word_encoder_.has_word_cache()) return word_encoder_.cached_indices(symbol);
+  word_encoder_.encode_indices(word_chunker_->word(symbol), scratch);
+  return scratch;
+}
+
+void TextRuntime::set_input_indices(SdrView active) {
+  for (int idx : input_active_) {
+    input_bits_[static_cast<std::size_t>(idx)] = 0;
+  }
+  for (int idx : active) {
+    input_bits_[static_cast<std::size_t>(idx)] = 1;
+  }
+  input_active_.assign(active.begin(), active.end());
+  region_->set_input(input_bits_);
+}
+
 htm_gui::ProximalSynapseQuery TextRuntime::query_proximal(int column_x, int column_y) const {
   if (!region_ || active_layer_idx_ < 0 || active_layer_idx_ >= num_layers()) {
     return {};
@@ -119,10 +471,59 @@ htm_gui::DistalSynapseQuery TextRuntime::query_distal(int column_x, int column_y
   return region_->layer(active_layer_idx_).query_distal(column_x, column_y, cell, segment);
 }
 
+const SnapshotDelta& TextRuntime::snapshot_delta(std::uint64_t since) const {
+  const std::uint64_t version = snapshot_version();
+  if (snapshot_tracker_.current(since, active_layer_idx_, version)) {
+    return snapshot_tracker_.unchanged();
+  }
+  return snapshot_tracker_.update(snapshot(), since, active_layer_idx_, version);
+}
+
+TextRuntime::DistalPage TextRuntime::query_distal_page(int column_x, int column_y, int cell,
+                                                       int first, int count) const {
+  DistalPage page;
+  page.total_segments = num_segments(column_x, column_y, cell);
+  if (first < 0) first = 0;
+  const int last = std::min(page.total_segments, first + std::max(0, count));
+  if (first >= last) return page;
+
+  const std::uint64_t version = snapshot_version();
+  if (distal_cache_version_ != version || distal_cache_layer_ != active_layer_idx_) {
+    distal_cache_.clear();
+    distal_cache_version_ = version;
+    distal_cache_layer_ = active_layer_idx_;
+  }
+  // 16 bits per coordinate, 12 for the cell, 20 for the segment; anything
+  // larger is queried every time.
+  const bool packable = column_x >= 0 && column_x < (1 << 16) && column_y >= 0
+                        && column_y < (1 << 16) && cell >= 0 && cell < (1 << 12)
+                        && last <= (1 << 20);
+  page.segments.reserve(static_cast<std::size_t>(last - first));
+  for (int seg = first; seg < last; ++seg) {
+    if (!packable) {
+      page.segments.push_back(query_distal(column_x, column_y, cell, seg));
+      continue;
+    }
+    const std::uint64_t key = (static_cast<std::uint64_t>(column_x) << 48)
+                              | (static_cast<std::uint64_t>(column_y) << 32)
+                              | (static_cast<std::uint64_t>(cell) << 20)
+                              | static_cast<std::uint64_t>(seg);
+    auto it = distal_cache_.find(key);
+    if (it == distal_cache_.end()) {
+      it = distal_cache_.emplace(key, query_distal(column_x, column_y, cell, seg)).first;
+    }
+    page.segments.push_back(it->second);
+  }
+  return page;
+}
+
 std::vector<htm_gui::InputSequence> TextRuntime::input_sequences() const {
   if (input_mode_ == InputMode::Character && chunker_) {
     return {{0, "Text: " + chunker_->path()}};
   }
+  if (input_mode_ == InputMode::Character && mapped_chunker_) {
+    return {{0, "Text: " + mapped_chunker_->path()}};
+  }
   if (word_chunker_) {
     return {{0, "Text: " + word_chunker_->path()}};
   }
@@ -161,32 +562,259 @@ void TextRuntime::set_active_layer(int idx) {
   }
 }
 
+bool TextRuntime::should_sample_accuracy() const {
+  if (accuracy_interval_ <= 0) return false;
+  const std::int64_t t = timestep_;
+  if (t <= 0) return false;
+  return accuracy_interval_ == 1 || t % accuracy_interval_ == 0;
+}
+
+bool TextRuntime::measure_prediction(PredictionMetrics& out) const {
+  // The snapshot is the only view htm_flow gives us of per-cell predictive
+  // state; keep it confined to this function so sampling controls its cost.
+  const auto snap = region_->layer(0).snapshot();
+  if (snap.column_cell_masks.empty()) return false;
+  metrics_from(snap, out);
+  return true;
+}
+
+void TextRuntime::metrics_from(const htm_gui::Snapshot& snap, PredictionMetrics& out) const {
+  // O(active columns): only the masks of active columns are read, so a
+  // sample costs a few dozen loads however wide the layer is.
+  out = PredictionMetrics{};
+  const int num_columns = static_cast<int>(snap.column_cell_masks.size());
+  for (int idx : snap.active_column_indices) {
+    if (idx < 0 || idx >= num_columns) continue;
+    ++out.active_columns;
+    if (snap.column_cell_masks[static_cast<std::size_t>(idx)].predictive != 0) {
+      ++out.predicted_active_columns;
+    }
+  }
+}
+
+void TextRuntime::set_classifier(int top_k) {
+  classifier_top_k_ = top_k < 0 ? 0 : top_k;
+  predictions_.clear();
+  has_pending_metrics_ = false;
+}
+
+void TextRuntime::classify_step(std::uint32_t symbol) {
+  const auto snap = region_->layer(0).snapshot();
+  const std::size_t num_columns = snap.column_cell_masks.size();
+  if (num_columns == 0) {
+    predictions_.clear();
+    return;
+  }
+  if (classifier_.num_columns() != num_columns) {
+    const std::size_t symbols =
+        input_mode_ == InputMode::Character ? 256 : word_chunker_->vocabulary_size();
+    classifier_ = SymbolClassifier(num_columns, symbols);
+  }
+  if (classifier_learning_) classifier_.learn(snap.active_column_indices, symbol);
+  decode_predictions(snap);
+  metrics_from(snap, pending_metrics_);
+  has_pending_metrics_ = true;
+}
+
+const Sdr& TextRuntime::pack_predictive(const htm_gui::Snapshot& snap) const {
+  const std::size_t num_columns = snap.column_cell_masks.size();
+  if (predictive_bits_.size() != num_columns) predictive_bits_ = Sdr(num_columns);
+  column_kernels::pack_predictive(snap.column_cell_masks.data(), num_columns,
+                                  predictive_bits_.words());
+  return predictive_bits_;
+}
+
+void TextRuntime::decode_predictions(const htm_gui::Snapshot& snap) {
+  pack_predictive(snap).indices(predictive_columns_);
+  classifier_.decode(predictive_columns_, static_cast<std::size_t>(classifier_top_k_), predictions_);
+}
+
+void TextRuntime::feed(std::uint32_t symbol) {
+  if (!region_) return;
+  if (input_mode_ == InputMode::Character) {
+    if (symbol > 255) throw std::invalid_argument("TextRuntime::feed: character symbol out of range");
+    last_char_ = static_cast<char>(symbol);
+  } else {
+    if (!word_chunker_ || symbol >= word_chunker_->vocabulary_size()) {
+      throw std::invalid_argument("TextRuntime::feed: word id outside the vocabulary");
+    }
+    last_word_ = word_chunker_->word(symbol);
+  }
+  last_symbol_ = symbol;
+  last_epoch_ = input_epoch();
+  set_input_indices(lookup_or_encode(symbol, next_active_));
+  step_region();
+  // The region moved on without the accuracy metric seeing it.
+  has_pending_metrics_ = false;
+  if (classifier_top_k_ <= 0) return;
+
+  const auto snap = region_->layer(0).snapshot();
+  if (snap.column_cell_masks.size() != classifier_.num_columns()) {
+    predictions_.clear();  // Never trained on this region.
+    return;
+  }
+  decode_predictions(snap);
+}
+
+std::vector<std::uint32_t> TextRuntime::text_symbols(std::string_view text) const {
+  std::vector<std::uint32_t> out;
+  if (input_mode_ == InputMode::Character) {
+    out.reserve(text.size());
+    for (char c : text) out.push_back(static_cast<unsigned char>(c));
+    return out;
+  }
+  if (!word_chunker_) return out;
+  // Same rule as WordChunker: maximal runs of letters, lowercased.
+  std::unordered_map<std::string_view, std::uint32_t> ids;
+  ids.reserve(word_chunker_->vocabulary_size());
+  for (std::size_t id = 0; id < word_chunker_->vocabulary_size(); ++id) {
+    ids.emplace(word_chunker_->word(static_cast<std::uint32_t>(id)), static_cast<std::uint32_t>(id));
+  }
+  std::string current;
+  auto flush = [&] {
+    if (current.empty()) return;
+    auto it = ids.find(current);
+    if (it != ids.end()) out.push_back(it->second);
+    current.clear();
+  };
+  for (char c : text) {
+    const auto uc = static_cast<unsigned char>(c);
+    if (std::isalpha(uc)) {
+      current.push_back(static_cast<char>(std::tolower(uc)));
+    } else {
+      flush();
+    }
+  }
+  flush();
+  return out;
+}
+
+double TextRuntime::classifier_accuracy() const {
+  if (classifier_total_ == 0) return 0.0;
+  return static_cast<double>(classifier_hits_) / classifier_total_;
+}
+
+std::string TextRuntime::symbol_text(std::uint32_t symbol) const {
+  if (input_mode_ == InputMode::Character) return std::string(1, printable(static_cast<char>(symbol)));
+  if (word_chunker_ && symbol < word_chunker_->vocabulary_size()) {
+    return std::string(word_chunker_->word(symbol));
+  }
+  return {};
+}
+
+void TextRuntime::record_prediction(const PredictionMetrics& m) {
+  last_metrics_ = m;
+  const bool correct = m.active_columns > 0 && m.predicted_active_columns > m.active_columns / 2;
+  if (correct) ++correct_predictions_;
+  ++total_predictions_;
+  accuracy_tracker_.record(correct, last_epoch_, last_symbol_);
+}
+
 double TextRuntime::prediction_accuracy() const {
   if (total_predictions_ == 0) return 0.0;
   return static_cast<double>(correct_predictions_) / total_predictions_;
 }
 
+TextRuntime::ProgressRecord TextRuntime::progress() const {
+  ProgressRecord c;
+  c.mode = static_cast<std::uint32_t>(input_mode_);
+  c.input_size = input_size();
+  c.epoch = input_epoch();
+  c.total_steps = input_total_steps();
+  c.position = input_position();
+  c.region_timestep = timestep();
+  c.correct_predictions = correct_predictions_;
+  c.total_predictions = total_predictions_;
+  c.last_metrics = last_metrics_;
+  return c;
+}
+
+void TextRuntime::save_progress(const std::string& path) const {
+  ProgressFile file{};
+  std::memcpy(file.magic, kProgressMagic, sizeof(kProgressMagic));
+  file.version = kProgressVersion;
+  file.size = sizeof(ProgressRecord);
+  file.state = progress();
+
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      throw std::runtime_error("TextRuntime: cannot write progress file: " + tmp);
+    }
+    out.write(reinterpret_cast<const char*>(&file), sizeof(file));
+    const std::uint32_t has_classifier = classifier_.num_columns() > 0 ? 1 : 0;
+    out.write(reinterpret_cast<const char*>(&has_classifier), sizeof(has_classifier));
+    if (has_classifier) classifier_.write(out);
+    out.flush();
+    if (!out) throw std::runtime_error("TextRuntime: progress file write failed: " + tmp);
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("TextRuntime: cannot rename progress file into place: " + path);
+  }
+}
+
+bool TextRuntime::load_classifier(const std::string& path) {
+  std::ifstream in;
+  const ProgressFile file = open_progress(path, in);
+  SymbolClassifier classifier;
+  if (!read_progress_classifier(file, in, path, classifier)) return false;
+  replace_classifier(std::move(classifier));
+  return true;
+}
+
+void TextRuntime::replace_classifier(SymbolClassifier classifier) {
+  // Only the snapshot reports layer 0's column count.
+  const std::size_t columns = region_->layer(0).snapshot().column_cell_masks.size();
+  if (classifier.num_columns() != 0 && columns != 0 && classifier.num_columns() != columns) {
+    throw std::invalid_argument("TextRuntime: classifier has "
+                                + std::to_string(classifier.num_columns())
+                                + " columns, layer 0 has " + std::to_string(columns));
+  }
+  classifier_ = std::move(classifier);
+  predictions_.clear();
+  has_pending_metrics_ = false;
+}
+
+std::size_t TextRuntime::input_position() const {
+  if (input_mode_ == InputMode::Character && chunker_) return chunker_->position();
+  if (input_mode_ == InputMode::Character && mapped_chunker_) return mapped_chunker_->position();
+  if (word_chunker_) return word_chunker_->position();
+  return 0;
+}
+
 std::size_t TextRuntime::input_size() const {
   if (input_mode_ == InputMode::Character && chunker_) return chunker_->size();
+  if (input_mode_ == InputMode::Character && mapped_chunker_) return mapped_chunker_->size();
   if (word_chunker_) return word_chunker_->size();
   return 0;
 }
 
 int TextRuntime::input_epoch() const {
   if (input_mode_ == InputMode::Character && chunker_) return chunker_->epoch();
+  if (input_mode_ == InputMode::Character && mapped_chunker_) return mapped_chunker_->epoch();
   if (word_chunker_) return word_chunker_->epoch();
   return 0;
 }
 
 std::size_t TextRuntime::input_total_steps() const {
   if (input_mode_ == InputMode::Character && chunker_) return chunker_->total_steps();
+  if (input_mode_ == InputMode::Character && mapped_chunker_) return mapped_chunker_->total_steps();
   if (word_chunker_) return word_chunker_->total_steps();
   return 0;
 }
 
 std::string TextRuntime::input_context() const {
-  if (input_mode_ == InputMode::Character && chunker_) return text_context();
-  if (word_chunker_) return word_context();
+  return input_context_at(input_position());
+}
+
+std::string TextRuntime::input_context_at(std::size_t pos) const {
+  if (input_mode_ == InputMode::Character) {
+    if (mapped_chunker_) return text_context(*mapped_chunker_, pos);
+    if (chunker_) return text_context(*chunker_, pos);
+    return {};
+  }
+  if (word_chunker_) return word_context(pos);
   return {};
 }
 
@@ -196,18 +824,24 @@ char TextRuntime::printable(char c) {
   return c;
 }
 
-std::string TextRuntime::text_context() const {
-  if (!chunker_ || chunker_->text().empty()) return {};
-  const auto& text = chunker_->text();
-  auto pos = chunker_->position();
-  // position() is already advanced past the char we just read,
+int TextRuntime::next_char() {
+  return mapped_chunker_ ? mapped_chunker_->next() : chunker_->next();
+}
+
+template <typename Chunker>
+std::string TextRuntime::text_context(const Chunker& chunker, std::size_t pos) {
+  const std::size_t size = chunker.size();
+  if (size == 0) return {};
+  // `pos` is the cursor, already advanced past the char we just read,
   // so the char we just fed is at pos-1 (wrapping).
-  std::size_t cur = (pos == 0) ? text.size() - 1 : pos - 1;
+  std::size_t cur = (pos == 0) ? size - 1 : pos - 1;
   const int ctx = 10;  // chars of context each side
   std::string result;
   for (int j = -ctx; j <= ctx; ++j) {
-    std::size_t idx = (cur + text.size() + static_cast<std::size_t>(j)) % text.size();
-    char c = printable(text[idx]);
+    // Only the window around the cursor is read, so mapped files are never
+    // touched beyond these few bytes.
+    std::size_t idx = (cur + size * ctx + static_cast<std::size_t>(j)) % size;
+    char c = printable(static_cast<char>(chunker.at(idx)));
     if (j == 0) {
       result += '[';
       result += c;
@@ -219,16 +853,15 @@ std::string TextRuntime::text_context() const {
   return result;
 }
 
-std::string TextRuntime::word_context() const {
-  if (!word_chunker_ || word_chunker_->words().empty()) return {};
-  const auto& words = word_chunker_->words();
-  auto pos = word_chunker_->position();
-  std::size_t cur = (pos == 0) ? words.size() - 1 : pos - 1;
+std::string TextRuntime::word_context(std::size_t pos) const {
+  if (!word_chunker_ || word_chunker_->size() == 0) return {};
+  const std::size_t size = word_chunker_->size();
+  std::size_t cur = (pos == 0) ? size - 1 : pos - 1;
   const int ctx = 4;
   std::string result;
   for (int j = -ctx; j <= ctx; ++j) {
-    std::size_t idx = (cur + words.size() + static_cast<std::size_t>(j)) % words.size();
-    const std::string& w = words[idx];
+    std::size_t idx = (cur + size * ctx + static_cast<std::size_t>(j)) % size;
+    const std::string_view w = word_chunker_->word(word_chunker_->token(idx));
     if (j == 0) {
       result += "[";
       result += w;
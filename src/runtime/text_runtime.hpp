@@ -1,8 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <htm_gui/runtime.hpp>
@@ -11,12 +16,38 @@
 #include <htm_flow/htm_region.hpp>
 
 #include "encoders/scalar_encoder.hpp"
+#include "encoders/sdr.hpp"
+#include "encoders/word_hash_encoder.hpp"
 #include "encoders/word_row_encoder.hpp"
+#include "runtime/accuracy_tracker.hpp"
+#include "runtime/column_kernels.hpp"
+#include "runtime/layer_pipeline.hpp"
+#include "runtime/snapshot_delta.hpp"
+#include "runtime/spsc_ring.hpp"
+#include "runtime/stage_timers.hpp"
+#include "runtime/symbol_classifier.hpp"
+#include "runtime/step_logger.hpp"
+#include "text/mapped_text_chunker.hpp"
+#include "text/sharded_corpus.hpp"
 #include "text/text_chunker.hpp"
 #include "text/word_chunker.hpp"
 
 namespace chat_htm {
 
+/// Zero every plasticity rate in each layer of `cfg`
+/// (`--freeze-permanences`): the spatial pooler's increment, decrement and
+/// active-column decrement, sequence memory's increment and decrement, and
+/// the temporal-pooling spatial and sequence rates.  Existing synapses then
+/// never adapt.  This is not inference-only: htm_flow still grows distal
+/// segments and new synapses (at `new_syn_permanence`) on bursting columns,
+/// exposes no setting to stop that and has no frozen fast path, so a frozen
+/// region steps at training speed.  htm_flow has no runtime learning switch
+/// either, so this must be applied before the region is constructed.
+void freeze_permanences(htm_flow::HTMRegionConfig& cfg);
+/// True if no layer in `cfg` adapts existing permanences (segment growth is
+/// not considered; see freeze_permanences()).
+bool permanences_frozen(const htm_flow::HTMRegionConfig& cfg);
+
 /// IHtmRuntime implementation that feeds text characters to an HTMRegion.
 ///
 /// Each call to step() reads the next character from a TextChunker, encodes
@@ -28,7 +59,8 @@ class TextRuntime : public htm_gui::IHtmRuntime {
 public:
   enum class InputMode {
     Character,
-    WordRows
+    WordRows,
+    WordHash
   };
 
   /// Construct a TextRuntime with an existing TextChunker and encoder.
@@ -40,10 +72,28 @@ public:
               std::unique_ptr<TextChunker> chunker,
               const ScalarEncoder& encoder,
               const std::string& name = "chat_htm");
+  /// Character mode over a memory-mapped file (see MappedTextChunker).
+  TextRuntime(const htm_flow::HTMRegionConfig& cfg,
+              std::unique_ptr<MappedTextChunker> chunker,
+              const ScalarEncoder& encoder,
+              const std::string& name = "chat_htm");
   TextRuntime(const htm_flow::HTMRegionConfig& cfg,
               std::unique_ptr<WordChunker> chunker,
               const WordRowEncoder& encoder,
               const std::string& name = "chat_htm");
+  /// Character mode over a sharded corpus.  The first shard is loaded here;
+  /// step() moves on to the next one when a shard is used up (see
+  /// set_shard_reset()).
+  TextRuntime(const htm_flow::HTMRegionConfig& cfg,
+              std::unique_ptr<ShardedCorpus> corpus,
+              const ScalarEncoder& encoder,
+              const std::string& name = "chat_htm");
+  /// Word mode with hashed encodings (`text.mode: word_hash`).
+  TextRuntime(const htm_flow::HTMRegionConfig& cfg,
+              std::unique_ptr<WordChunker> chunker,
+              const WordHashEncoder& encoder,
+              const std::string& name = "chat_htm");
+  ~TextRuntime() override;
 
   // --- IHtmRuntime interface (delegates to the active layer) ---
   htm_gui::Snapshot snapshot() const override;
@@ -57,6 +107,26 @@ public:
   int activation_threshold() const override;
   std::string name() const override;
 
+  // --- Incremental snapshots for the GUI ---
+  /// Version of the state snapshot() would return; advances on every step.
+  std::uint64_t snapshot_version() const { return static_cast<std::uint64_t>(timestep()) + 1; }
+  /// Active layer changes since the receiver last saw version `since` (0 =
+  /// nothing yet, which yields a keyframe).  If nothing has stepped this
+  /// costs no htm_flow snapshot at all; otherwise one snapshot is diffed
+  /// against the last reported state, so the delta (and the GUI's redraw)
+  /// scales with the columns that changed.  Serves one receiver; the
+  /// reference is valid until the next call.
+  const SnapshotDelta& snapshot_delta(std::uint64_t since) const;
+
+  /// Up to `count` distal segments of one cell, starting at `first`.
+  struct DistalPage {
+    int total_segments{0};
+    std::vector<htm_gui::DistalSynapseQuery> segments;
+  };
+  /// Query only the segments the caller will show.  Results are memoized
+  /// until the network steps or the active layer changes.
+  DistalPage query_distal_page(int column_x, int column_y, int cell, int first, int count) const;
+
   // --- Layer selection for GUI ---
   std::vector<htm_gui::InputSequence> layer_options() const override;
   int num_layers() const override;
@@ -65,12 +135,41 @@ public:
 
   // --- Text-specific accessors ---
   const TextChunker& chunker() const { return *chunker_; }
+  /// Only valid when constructed with a MappedTextChunker.
+  const MappedTextChunker& mapped_chunker() const { return *mapped_chunker_; }
+  /// True if character input comes from a memory-mapped file.
+  bool is_mapped() const { return mapped_chunker_ != nullptr; }
+  /// True if character input comes from a ShardedCorpus; chunker() is then
+  /// the current shard and input_epoch() counts passes over all shards.
+  bool is_sharded() const { return shards_ != nullptr; }
+  /// Only valid when constructed with a ShardedCorpus.
+  const ShardedCorpus& shards() const { return *shards_; }
+
+  /// Treat every shard as its own document (default on): at a shard
+  /// boundary, step the region once on an empty input so no sequence
+  /// context carries over from the previous shard.  That step is not
+  /// sampled for accuracy and the classifier does not learn from it, but
+  /// the region learns as on any step (htm_flow cannot pause learning):
+  /// segments that predicted a continuation are adapted as mispredictions.
+  void set_shard_reset(bool enabled) { shard_reset_ = enabled; }
+  bool shard_reset() const { return shard_reset_; }
+  /// Boundaries crossed so far.
+  std::uint64_t shard_switches() const { return shard_switches_; }
   const WordChunker& word_chunker() const { return *word_chunker_; }
   const ScalarEncoder& encoder() const { return encoder_; }
   const WordRowEncoder& word_encoder() const { return word_encoder_; }
+  const WordHashEncoder& word_hash_encoder() const { return word_hash_encoder_; }
   htm_flow::HTMRegion& region() { return *region_; }
   const htm_flow::HTMRegion& region() const { return *region_; }
   InputMode input_mode() const { return input_mode_; }
+  /// True if the region was built from a freeze_permanences() config, whose
+  /// permanences are fixed but which can still grow segments.
+  bool permanences_frozen() const { return permanences_frozen_; }
+  /// Whether the classifier learns from corpus steps (default on).  This is
+  /// independent of permanences_frozen(): a frozen region still
+  /// needs a trained classifier to decode, and feed() never teaches it.
+  void set_classifier_learning(bool enabled) { classifier_learning_ = enabled; }
+  bool classifier_learning() const { return classifier_learning_; }
   std::size_t input_size() const;
   int input_epoch() const;
   std::size_t input_total_steps() const;
@@ -78,39 +177,264 @@ public:
 
   /// The character that was most recently fed to the network.
   char last_char() const { return last_char_; }
-  const std::string& last_word() const { return last_word_; }
+  /// The word most recently fed to the network (a view into the chunker).
+  std::string_view last_word() const { return last_word_; }
+
+  /// Replace per-step encoding with a precomputed symbol table, e.g. one
+  /// loaded from a corpus cache.  Row `r` holds the active input bits for
+  /// byte value `r` (character mode, 256 rows) or word id `r` (word mode).
+  /// Throws std::invalid_argument if the table does not fit the input.
+  void set_symbol_table(SdrTable table);
+  bool has_symbol_table() const { return !symbol_table_.empty(); }
+
+  /// Read and encode up to `depth` symbols ahead of the region on a
+  /// producer thread (0 = off, the default).  step() then only consumes
+  /// ready-made SDRs from a lock-free ring, so encoding overlaps the
+  /// region's own work.  Results are identical to unpipelined stepping.
+  void set_prefetch(int depth);
+  int prefetch() const { return prefetch_depth_; }
+
+  /// Run the region's layers as a wavefront, one thread per layer (see
+  /// LayerPipeline).  Layer k then lags layer 0 by k steps.  Only valid for
+  /// configs with feedback disabled; the caller is responsible for that.
+  void set_layer_pipeline(bool enabled);
+  bool layer_pipeline() const { return pipeline_ != nullptr; }
+
+  /// Decode layer 0's predictive columns into the `top_k` most likely next
+  /// symbols after every step (0 = off, the default).  A SymbolClassifier
+  /// learns which columns each input symbol activates (unless learning is
+  /// disabled) and ranks symbols by the columns now predicted.  Costs one
+  /// layer 0 snapshot per step; the next accuracy sample reuses it.
+  void set_classifier(int top_k);
+  int classifier_top_k() const { return classifier_top_k_; }
+  const SymbolClassifier& classifier() const { return classifier_; }
+  /// Swap in learned classifier state, e.g. one merged across replicas.
+  /// Throws std::invalid_argument if it was built for a different number
+  /// of layer 0 columns.
+  void replace_classifier(SymbolClassifier classifier);
+  /// Ranked predictions for the upcoming input (empty when off or untrained).
+  const std::vector<SymbolClassifier::Prediction>& predictions() const { return predictions_; }
+  /// Fraction of steps whose top prediction matched the input that followed.
+  double classifier_accuracy() const;
+  /// Readable form of a symbol: the character or the vocabulary word.
+  std::string symbol_text(std::uint32_t symbol) const;
+
+  /// Symbols for free text in this runtime's alphabet: its bytes in
+  /// character mode (normalize it first, like the corpus), or the ids of
+  /// its words in word mode.  Words outside the vocabulary are dropped.
+  std::vector<std::uint32_t> text_symbols(std::string_view text) const;
+
+  /// Feed `symbol` to the region directly, bypassing the text source, and
+  /// decode the predictions for the symbol after it (see generate()).
+  /// The cursor, accuracy counters and step log are left alone and the
+  /// classifier does not learn.  With the classifier on, each call copies
+  /// a full layer 0 snapshot, htm_flow's only view of predictive cells, so
+  /// the encode side is allocation-free once warm but the decode side is
+  /// not.  Throws std::invalid_argument for a symbol outside the alphabet.
+  void feed(std::uint32_t symbol);
+
+  /// Per-stage step() timings; call timers().set_enabled(true) to record.
+  StageTimers& timers() { return timers_; }
+  const StageTimers& timers() const { return timers_; }
+
+  /// Steps taken by the region, counted here in 64 bits rather than read
+  /// from htm_flow's int counter, which the layer pipeline bypasses.
+  std::int64_t timestep() const { return timestep_; }
 
   /// Enable/disable per-step text input logging.
-  /// When enabled, each step() prints the current text context to stdout.
-  void set_log_text(bool enabled) { log_text_ = enabled; }
-  bool log_text() const { return log_text_; }
+  /// When enabled, each step() queues the current text context for stdout
+  /// (shorthand for set_step_log() with default options).
+  void set_log_text(bool enabled);
+  bool log_text() const { return step_logger_ != nullptr; }
+
+  /// Log sampled steps through an asynchronous StepLogger; replaces any
+  /// current log.  Throws like the StepLogger constructor.
+  void set_step_log(const StepLogger::Options& opts);
+  /// Write out everything logged so far (no-op when logging is off).
+  void flush_log();
 
   /// Cumulative prediction accuracy (fraction of steps where the HTM
   /// predicted the correct next column activation pattern).
   double prediction_accuracy() const;
+  /// The counters behind prediction_accuracy().
+  std::int64_t correct_predictions() const { return correct_predictions_; }
+  std::int64_t total_predictions() const { return total_predictions_; }
+
+  /// Layer 0 column counts behind the accuracy metric for one sampled step.
+  struct PredictionMetrics {
+    int active_columns{0};            ///< Active columns in layer 0.
+    int predicted_active_columns{0};  ///< Active columns with a predictive cell.
+  };
+
+  /// How often step() samples layer 0 for the accuracy metric.
+  /// 1 = every step (default), N = every Nth timestep, 0 = never.
+  /// htm_flow only exposes cell predictive state through the full GUI
+  /// snapshot, so headless runs can trade accuracy resolution for speed.
+  void set_accuracy_interval(int steps) { accuracy_interval_ = steps < 0 ? 0 : steps; }
+  int accuracy_interval() const { return accuracy_interval_; }
+
+  /// Windowed, EMA, per-epoch and per-symbol views of the same samples.
+  /// Each sample is attributed to the symbol fed on the step it measures.
+  const AccuracyTracker& accuracy_tracker() const { return accuracy_tracker_; }
+  /// Replace the tracker (dropping its history) with one over the last
+  /// `window` samples and EMA weight `ema_alpha`.  Throws like
+  /// AccuracyTracker's constructor.
+  void set_accuracy_window(std::size_t window, double ema_alpha = 0.01) {
+    accuracy_tracker_ = AccuracyTracker(window, ema_alpha);
+  }
+
+  /// Counts from the most recent accuracy sample.
+  const PredictionMetrics& last_prediction_metrics() const { return last_metrics_; }
+
+  /// A progress record: the input cursor and accuracy counters of a run,
+  /// plus the classifier's counts when it is on.  The accuracy tracker's
+  /// history is not saved.
+  ///
+  /// htm_flow does not expose its permanences or segments for export, so
+  /// the region is not part of the record and a run cannot be resumed from
+  /// one: the counters and cursor describe a model that a new process does
+  /// not have.  There is deliberately no way to apply a record to a
+  /// runtime; load_classifier() reuses only its classifier.
+  struct ProgressRecord {
+    std::uint32_t mode{0};           ///< InputMode.
+    std::uint64_t input_size{0};
+    std::uint64_t position{0};
+    std::int64_t epoch{0};
+    std::uint64_t total_steps{0};
+    std::int64_t region_timestep{0};  ///< Informational; the region restarts at 0.
+    std::int64_t correct_predictions{0};
+    std::int64_t total_predictions{0};
+    PredictionMetrics last_metrics;
+  };
+
+  ProgressRecord progress() const;
+
+  /// Write progress() and the classifier to `path` in one block.  The file
+  /// is written next to `path` and renamed into place, so an interrupted
+  /// save never leaves a truncated file behind.  Throws std::runtime_error
+  /// on I/O failure.
+  void save_progress(const std::string& path) const;
+  /// Take only the classifier from a progress file (e.g. a classifier
+  /// merged by ClassifierReplicas, evaluated on other text), leaving the
+  /// cursor and counters alone.  Returns false if the file has no
+  /// classifier.  Throws std::runtime_error on a bad or incompatible file,
+  /// and like replace_classifier().
+  bool load_classifier(const std::string& path);
 
 private:
+  /// Step the region once (or tick the layer pipeline) and count it.
+  void step_region();
+  /// True if the upcoming step should sample layer 0 for accuracy.
+  bool should_sample_accuracy() const;
+  /// Count layer 0 active columns that were predicted.  Returns false if the
+  /// layer has no cell state yet.
+  bool measure_prediction(PredictionMetrics& out) const;
+  /// Accuracy counts from a layer 0 snapshot, using the reusable bitsets.
+  void metrics_from(const htm_gui::Snapshot& snap, PredictionMetrics& out) const;
+  /// Train the classifier on `symbol` and decode the next-symbol predictions.
+  void classify_step(std::uint32_t symbol);
+  /// Rank symbols by the predictive columns in `snap` into predictions_.
+  void decode_predictions(const htm_gui::Snapshot& snap);
+  /// Pack the snapshot's predictive columns into predictive_bits_.
+  const Sdr& pack_predictive(const htm_gui::Snapshot& snap) const;
+  /// Fold one sample into the cumulative accuracy counters.
+  void record_prediction(const PredictionMetrics& m);
+  /// Hand a sparse active-index list to the region.  Only the bits that
+  /// changed since the previous step are touched in the dense input buffer.
+  void set_input_indices(SdrView active);
+
+  /// One prefetched input: the symbol (byte value or word id) and its SDR.
+  struct PrefetchSlot {
+    std::uint32_t symbol{0};
+    std::vector<int> active;
+  };
+  /// Move to the next shard once the current one is used up, and apply
+  /// the document reset.
+  void advance_shard();
+  void start_prefetch();
+  void stop_prefetch();
+  /// Producer loop: encode symbols from corpus index `start` onwards.
+  void prefetch_loop(std::size_t start);
+  /// Symbol at absolute corpus index `idx` (read-only, any thread).
+  std::uint32_t symbol_at(std::size_t idx) const;
+  /// Position of the active chunker's cursor.
+  std::size_t input_position() const;
+  /// Active indices for `symbol`: a view into the symbol table or encoder
+  /// cache, or `scratch` after encoding into it.
+  SdrView lookup_or_encode(std::uint32_t symbol, std::vector<int>& scratch) const;
+
   /// Print a readable character (replace control chars with spaces/dots).
   static char printable(char c);
+  /// input_context() as it was with the cursor at `pos`.  Reads only the
+  /// immutable corpus, so the log writer thread may call it.
+  std::string input_context_at(std::size_t pos) const;
   /// Build a context string showing surrounding text with current char highlighted.
-  std::string text_context() const;
+  template <typename Chunker>
+  static std::string text_context(const Chunker& chunker, std::size_t pos);
+  /// Read and advance the active character source.
+  int next_char();
   /// Build a context string showing surrounding words with current word highlighted.
-  std::string word_context() const;
+  std::string word_context(std::size_t pos) const;
 
   std::unique_ptr<htm_flow::HTMRegion> region_;
   std::unique_ptr<TextChunker> chunker_;
+  std::unique_ptr<MappedTextChunker> mapped_chunker_;
   std::unique_ptr<WordChunker> word_chunker_;
+  std::unique_ptr<ShardedCorpus> shards_;
+  bool shard_reset_{true};
+  std::uint64_t shard_switches_{0};
+  bool skip_next_sample_{false};  ///< The last step was a document reset.
   ScalarEncoder encoder_;
   WordRowEncoder word_encoder_;
+  WordHashEncoder word_hash_encoder_;
   InputMode input_mode_{InputMode::Character};
   std::string name_;
   int active_layer_idx_{0};
-  bool log_text_{false};
+  bool permanences_frozen_{false};
+  bool classifier_learning_{true};
+
+  std::vector<int> input_bits_;    ///< Dense layer 0 input, reused every step.
+  std::vector<int> input_active_;  ///< Indices currently set in input_bits_.
+  std::vector<int> next_active_;   ///< Encoder output for the upcoming step.
+  SdrTable symbol_table_;          ///< Optional precomputed symbol -> SDR table.
+
+  mutable SnapshotTracker snapshot_tracker_;
+  /// query_distal_page() memo, keyed by packed (x, y, cell, segment).
+  mutable std::unordered_map<std::uint64_t, htm_gui::DistalSynapseQuery> distal_cache_;
+  mutable std::uint64_t distal_cache_version_{0};
+  mutable int distal_cache_layer_{-1};
+
+  StageTimers timers_;
+  std::unique_ptr<StepLogger> step_logger_;
+  std::unique_ptr<LayerPipeline> pipeline_;
+  std::int64_t timestep_{0};  ///< Region steps or pipeline ticks since construction.
+
+  int prefetch_depth_{0};
+  std::unique_ptr<SpscRing<PrefetchSlot>> prefetch_ring_;
+  std::thread prefetch_thread_;
+  std::atomic<bool> prefetch_stop_{false};
 
   char last_char_{'\0'};
-  std::string last_word_;
-  int correct_predictions_{0};
-  int total_predictions_{0};
+  std::string_view last_word_;
+  std::int64_t correct_predictions_{0};
+  std::int64_t total_predictions_{0};
+  int accuracy_interval_{1};
+  PredictionMetrics last_metrics_;
+  AccuracyTracker accuracy_tracker_;
+  std::uint32_t last_symbol_{0};  ///< Symbol fed on the latest step.
+  int last_epoch_{0};             ///< Input epoch that symbol was read in.
+  mutable Sdr predictive_bits_{0};  ///< pack_predictive() scratch.
+  /// Metrics computed from the classifier's post-step snapshot, reused by
+  /// the next accuracy sample (same region state).
+  PredictionMetrics pending_metrics_;
+  bool has_pending_metrics_{false};
+
+  SymbolClassifier classifier_;
+  int classifier_top_k_{0};
+  std::vector<SymbolClassifier::Prediction> predictions_;
+  std::vector<int> predictive_columns_;  ///< classify_step() scratch.
+  int classifier_hits_{0};
+  int classifier_total_{0};
 };
 
 }  // namespace chat_htm
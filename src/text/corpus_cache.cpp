@@ -0,0 +1,285 @@
+#include "text/corpus_cache.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chat_htm {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'H', 'T', 'M', 'C', 'R', 'P', '\0'};
+constexpr std::uint32_t kByteOrder = 0x01020304u;
+
+std::uint64_t fnv1a(const std::string& s) {
+  std::uint64_t h = 1469598103934665603ull;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+/// Streams sections to a cache file, 8-byte aligned, leaving room for the
+/// header which is written last once all section offsets are known.
+class SectionWriter {
+public:
+  explicit SectionWriter(const std::string& path)
+      : out_(path, std::ios::binary | std::ios::trunc), path_(path) {
+    if (!out_.is_open()) {
+      throw std::runtime_error("corpus cache: cannot write file: " + path);
+    }
+    pad_to(sizeof(CorpusCacheHeader));
+  }
+
+  /// Append `bytes` bytes and return the section's file offset.
+  std::uint64_t write(const void* data, std::size_t bytes) {
+    pad_to((pos_ + 7) & ~std::uint64_t{7});
+    const std::uint64_t at = pos_;
+    out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    pos_ += bytes;
+    return at;
+  }
+
+  void finish(const CorpusCacheHeader& header) {
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.flush();
+    if (!out_) throw std::runtime_error("corpus cache: write failed: " + path_);
+  }
+
+private:
+  void pad_to(std::uint64_t target) {
+    static const char zeros[8] = {};
+    while (pos_ < target) {
+      const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(8, target - pos_));
+      out_.write(zeros, static_cast<std::streamsize>(n));
+      pos_ += n;
+    }
+  }
+
+  std::ofstream out_;
+  std::string path_;
+  std::uint64_t pos_{0};
+};
+
+CorpusCacheHeader make_header(CorpusKind kind, std::uint32_t token_width, std::uint64_t hash) {
+  CorpusCacheHeader h{};
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version = kCorpusCacheVersion;
+  h.byte_order = kByteOrder;
+  h.kind = static_cast<std::uint32_t>(kind);
+  h.token_width = token_width;
+  h.params_hash = hash;
+  return h;
+}
+
+void write_sdr_table(SectionWriter& w, const SdrTable& table, CorpusCacheHeader& h) {
+  h.sdr_rows = table.size();
+  h.sdr_indices = table.indices().size();
+  h.sdr_offsets_at = w.write(table.offsets().data(),
+                             table.offsets().size() * sizeof(std::uint32_t));
+  h.sdr_indices_at = w.write(table.indices().data(), table.indices().size() * sizeof(int));
+}
+
+/// Encode every vocabulary word with `encoder` and write the word-mode
+/// sections (vocabulary, id stream, SDR table) plus the header.
+template <typename Encoder>
+void write_word_cache(const std::string& out_path, const WordChunker& chunker,
+                      const Encoder& encoder, std::size_t bits_per_word, CorpusCacheHeader& h) {
+  SdrTable table;
+  table.reserve(chunker.vocabulary_size(), bits_per_word);
+  std::vector<int> active;
+  for (std::size_t id = 0; id < chunker.vocabulary_size(); ++id) {
+    encoder.encode_indices(chunker.word(static_cast<WordChunker::WordId>(id)), active);
+    table.add(active);
+  }
+
+  SectionWriter w(out_path);
+  h.vocab_size = chunker.vocabulary_size();
+  h.arena_bytes = chunker.arena().size();
+  h.vocab_offsets_at = w.write(chunker.word_offsets().data(),
+                               chunker.word_offsets().size() * sizeof(std::uint32_t));
+  h.arena_at = w.write(chunker.arena().data(), chunker.arena().size());
+  h.num_tokens = chunker.tokens().size();
+  h.tokens_at = w.write(chunker.tokens().data(), chunker.tokens().size() * sizeof(WordChunker::WordId));
+  write_sdr_table(w, table, h);
+  w.finish(h);
+}
+
+}  // namespace
+
+std::uint64_t corpus_cache_hash(const ScalarEncoder::Params& p, const TextNormalization& norm) {
+  return fnv1a("character;n=" + std::to_string(p.n) + ";w=" + std::to_string(p.w)
+               + ";min=" + std::to_string(p.min_val) + ";max=" + std::to_string(p.max_val)
+               + ";lower=" + std::to_string(norm.lowercase)
+               + ";ascii=" + std::to_string(norm.ascii_only));
+}
+
+std::uint64_t corpus_cache_hash(const WordRowEncoder::Params& p) {
+  return fnv1a("word_rows;rows=" + std::to_string(p.rows) + ";cols=" + std::to_string(p.cols)
+               + ";letter_bits=" + std::to_string(p.letter_bits) + ";alphabet=" + p.alphabet);
+}
+
+std::uint64_t corpus_cache_hash(const WordHashEncoder::Params& p) {
+  return fnv1a("word_hash;n=" + std::to_string(p.n) + ";w=" + std::to_string(p.w)
+               + ";trigram_bits=" + std::to_string(p.trigram_bits)
+               + ";seed=" + std::to_string(p.seed));
+}
+
+void write_corpus_cache(const std::string& out_path, const TextChunker& chunker,
+                        const ScalarEncoder& encoder, const TextNormalization& norm) {
+  const auto& p = encoder.params();
+  CorpusCacheHeader h = make_header(CorpusKind::Character, 1, corpus_cache_hash(p, norm));
+  h.encoder[0] = p.n;
+  h.encoder[1] = p.w;
+  h.encoder[2] = p.min_val;
+  h.encoder[3] = p.max_val;
+
+  SdrTable table;
+  table.reserve(256, static_cast<std::size_t>(p.w));
+  std::vector<int> active;
+  for (int v = 0; v < 256; ++v) {
+    encoder.encode_indices(v, active);
+    table.add(active);
+  }
+
+  SectionWriter w(out_path);
+  h.num_tokens = chunker.text().size();
+  h.tokens_at = w.write(chunker.text().data(), chunker.text().size());
+  write_sdr_table(w, table, h);
+  w.finish(h);
+}
+
+void write_corpus_cache(const std::string& out_path, const WordChunker& chunker,
+                        const WordRowEncoder& encoder) {
+  const auto& p = encoder.params();
+  CorpusCacheHeader h = make_header(CorpusKind::Words, 4, corpus_cache_hash(p));
+  h.encoder[0] = p.rows;
+  h.encoder[1] = p.cols;
+  h.encoder[2] = p.letter_bits;
+  h.encoder[3] = static_cast<std::int32_t>(p.alphabet.size());
+  write_word_cache(out_path, chunker, encoder,
+                   static_cast<std::size_t>(p.rows * p.letter_bits), h);
+}
+
+void write_corpus_cache(const std::string& out_path, const WordChunker& chunker,
+                        const WordHashEncoder& encoder) {
+  const auto& p = encoder.params();
+  CorpusCacheHeader h = make_header(CorpusKind::Words, 4, corpus_cache_hash(p));
+  h.encoder[0] = p.n;
+  h.encoder[1] = p.w;
+  h.encoder[2] = p.trigram_bits;
+  h.encoder[3] = static_cast<std::int32_t>(p.seed);  // Low bits; the hash covers all 64.
+  write_word_cache(out_path, chunker, encoder, static_cast<std::size_t>(p.w), h);
+}
+
+CorpusCache::CorpusCache(const std::string& path) : path_(path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("CorpusCache: cannot open file: " + path);
+  }
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(CorpusCacheHeader)) {
+    ::close(fd);
+    throw std::runtime_error("CorpusCache: file too small to be a corpus cache: " + path);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    throw std::runtime_error("CorpusCache: mmap failed for " + path + ": " + std::strerror(errno));
+  }
+  data_ = static_cast<const unsigned char*>(addr);
+  std::memcpy(&header_, data_, sizeof(header_));
+
+  auto fail = [&](const std::string& why) {
+    ::munmap(const_cast<unsigned char*>(data_), size_);
+    data_ = nullptr;
+    throw std::runtime_error("CorpusCache: " + path + ": " + why);
+  };
+  if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0) fail("not a corpus cache file");
+  if (header_.version != kCorpusCacheVersion) {
+    fail("unsupported version " + std::to_string(header_.version) + " (expected "
+         + std::to_string(kCorpusCacheVersion) + "); re-run --precompile");
+  }
+  if (header_.byte_order != kByteOrder) fail("written on a machine with a different byte order");
+  if (header_.kind == static_cast<std::uint32_t>(CorpusKind::Character)) {
+    if (header_.token_width != 1) fail("bad token width for character cache");
+  } else if (header_.kind == static_cast<std::uint32_t>(CorpusKind::Words)) {
+    if (header_.token_width != 4) fail("bad token width for word cache");
+  } else {
+    fail("unknown corpus kind");
+  }
+  if (header_.num_tokens == 0) fail("cache contains no tokens");
+  try {
+    section<unsigned char>(header_.tokens_at, header_.num_tokens * header_.token_width);
+    section<std::uint32_t>(header_.sdr_offsets_at, header_.sdr_rows + 1);
+    section<int>(header_.sdr_indices_at, header_.sdr_indices);
+    if (kind() == CorpusKind::Words) {
+      section<std::uint32_t>(header_.vocab_offsets_at, header_.vocab_size + 1);
+      section<char>(header_.arena_at, header_.arena_bytes);
+    }
+  } catch (const std::runtime_error& e) {
+    fail(e.what());
+  }
+}
+
+CorpusCache::~CorpusCache() {
+  if (data_) ::munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+template <typename T>
+const T* CorpusCache::section(std::uint64_t offset, std::uint64_t count) const {
+  if (offset % alignof(T) != 0 || offset > size_ || count > (size_ - offset) / sizeof(T)) {
+    throw std::runtime_error("truncated or corrupt section");
+  }
+  return reinterpret_cast<const T*>(data_ + offset);
+}
+
+void CorpusCache::require_params(std::uint64_t expected_hash) const {
+  if (header_.params_hash != expected_hash) {
+    throw std::runtime_error("CorpusCache: " + path_
+                             + " was built with different text/encoder settings than this "
+                               "config; re-run --precompile");
+  }
+}
+
+std::unique_ptr<MappedTextChunker> CorpusCache::character_chunker() const {
+  if (kind() != CorpusKind::Character) {
+    throw std::logic_error("CorpusCache: not a character-mode cache");
+  }
+  // Normalization was applied before the text was written.
+  return std::make_unique<MappedTextChunker>(path_, static_cast<std::size_t>(header_.tokens_at),
+                                             static_cast<std::size_t>(header_.num_tokens));
+}
+
+std::unique_ptr<WordChunker> CorpusCache::word_chunker() const {
+  if (kind() != CorpusKind::Words) {
+    throw std::logic_error("CorpusCache: not a word-mode cache");
+  }
+  const auto* offsets = section<std::uint32_t>(header_.vocab_offsets_at, header_.vocab_size + 1);
+  const auto* arena = section<char>(header_.arena_at, header_.arena_bytes);
+  const auto* tokens = section<WordChunker::WordId>(header_.tokens_at, header_.num_tokens);
+  return std::make_unique<WordChunker>(WordChunker::from_interned(
+      std::string(arena, arena + header_.arena_bytes),
+      std::vector<std::uint32_t>(offsets, offsets + header_.vocab_size + 1),
+      std::vector<WordChunker::WordId>(tokens, tokens + header_.num_tokens), path_));
+}
+
+SdrTable CorpusCache::sdr_table() const {
+  const auto* offsets = section<std::uint32_t>(header_.sdr_offsets_at, header_.sdr_rows + 1);
+  const auto* indices = section<int>(header_.sdr_indices_at, header_.sdr_indices);
+  return SdrTable::from_raw(std::vector<int>(indices, indices + header_.sdr_indices),
+                            std::vector<std::uint32_t>(offsets, offsets + header_.sdr_rows + 1));
+}
+
+}  // namespace chat_htm
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "encoders/scalar_encoder.hpp"
+#include "encoders/sdr_table.hpp"
+#include "encoders/word_hash_encoder.hpp"
+#include "encoders/word_row_encoder.hpp"
+#include "text/mapped_text_chunker.hpp"
+#include "text/text_chunker.hpp"
+#include "text/text_preprocess.hpp"
+#include "text/word_chunker.hpp"
+
+namespace chat_htm {
+
+/// Binary pre-encoded corpus cache (`chat_htm --precompile`).
+///
+/// A cache file holds everything a run needs from its input so that later
+/// runs skip reading, normalizing, tokenizing and encoding the corpus:
+///
+///   header      CorpusCacheHeader (magic, version, encoder params + hash)
+///   vocabulary  word offsets (uint32, V+1) and arena bytes   [word mode]
+///   tokens      normalized text bytes [character] or uint32 word ids [word]
+///   sdr table   row offsets (uint32, rows+1) and active indices (int32)
+///
+/// Sections start on 8-byte boundaries and are stored in host byte order;
+/// the header records the byte order so a cache is rejected on a machine
+/// that does not match.  The character-mode text section is memory-mapped
+/// in place; word-mode sections are copied out of the mapping.
+///
+/// The params hash covers only what affects the cached bytes (mode,
+/// normalization and encoder parameters), so one cache can be shared by
+/// every config in a sweep that uses the same encoder.
+enum class CorpusKind : std::uint32_t {
+  Character = 0,
+  Words = 1
+};
+
+struct CorpusCacheHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint32_t kind;
+  std::uint32_t token_width;      ///< Bytes per token: 1 (character) or 4 (word id).
+  std::uint64_t params_hash;
+  /// n,w,min,max (character) / rows,cols,letter_bits,alphabet (word_rows) /
+  /// n,w,trigram_bits,seed (word_hash).
+  std::int32_t encoder[4];
+  std::uint64_t num_tokens;
+  std::uint64_t vocab_size;
+  std::uint64_t arena_bytes;
+  std::uint64_t sdr_rows;
+  std::uint64_t sdr_indices;
+  std::uint64_t vocab_offsets_at;  ///< File offsets of each section.
+  std::uint64_t arena_at;
+  std::uint64_t tokens_at;
+  std::uint64_t sdr_offsets_at;
+  std::uint64_t sdr_indices_at;
+};
+
+constexpr std::uint32_t kCorpusCacheVersion = 1;
+
+/// Hash of the settings that determine a character-mode cache's contents.
+std::uint64_t corpus_cache_hash(const ScalarEncoder::Params& p, const TextNormalization& norm);
+/// Hash of the settings that determine a word-mode cache's contents.
+std::uint64_t corpus_cache_hash(const WordRowEncoder::Params& p);
+std::uint64_t corpus_cache_hash(const WordHashEncoder::Params& p);
+
+/// Write a character-mode cache: the chunker's (already normalized) text
+/// plus the encoding of every byte value 0..255.
+void write_corpus_cache(const std::string& out_path, const TextChunker& chunker,
+                        const ScalarEncoder& encoder, const TextNormalization& norm);
+/// Write a word-mode cache: vocabulary, word-id stream and one SDR per word.
+void write_corpus_cache(const std::string& out_path, const WordChunker& chunker,
+                        const WordRowEncoder& encoder);
+void write_corpus_cache(const std::string& out_path, const WordChunker& chunker,
+                        const WordHashEncoder& encoder);
+
+/// Read-only view of a cache file written by write_corpus_cache().
+class CorpusCache {
+public:
+  /// Map `path` and validate its header.  Throws std::runtime_error on a
+  /// missing, truncated or incompatible file.
+  explicit CorpusCache(const std::string& path);
+  ~CorpusCache();
+
+  CorpusCache(const CorpusCache&) = delete;
+  CorpusCache& operator=(const CorpusCache&) = delete;
+
+  const CorpusCacheHeader& header() const { return header_; }
+  CorpusKind kind() const { return static_cast<CorpusKind>(header_.kind); }
+  const std::string& path() const { return path_; }
+
+  /// Throw std::runtime_error unless the cache was built with `expected_hash`.
+  void require_params(std::uint64_t expected_hash) const;
+
+  /// Character mode: iterate the cached text in place.
+  std::unique_ptr<MappedTextChunker> character_chunker() const;
+  /// Word mode: rebuild the interned chunker from the cached sections.
+  std::unique_ptr<WordChunker> word_chunker() const;
+  /// The cached symbol -> SDR table (byte value or word id -> active bits).
+  SdrTable sdr_table() const;
+
+private:
+  template <typename T>
+  const T* section(std::uint64_t offset, std::uint64_t count) const;
+
+  std::string path_;
+  CorpusCacheHeader header_{};
+  const unsigned char* data_{nullptr};
+  std::size_t size_{0};
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "text/text_preprocess.hpp"
+
+namespace chat_htm {
+
+/// Yields one character at a time from a memory-mapped text file.
+///
+/// Same iteration contract as TextChunker (`next()`, `peek()`, `peek_at()`,
+/// `epoch()`, `position()`, ...) but the file is never copied into the
+/// process heap: pages are faulted in on demand and the kernel is told the
+/// access pattern is sequential so it reads ahead.  Use this for corpora
+/// that are too large to load with TextChunker.
+///
+/// Random access for display purposes goes through `at()`, which reads a
+/// single byte from the mapping.
+///
+/// The mapping is read-only, so a TextNormalization is applied per byte as
+/// characters are read (one table lookup) rather than as a load-time pass.
+class MappedTextChunker {
+public:
+  explicit MappedTextChunker(const std::string& path, const TextNormalization& norm = {})
+      : MappedTextChunker(path, 0, 0, norm) {}
+
+  /// Map only the bytes [offset, offset + length) of `path` (length 0 = to
+  /// end of file).  Used to iterate the text section of a corpus cache file
+  /// in place.
+  MappedTextChunker(const std::string& path, std::size_t offset, std::size_t length,
+                    const TextNormalization& norm = {})
+      : path_(path), table_(norm.table()) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("MappedTextChunker: cannot open file: " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      const std::string err = std::strerror(errno);
+      ::close(fd);
+      throw std::runtime_error("MappedTextChunker: cannot stat file: " + path + ": " + err);
+    }
+    const auto file_size = static_cast<std::size_t>(st.st_size);
+    if (offset > file_size || (length > 0 && length > file_size - offset)) {
+      ::close(fd);
+      throw std::runtime_error("MappedTextChunker: range exceeds file size: " + path);
+    }
+    size_ = length > 0 ? length : file_size - offset;
+    if (size_ == 0) {
+      ::close(fd);
+      throw std::runtime_error("MappedTextChunker: file is empty: " + path);
+    }
+    map_size_ = offset + size_;
+    void* addr = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference to the file.
+    if (addr == MAP_FAILED) {
+      throw std::runtime_error("MappedTextChunker: mmap failed for " + path + ": "
+                               + std::strerror(errno));
+    }
+    map_base_ = addr;
+    data_ = static_cast<const char*>(addr) + offset;
+    ::madvise(addr, map_size_, MADV_SEQUENTIAL);
+  }
+
+  ~MappedTextChunker() { unmap(); }
+
+  MappedTextChunker(const MappedTextChunker&) = delete;
+  MappedTextChunker& operator=(const MappedTextChunker&) = delete;
+
+  MappedTextChunker(MappedTextChunker&& other) noexcept { *this = std::move(other); }
+  MappedTextChunker& operator=(MappedTextChunker&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      map_base_ = std::exchange(other.map_base_, nullptr);
+      map_size_ = std::exchange(other.map_size_, 0);
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      path_ = std::move(other.path_);
+      table_ = other.table_;
+      pos_ = other.pos_;
+      epoch_ = other.epoch_;
+      total_steps_ = other.total_steps_;
+    }
+    return *this;
+  }
+
+  /// Return the ASCII value of the current character and advance.
+  /// Wraps around to the beginning when the end of the file is reached.
+  int next() {
+    int value = byte(pos_);
+    ++pos_;
+    ++total_steps_;
+    if (pos_ >= size_) {
+      pos_ = 0;
+      ++epoch_;
+    }
+    return value;
+  }
+
+  /// Peek at the current character without advancing.
+  int peek() const { return byte(pos_); }
+
+  /// Peek at the character at an arbitrary offset from the current position.
+  /// Wraps around the file boundary.
+  int peek_at(int offset) const {
+    return at(pos_ + static_cast<std::size_t>(offset));
+  }
+
+  /// Character at absolute index `idx` (wrapped to the file size).
+  int at(std::size_t idx) const {
+    return byte(idx % size_);
+  }
+
+  /// Reset to the beginning.
+  void reset() {
+    pos_ = 0;
+    epoch_ = 0;
+    total_steps_ = 0;
+  }
+
+  /// Restore a saved cursor (see TextRuntime checkpoints).  Throws
+  /// std::invalid_argument if `pos` is outside the current input.
+  void seek(std::size_t pos, int epoch, std::size_t total_steps) {
+    if (pos >= size_) {
+      throw std::invalid_argument("MappedTextChunker::seek: position past end of input");
+    }
+    pos_ = pos;
+    epoch_ = epoch;
+    total_steps_ = total_steps;
+  }
+
+  /// Number of bytes in the iterated window (the whole file by default).
+  std::size_t size() const { return size_; }
+
+  /// Current position within the file (0-based).
+  std::size_t position() const { return pos_; }
+
+  /// How many complete passes through the file have been made.
+  int epoch() const { return epoch_; }
+
+  /// Total number of characters yielded since construction / last reset.
+  std::size_t total_steps() const { return total_steps_; }
+
+  /// The mapped file path.
+  const std::string& path() const { return path_; }
+
+private:
+  int byte(std::size_t idx) const {
+    return static_cast<unsigned char>(table_[static_cast<unsigned char>(data_[idx])]);
+  }
+
+  void unmap() {
+    if (map_base_) {
+      ::munmap(map_base_, map_size_);
+      map_base_ = nullptr;
+      data_ = nullptr;
+    }
+  }
+
+  void* map_base_{nullptr};   ///< Start of the mapping (file offset 0).
+  std::size_t map_size_{0};
+  const char* data_{nullptr}; ///< First byte of the iterated window.
+  std::size_t size_{0};
+  std::string path_;
+  std::array<char, 256> table_{};  ///< Byte normalization lookup.
+  std::size_t pos_{0};
+  int epoch_{0};
+  std::size_t total_steps_{0};
+};
+
+}  // namespace chat_htm
@@ -0,0 +1,120 @@
+#include "text/sharded_corpus.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace chat_htm {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::uint64_t splitmix64(std::uint64_t& state) {
+  std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+bool nonempty_file(const fs::path& p) {
+  std::error_code ec;
+  return fs::is_regular_file(p, ec) && fs::file_size(p, ec) > 0 && !ec;
+}
+
+}  // namespace
+
+std::vector<std::string> ShardedCorpus::list_shards(const std::string& path) {
+  std::vector<std::string> out;
+  std::error_code ec;
+  if (fs::is_directory(path, ec)) {
+    for (const auto& entry : fs::directory_iterator(path, ec)) {
+      const std::string name = entry.path().filename().string();
+      if (name.empty() || name[0] == '.') continue;
+      if (nonempty_file(entry.path())) out.push_back(entry.path().string());
+    }
+    if (ec) throw std::runtime_error("ShardedCorpus: cannot list directory: " + path);
+    std::sort(out.begin(), out.end());
+  } else {
+    std::ifstream in(path);
+    if (!in.is_open()) throw std::runtime_error("ShardedCorpus: cannot open manifest: " + path);
+    const fs::path base = fs::path(path).parent_path();
+    std::string line;
+    while (std::getline(in, line)) {
+      const auto first = line.find_first_not_of(" \t\r");
+      if (first == std::string::npos || line[first] == '#') continue;
+      const auto last = line.find_last_not_of(" \t\r");
+      fs::path shard = line.substr(first, last - first + 1);
+      if (shard.is_relative()) shard = base / shard;
+      if (!fs::exists(shard, ec)) {
+        throw std::runtime_error("ShardedCorpus: " + path + ": shard not found: " + shard.string());
+      }
+      if (nonempty_file(shard)) out.push_back(shard.string());
+    }
+  }
+  if (out.empty()) throw std::runtime_error("ShardedCorpus: no non-empty shards in " + path);
+  return out;
+}
+
+ShardedCorpus::ShardedCorpus(std::vector<std::string> shards, const Options& opts)
+    : shards_(std::move(shards)), opts_(opts) {
+  if (shards_.empty()) throw std::invalid_argument("ShardedCorpus: no shards");
+  for (const auto& s : shards_) {
+    std::error_code ec;
+    const auto size = fs::file_size(s, ec);
+    if (ec) throw std::runtime_error("ShardedCorpus: cannot read shard: " + s);
+    total_size_ += static_cast<std::size_t>(size);
+  }
+}
+
+ShardedCorpus::~ShardedCorpus() {
+  // A load still in flight finishes before its result is dropped.
+  if (pending_.valid()) pending_.wait();
+}
+
+std::vector<std::size_t> ShardedCorpus::order(int epoch) const {
+  std::vector<std::size_t> out(shards_.size());
+  std::iota(out.begin(), out.end(), std::size_t{0});
+  if (!opts_.shuffle) return out;
+  // Fisher-Yates over our own generator: std::shuffle's draws differ
+  // between standard libraries, which would break reproducibility.
+  std::uint64_t state = opts_.seed ^ (static_cast<std::uint64_t>(epoch) * 0xd1b54a32d192ed03ULL);
+  for (std::size_t i = out.size(); i > 1; --i) {
+    const auto j = static_cast<std::size_t>(splitmix64(state) % i);
+    std::swap(out[i - 1], out[j]);
+  }
+  return out;
+}
+
+const std::string& ShardedCorpus::path_at(const Cursor& c) {
+  if (order_epoch_ != c.epoch) {
+    order_ = order(c.epoch);
+    order_epoch_ = c.epoch;
+  }
+  return shards_[order_[c.index]];
+}
+
+void ShardedCorpus::start_load(const Cursor& c) {
+  pending_ = std::async(std::launch::async,
+                        [path = path_at(c), norm = opts_.norm, threads = opts_.threads] {
+                          return std::make_unique<TextChunker>(path, norm, threads);
+                        });
+}
+
+std::unique_ptr<TextChunker> ShardedCorpus::next_shard() {
+  if (!pending_.valid()) start_load(next_);
+  auto shard = pending_.get();
+  current_ = next_;
+  next_ = current_;
+  if (++next_.index == shards_.size()) {
+    next_.index = 0;
+    ++next_.epoch;
+  }
+  start_load(next_);
+  return shard;
+}
+
+}  // namespace chat_htm
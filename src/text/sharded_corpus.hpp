@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "text/text_chunker.hpp"
+#include "text/text_preprocess.hpp"
+
+namespace chat_htm {
+
+/// A character corpus split over many files, read one shard at a time.
+///
+/// Shards come from a directory (its non-empty regular files, sorted by
+/// name) or a manifest (one path per line, relative to the manifest's
+/// directory; blank lines and `#` comments are skipped).  Each epoch visits
+/// every shard once, in list order or, with `shuffle`, in a permutation
+/// derived from `seed` and the epoch number, so a run is reproducible.
+///
+/// Only the shard being consumed is held in memory.  next_shard() hands it
+/// out as a TextChunker and immediately starts loading the one after it on
+/// a background thread, so by the time the current shard is used up its
+/// successor is (usually) already read and normalized.
+class ShardedCorpus {
+public:
+  struct Options {
+    bool shuffle = false;      ///< Permute the shard order every epoch.
+    std::uint64_t seed = 0;    ///< Shuffle seed; the same seed gives the same order.
+    TextNormalization norm;    ///< Applied to every shard as it loads.
+    int threads = 0;           ///< Normalization workers per shard (0 = all cores).
+  };
+
+  /// Shard paths for `path`, a directory or a manifest file.  Throws
+  /// std::runtime_error if it cannot be read, a manifest entry is missing,
+  /// or no non-empty shard is found.
+  static std::vector<std::string> list_shards(const std::string& path);
+
+  /// Throws std::invalid_argument if `shards` is empty and
+  /// std::runtime_error if a shard cannot be sized.
+  ShardedCorpus(std::vector<std::string> shards, const Options& opts);
+  ~ShardedCorpus();
+
+  ShardedCorpus(const ShardedCorpus&) = delete;
+  ShardedCorpus& operator=(const ShardedCorpus&) = delete;
+
+  /// The next shard in epoch order, wrapping into the next epoch after the
+  /// last one.  Load errors (e.g. a shard deleted mid-run) surface here as
+  /// std::runtime_error.
+  std::unique_ptr<TextChunker> next_shard();
+
+  /// Epoch and position-in-epoch of the shard last returned by next_shard().
+  int epoch() const { return current_.epoch; }
+  std::size_t shard_index() const { return current_.index; }
+
+  /// Shard visiting order for `epoch` (indices into shards()).
+  std::vector<std::size_t> order(int epoch) const;
+
+  const std::vector<std::string>& shards() const { return shards_; }
+  std::size_t num_shards() const { return shards_.size(); }
+  /// Characters per epoch: the shards' combined size (normalization keeps
+  /// every byte, so this is exact).
+  std::size_t total_size() const { return total_size_; }
+  const Options& options() const { return opts_; }
+
+private:
+  struct Cursor {
+    int epoch{0};
+    std::size_t index{0};
+  };
+
+  const std::string& path_at(const Cursor& c);
+  void start_load(const Cursor& c);
+
+  std::vector<std::string> shards_;
+  Options opts_;
+  std::size_t total_size_{0};
+  Cursor current_;
+  Cursor next_;
+  int order_epoch_{-1};
+  std::vector<std::size_t> order_;  ///< order(order_epoch_), cached.
+  std::future<std::unique_ptr<TextChunker>> pending_;
+};
+
+}  // namespace chat_htm
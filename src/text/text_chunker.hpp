@@ -2,10 +2,13 @@
 
 #include <cstddef>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "text/text_preprocess.hpp"
+
 namespace chat_htm {
 
 /// Reads a text file and yields one character at a time.
@@ -15,39 +18,56 @@ namespace chat_htm {
 /// ASCII value of the current character and advance the cursor.  When the
 /// end of file is reached the chunker wraps around and increments the
 /// epoch counter.
+///
+/// An optional TextNormalization is applied once at load time, in parallel
+/// for large files (`threads` workers, 0 = all cores).
+///
+/// The loaded text is immutable and shared: copies of a chunker reference
+/// the same buffer and each keeps its own cursor, so many runtimes can
+/// iterate one corpus without reloading it.
 class TextChunker {
 public:
-  explicit TextChunker(const std::string& path) {
-    std::ifstream f(path, std::ios::binary);
+  explicit TextChunker(const std::string& path, const TextNormalization& norm = {},
+                       int threads = 0) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
     if (!f.is_open()) {
       throw std::runtime_error("TextChunker: cannot open file: " + path);
     }
-    text_ = std::string((std::istreambuf_iterator<char>(f)),
-                         std::istreambuf_iterator<char>());
-    if (text_.empty()) {
+    // Size the buffer up front so the load is a single read with no regrowth.
+    const std::streamsize size = f.tellg();
+    f.seekg(0, std::ios::beg);
+    std::string text(size > 0 ? static_cast<std::size_t>(size) : 0, '\0');
+    if (size > 0 && !f.read(&text[0], size)) {
+      throw std::runtime_error("TextChunker: failed to read file: " + path);
+    }
+    if (text.empty()) {
       throw std::runtime_error("TextChunker: file is empty: " + path);
     }
     path_ = path;
+    norm.apply(text, threads);
+    adopt(std::move(text));
   }
 
   /// Construct from an in-memory string (useful for tests).
-  static TextChunker from_string(const std::string& text) {
-    TextChunker tc;
-    tc.text_ = text;
-    tc.path_ = "<memory>";
+  static TextChunker from_string(const std::string& text, const TextNormalization& norm = {}) {
     if (text.empty()) {
       throw std::invalid_argument("TextChunker::from_string: text must not be empty");
     }
+    TextChunker tc;
+    tc.path_ = "<memory>";
+    std::string copy = text;
+    norm.apply(copy);
+    tc.adopt(std::move(copy));
     return tc;
   }
 
   /// Return the ASCII value of the current character and advance.
   /// Wraps around to the beginning when the end of the text is reached.
   int next() {
-    int value = static_cast<unsigned char>(text_[pos_]);
+    int value = static_cast<unsigned char>(data_[pos_]);
     ++pos_;
     ++total_steps_;
-    if (pos_ >= text_.size()) {
+    if (pos_ >= size_) {
       pos_ = 0;
       ++epoch_;
     }
@@ -56,14 +76,19 @@ public:
 
   /// Peek at the current character without advancing.
   int peek() const {
-    return static_cast<unsigned char>(text_[pos_]);
+    return static_cast<unsigned char>(data_[pos_]);
   }
 
   /// Peek at the character at an arbitrary offset from the current position.
   /// Wraps around the text boundary.
   int peek_at(int offset) const {
-    auto idx = (pos_ + static_cast<std::size_t>(offset)) % text_.size();
-    return static_cast<unsigned char>(text_[idx]);
+    auto idx = (pos_ + static_cast<std::size_t>(offset)) % size_;
+    return static_cast<unsigned char>(data_[idx]);
+  }
+
+  /// Character at absolute index `idx` (wrapped to the text size).
+  int at(std::size_t idx) const {
+    return static_cast<unsigned char>(data_[idx % size_]);
   }
 
   /// Reset to the beginning.
@@ -73,8 +98,19 @@ public:
     total_steps_ = 0;
   }
 
+  /// Restore a saved cursor (see TextRuntime checkpoints).  Throws
+  /// std::invalid_argument if `pos` is outside the current input.
+  void seek(std::size_t pos, int epoch, std::size_t total_steps) {
+    if (pos >= size_) {
+      throw std::invalid_argument("TextChunker::seek: position past end of input");
+    }
+    pos_ = pos;
+    epoch_ = epoch;
+    total_steps_ = total_steps;
+  }
+
   /// Number of characters in the loaded text.
-  std::size_t size() const { return text_.size(); }
+  std::size_t size() const { return size_; }
 
   /// Current position within the text (0-based).
   std::size_t position() const { return pos_; }
@@ -89,12 +125,20 @@ public:
   const std::string& path() const { return path_; }
 
   /// The full loaded text.
-  const std::string& text() const { return text_; }
+  const std::string& text() const { return *text_; }
 
 private:
   TextChunker() = default;
 
-  std::string text_;
+  void adopt(std::string text) {
+    text_ = std::make_shared<const std::string>(std::move(text));
+    data_ = text_->data();
+    size_ = text_->size();
+  }
+
+  std::shared_ptr<const std::string> text_;  ///< Shared by copies of this chunker.
+  const char* data_{nullptr};
+  std::size_t size_{0};
   std::string path_;
   std::size_t pos_{0};
   int epoch_{0};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace chat_htm {
+
+/// Corpus preprocessing helpers shared by the chunkers.
+///
+/// Large inputs are split into contiguous byte ranges whose boundaries fall
+/// between tokens, each range is processed on its own thread, and the
+/// per-range results are merged in order by the caller.  Inputs smaller
+/// than kMinParallelBytes are processed on the calling thread.
+namespace preprocess {
+
+/// Inputs below this size are not worth the thread start-up cost.
+constexpr std::size_t kMinParallelBytes = 1u << 20;
+
+/// Half-open byte range [first, second).
+using Range = std::pair<std::size_t, std::size_t>;
+
+/// Worker count: `requested` if > 0, otherwise the hardware thread count.
+inline int worker_count(int requested) {
+  if (requested > 0) return requested;
+  const unsigned hw = std::thread::hardware_concurrency();
+  return hw == 0 ? 1 : static_cast<int>(hw);
+}
+
+/// Split `text` into at most `parts` ranges.  Each interior boundary is
+/// moved forward to the next byte for which `is_boundary(byte)` holds, so a
+/// token never straddles two ranges.
+template <typename IsBoundary>
+std::vector<Range> split(const std::string& text, int parts, IsBoundary is_boundary) {
+  std::vector<Range> ranges;
+  const std::size_t n = text.size();
+  if (parts <= 1 || n < kMinParallelBytes) {
+    ranges.emplace_back(0, n);
+    return ranges;
+  }
+  const std::size_t step = n / static_cast<std::size_t>(parts);
+  std::size_t begin = 0;
+  for (int p = 1; p < parts && begin < n; ++p) {
+    std::size_t cut = std::max(begin, static_cast<std::size_t>(p) * step);
+    while (cut < n && !is_boundary(static_cast<unsigned char>(text[cut]))) ++cut;
+    if (cut > begin) {
+      ranges.emplace_back(begin, cut);
+      begin = cut;
+    }
+  }
+  if (begin < n || ranges.empty()) ranges.emplace_back(begin, n);
+  return ranges;
+}
+
+/// Split `text` at whitespace, the boundary used for character-mode passes.
+inline std::vector<Range> split_at_whitespace(const std::string& text, int parts) {
+  return split(text, parts, [](unsigned char c) { return std::isspace(c) != 0; });
+}
+
+/// Call `fn(index, range)` for every range, one thread per range.  The
+/// first range runs on the calling thread.
+template <typename Fn>
+void for_each_range(const std::vector<Range>& ranges, Fn fn) {
+  if (ranges.size() <= 1) {
+    if (!ranges.empty()) fn(std::size_t{0}, ranges[0]);
+    return;
+  }
+  std::vector<std::thread> workers;
+  workers.reserve(ranges.size() - 1);
+  for (std::size_t i = 1; i < ranges.size(); ++i) {
+    workers.emplace_back([&fn, &ranges, i] { fn(i, ranges[i]); });
+  }
+  fn(std::size_t{0}, ranges[0]);
+  for (auto& t : workers) t.join();
+}
+
+}  // namespace preprocess
+
+/// Per-byte normalization applied to character-mode input.
+struct TextNormalization {
+  bool lowercase = false;   ///< Fold A-Z to a-z.
+  bool ascii_only = false;  ///< Replace bytes >= 128 with a space.
+
+  bool enabled() const { return lowercase || ascii_only; }
+
+  /// 256-entry lookup table implementing this normalization.
+  std::array<char, 256> table() const {
+    std::array<char, 256> t{};
+    for (int c = 0; c < 256; ++c) {
+      int out = c;
+      if (ascii_only && c >= 128) out = ' ';
+      if (lowercase) out = std::tolower(out);
+      t[static_cast<std::size_t>(c)] = static_cast<char>(out);
+    }
+    return t;
+  }
+
+  /// Normalize `text` in place, in parallel for large inputs.
+  void apply(std::string& text, int threads = 0) const {
+    if (!enabled()) return;
+    const auto t = table();
+    const auto ranges = preprocess::split_at_whitespace(text, preprocess::worker_count(threads));
+    preprocess::for_each_range(ranges, [&](std::size_t, const preprocess::Range& r) {
+      for (std::size_t i = r.first; i < r.second; ++i) {
+        text[i] = t[static_cast<unsigned char>(text[i])];
+      }
+    });
+  }
+};
+
+}  // namespace chat_htm
@@ -1,21 +1,44 @@
 #pragma once
 
+#include <algorithm>
 #include <cctype>
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "text/text_preprocess.hpp"
+
 namespace chat_htm {
 
 /// Reads a text file and yields one normalized word at a time.
 ///
 /// Words are sequences of [A-Za-z]. Input is lowercased and tokenized
 /// once at construction for fast repeated epoch iteration.
+///
+/// Storage is interned: each distinct word is stored once in a contiguous
+/// character arena, and the corpus itself is a stream of `uint32_t` word
+/// ids into that vocabulary.  `next()` returns a view into the arena, so
+/// iteration never allocates.
+///
+/// Large inputs are tokenized on `threads` workers (0 = all cores): the
+/// text is split at non-letter bytes, each range is tokenized into its own
+/// local vocabulary, and the ranges are merged in order so word ids and
+/// vocabulary order are identical to a single-threaded pass.
+///
+/// The tokenized corpus is immutable and shared: copies of a chunker
+/// reference the same vocabulary and token stream and each keeps its own
+/// cursor.
 class WordChunker {
 public:
-  explicit WordChunker(const std::string& path) {
+  using WordId = std::uint32_t;
+
+  explicit WordChunker(const std::string& path, int threads = 0) {
     std::ifstream f(path, std::ios::binary);
     if (!f.is_open()) {
       throw std::runtime_error("WordChunker: cannot open file: " + path);
@@ -23,34 +46,79 @@ public:
     std::string content((std::istreambuf_iterator<char>(f)),
                         std::istreambuf_iterator<char>());
     path_ = path;
-    words_ = tokenize(content);
-    if (words_.empty()) {
+    tokenize(content, threads);
+    if (corpus_->tokens.empty()) {
       throw std::runtime_error("WordChunker: no words found in file: " + path);
     }
   }
 
-  static WordChunker from_string(const std::string& text) {
+  static WordChunker from_string(const std::string& text, int threads = 0) {
     WordChunker wc;
     wc.path_ = "<memory>";
-    wc.words_ = tokenize(text);
-    if (wc.words_.empty()) {
+    wc.tokenize(text, threads);
+    if (wc.corpus_->tokens.empty()) {
       throw std::invalid_argument("WordChunker::from_string: text must contain words");
     }
     return wc;
   }
 
-  const std::string& next() {
-    const std::string& value = words_[pos_];
+  /// Rebuild a chunker from already-tokenized storage (e.g. a corpus cache
+  /// file): `arena` holds the distinct words back to back, `offsets` their
+  /// boundaries (size V+1), and `tokens` the corpus as word ids.
+  static WordChunker from_interned(std::string arena, std::vector<std::uint32_t> offsets,
+                                   std::vector<WordId> tokens, const std::string& path) {
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != arena.size()) {
+      throw std::invalid_argument("WordChunker::from_interned: offsets do not match arena");
+    }
+    if (tokens.empty()) {
+      throw std::invalid_argument("WordChunker::from_interned: no tokens");
+    }
+    const std::size_t vocab = offsets.size() - 1;
+    auto corpus = std::make_shared<Corpus>();
+    for (std::size_t id = 0; id < vocab; ++id) {
+      if (offsets[id + 1] < offsets[id]) {
+        throw std::invalid_argument("WordChunker::from_interned: offsets not ascending");
+      }
+      corpus->max_word_length = std::max(corpus->max_word_length,
+                                         static_cast<std::size_t>(offsets[id + 1] - offsets[id]));
+    }
+    for (WordId id : tokens) {
+      if (id >= vocab) throw std::invalid_argument("WordChunker::from_interned: bad word id");
+    }
+    corpus->arena = std::move(arena);
+    corpus->word_offsets = std::move(offsets);
+    corpus->tokens = std::move(tokens);
+    WordChunker wc;
+    wc.path_ = path;
+    wc.corpus_ = std::move(corpus);
+    return wc;
+  }
+
+  /// Distinct words back to back (see word_offsets()).
+  const std::string& arena() const { return corpus_->arena; }
+  /// Word id -> arena offset, size vocabulary_size() + 1.
+  const std::vector<std::uint32_t>& word_offsets() const { return corpus_->word_offsets; }
+
+  /// Return the id of the current word and advance.
+  /// Wraps around to the first word when the end of the corpus is reached.
+  WordId next_id() {
+    const auto& tokens = corpus_->tokens;
+    const WordId id = tokens[pos_];
     ++pos_;
     ++total_steps_;
-    if (pos_ >= words_.size()) {
+    if (pos_ >= tokens.size()) {
       pos_ = 0;
       ++epoch_;
     }
-    return value;
+    return id;
   }
 
-  const std::string& peek() const { return words_[pos_]; }
+  /// Return the current word and advance.  The view stays valid for the
+  /// lifetime of the chunker.
+  std::string_view next() { return word(next_id()); }
+
+  WordId peek_id() const { return corpus_->tokens[pos_]; }
+  std::string_view peek() const { return word(peek_id()); }
 
   void reset() {
     pos_ = 0;
@@ -58,34 +126,143 @@ public:
     total_steps_ = 0;
   }
 
-  std::size_t size() const { return words_.size(); }
+  /// Restore a saved cursor (see TextRuntime checkpoints).  Throws
+  /// std::invalid_argument if `pos` is outside the current input.
+  void seek(std::size_t pos, int epoch, std::size_t total_steps) {
+    if (pos >= corpus_->tokens.size()) {
+      throw std::invalid_argument("WordChunker::seek: position past end of input");
+    }
+    pos_ = pos;
+    epoch_ = epoch;
+    total_steps_ = total_steps;
+  }
+
+  /// Number of word occurrences in the corpus.
+  std::size_t size() const { return corpus_->tokens.size(); }
   std::size_t position() const { return pos_; }
   int epoch() const { return epoch_; }
   std::size_t total_steps() const { return total_steps_; }
   const std::string& path() const { return path_; }
-  const std::vector<std::string>& words() const { return words_; }
+
+  /// Number of distinct words.
+  std::size_t vocabulary_size() const { return corpus_->word_offsets.size() - 1; }
+
+  /// Length of the longest distinct word.  Word-row configs need at least
+  /// this many input rows to encode every letter.
+  std::size_t max_word_length() const { return corpus_->max_word_length; }
+
+  /// Text of vocabulary entry `id`.
+  std::string_view word(WordId id) const {
+    const auto& offsets = corpus_->word_offsets;
+    const std::uint32_t begin = offsets[id];
+    return {corpus_->arena.data() + begin, static_cast<std::size_t>(offsets[id + 1] - begin)};
+  }
+
+  /// Word id of the occurrence at corpus index `idx` (wrapped to size()).
+  WordId token(std::size_t idx) const {
+    const auto& tokens = corpus_->tokens;
+    return tokens[idx % tokens.size()];
+  }
+
+  /// The corpus as a stream of word ids.
+  const std::vector<WordId>& tokens() const { return corpus_->tokens; }
+
+  /// Views of every distinct word, indexed by word id.
+  std::vector<std::string_view> vocabulary() const {
+    std::vector<std::string_view> out;
+    out.reserve(vocabulary_size());
+    for (std::size_t id = 0; id < vocabulary_size(); ++id) {
+      out.push_back(word(static_cast<WordId>(id)));
+    }
+    return out;
+  }
 
 private:
   WordChunker() = default;
 
-  static std::vector<std::string> tokenize(const std::string& text) {
-    std::vector<std::string> out;
+  /// Interned vocabulary and token stream, shared by copies of a chunker.
+  struct Corpus {
+    std::string arena;                            ///< Distinct words, back to back.
+    std::vector<std::uint32_t> word_offsets{0};   ///< Word id -> arena offset (size V+1).
+    std::vector<WordId> tokens;                   ///< Corpus as word ids.
+    std::size_t max_word_length{0};
+  };
+
+  /// Tokens and vocabulary of one input range, with range-local word ids.
+  struct Partial {
+    std::string arena;
+    std::vector<std::uint32_t> offsets{0};
+    std::vector<WordId> tokens;
+  };
+
+  /// Intern `w` into `p` and return its range-local id.
+  static WordId intern(const std::string& w, Partial& p,
+                       std::unordered_map<std::string, WordId>& ids) {
+    auto it = ids.find(w);
+    if (it != ids.end()) return it->second;
+    const auto id = static_cast<WordId>(p.offsets.size() - 1);
+    p.arena += w;
+    p.offsets.push_back(static_cast<std::uint32_t>(p.arena.size()));
+    ids.emplace(w, id);
+    return id;
+  }
+
+  static void tokenize_range(const std::string& text, const preprocess::Range& r, Partial& out) {
+    std::unordered_map<std::string, WordId> ids;
     std::string current;
     current.reserve(32);
-    for (char c : text) {
-      unsigned char uc = static_cast<unsigned char>(c);
+    for (std::size_t i = r.first; i < r.second; ++i) {
+      unsigned char uc = static_cast<unsigned char>(text[i]);
       if (std::isalpha(uc)) {
         current.push_back(static_cast<char>(std::tolower(uc)));
       } else if (!current.empty()) {
-        out.push_back(current);
+        out.tokens.push_back(intern(current, out, ids));
         current.clear();
       }
     }
-    if (!current.empty()) out.push_back(current);
-    return out;
+    if (!current.empty()) out.tokens.push_back(intern(current, out, ids));
+  }
+
+  void tokenize(const std::string& text, int threads) {
+    const auto ranges = preprocess::split(text, preprocess::worker_count(threads),
+                                          [](unsigned char c) { return std::isalpha(c) == 0; });
+    std::vector<Partial> parts(ranges.size());
+    preprocess::for_each_range(ranges, [&](std::size_t i, const preprocess::Range& r) {
+      tokenize_range(text, r, parts[i]);
+    });
+
+    auto corpus = std::make_shared<Corpus>();
+    // Merge range vocabularies in order (preserving first-seen order) and
+    // build a local-id -> global-id remap for each range.
+    Partial global;
+    std::unordered_map<std::string, WordId> ids;
+    std::vector<std::vector<WordId>> remaps(parts.size());
+    std::vector<std::size_t> token_offsets(parts.size() + 1, 0);
+    std::string w;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+      const Partial& p = parts[i];
+      remaps[i].resize(p.offsets.size() - 1);
+      for (std::size_t id = 0; id + 1 < p.offsets.size(); ++id) {
+        w.assign(p.arena, p.offsets[id], p.offsets[id + 1] - p.offsets[id]);
+        remaps[i][id] = intern(w, global, ids);
+        corpus->max_word_length = std::max(corpus->max_word_length, w.size());
+      }
+      token_offsets[i + 1] = token_offsets[i] + p.tokens.size();
+    }
+
+    corpus->tokens.resize(token_offsets.back());
+    preprocess::for_each_range(ranges, [&](std::size_t i, const preprocess::Range&) {
+      const auto& remap = remaps[i];
+      WordId* dst = corpus->tokens.data() + token_offsets[i];
+      for (WordId local : parts[i].tokens) *dst++ = remap[local];
+    });
+
+    corpus->arena = std::move(global.arena);
+    corpus->word_offsets = std::move(global.offsets);
+    corpus_ = std::move(corpus);
   }
 
-  std::vector<std::string> words_;
+  std::shared_ptr<const Corpus> corpus_;
   std::string path_;
   std::size_t pos_{0};
   int epoch_{0};
@@ -1,20 +1,39 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <htm_flow/config.hpp>
 #include <htm_flow/config_loader.hpp>
 
 #include "encoders/scalar_encoder.hpp"
+#include "encoders/word_hash_encoder.hpp"
 #include "encoders/word_row_encoder.hpp"
+#include "runtime/generator.hpp"
+#include "runtime/metrics_server.hpp"
+#include "runtime/classifier_replicas.hpp"
+#include "runtime/runtime_batch.hpp"
 #include "runtime/text_runtime.hpp"
+#include "text/corpus_cache.hpp"
+#include "text/mapped_text_chunker.hpp"
+#include "text/sharded_corpus.hpp"
 #include "text/text_chunker.hpp"
 #include "text/word_chunker.hpp"
 
+using chat_htm::CorpusCache;
+using chat_htm::MappedTextChunker;
 using chat_htm::ScalarEncoder;
+using chat_htm::StageTimers;
 using chat_htm::TextChunker;
 using chat_htm::TextRuntime;
 using chat_htm::WordChunker;
+using chat_htm::WordHashEncoder;
 using chat_htm::WordRowEncoder;
 
 namespace {
@@ -199,3 +218,666 @@ TEST(TextHTMIntegration, WordRowsModeLearnsSimpleSentenceSequence) {
   EXPECT_GT(snap.active_column_indices.size(), 0u);
   EXPECT_GT(predictive_cells, 0);
 }
+
+TEST(TextHTMIntegration, WordHashModeLearnsSimpleSentenceSequence) {
+  // Input size is independent of word length: every word sets w of n bits.
+  int rows = 10, cols = 10;
+  auto cfg = make_test_config(rows, cols);
+
+  WordHashEncoder::Params ep;
+  ep.n = rows * cols;
+  ep.w = 9;
+  ep.trigram_bits = 3;
+  ep.cache = true;
+  WordHashEncoder enc(ep);
+
+  auto chunker = std::make_unique<WordChunker>(
+      WordChunker::from_string("small cat likes warm milk small dog likes warm soup "));
+  TextRuntime rt(cfg, std::move(chunker), enc, "word_hash");
+  EXPECT_EQ(rt.input_mode(), TextRuntime::InputMode::WordHash);
+  EXPECT_TRUE(rt.word_hash_encoder().has_word_cache());
+
+  rt.step(600);
+  auto snap = rt.region().layer(0).snapshot();
+  EXPECT_EQ(rt.word_chunker().total_steps(), 600u);
+  EXPECT_GT(snap.active_column_indices.size(), 0u);
+}
+
+TEST(TextHTMIntegration, AccuracyIntervalControlsSampling) {
+  int rows = 10, cols = 10;
+  auto cfg = make_test_config(rows, cols);
+  ScalarEncoder::Params ep{.n = rows * cols, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+
+  TextRuntime disabled(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abcabc")),
+                       enc, "no_accuracy");
+  disabled.set_accuracy_interval(0);
+  disabled.step(50);
+  EXPECT_EQ(disabled.prediction_accuracy(), 0.0);
+  EXPECT_EQ(disabled.last_prediction_metrics().active_columns, 0);
+
+  TextRuntime sampled(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abcabc")),
+                      enc, "sampled_accuracy");
+  sampled.set_accuracy_interval(5);
+  sampled.step(50);
+  EXPECT_GT(sampled.last_prediction_metrics().active_columns, 0);
+  EXPECT_LE(sampled.last_prediction_metrics().predicted_active_columns,
+            sampled.last_prediction_metrics().active_columns);
+}
+
+TEST(TextHTMIntegration, MappedChunkerMatchesLoadedContext) {
+  int rows = 10, cols = 10;
+  auto cfg = make_test_config(rows, cols);
+  ScalarEncoder::Params ep{.n = rows * cols, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string path = CHAT_HTM_TEST_DATA_DIR "/hello_world.txt";
+
+  TextRuntime loaded(cfg, std::make_unique<TextChunker>(path), enc, "loaded");
+  TextRuntime mapped(cfg, std::make_unique<MappedTextChunker>(path), enc, "mapped");
+  loaded.step(7);
+  mapped.step(7);
+
+  EXPECT_TRUE(mapped.is_mapped());
+  EXPECT_EQ(mapped.input_size(), loaded.input_size());
+  EXPECT_EQ(mapped.input_total_steps(), 7u);
+  EXPECT_EQ(mapped.last_char(), loaded.last_char());
+  EXPECT_EQ(mapped.input_context(), loaded.input_context());
+}
+
+TEST(TextHTMIntegration, ShardedRuntimeStreamsShardsWithDocumentResets) {
+  int rows = 10, cols = 10;
+  auto cfg = make_test_config(rows, cols);
+  ScalarEncoder::Params ep{.n = rows * cols, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string dir = testing::TempDir() + "chat_htm_shards";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  std::ofstream(dir + "/a.txt") << "abc";
+  std::ofstream(dir + "/b.txt") << "de";
+
+  auto make = [&](bool reset, int prefetch) {
+    auto corpus = std::make_unique<chat_htm::ShardedCorpus>(
+        chat_htm::ShardedCorpus::list_shards(dir), chat_htm::ShardedCorpus::Options{});
+    auto rt = std::make_unique<TextRuntime>(cfg, std::move(corpus), enc, "sharded");
+    rt->set_shard_reset(reset);
+    rt->set_prefetch(prefetch);
+    return rt;
+  };
+
+  auto rt = make(true, 0);
+  ASSERT_TRUE(rt->is_sharded());
+  EXPECT_EQ(rt->input_size(), 3u);
+  rt->step(4);
+  EXPECT_EQ(rt->last_char(), 'd');
+  EXPECT_EQ(rt->shard_switches(), 1u);
+  EXPECT_EQ(rt->input_epoch(), 0);
+  rt->step(1);
+  // Both shards used up: back to the first one in epoch 1, one reset per boundary.
+  EXPECT_EQ(rt->shard_switches(), 2u);
+  EXPECT_EQ(rt->input_epoch(), 1);
+  EXPECT_EQ(rt->input_total_steps(), 5u);
+  EXPECT_EQ(rt->timestep(), 7);
+  EXPECT_LT(rt->total_predictions(), 6);
+  EXPECT_EQ(rt->chunker().path(), dir + "/a.txt");
+
+  auto no_reset = make(false, 0);
+  no_reset->step(5);
+  EXPECT_EQ(no_reset->timestep(), 5);
+
+  auto prefetched = make(true, 4);
+  std::string fed;
+  for (int i = 0; i < 10; ++i) {
+    prefetched->step(1);
+    fed += prefetched->last_char();
+  }
+  EXPECT_EQ(fed, "abcdeabcde");
+  std::filesystem::remove_all(dir);
+}
+
+TEST(TextHTMIntegration, CorpusCacheMatchesUncachedRun) {
+  int rows = 10, cols = 10;
+  auto cfg = make_test_config(rows, cols);
+  ScalarEncoder::Params ep{.n = rows * cols, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string input = CHAT_HTM_TEST_DATA_DIR "/hello_world.txt";
+  const std::string path = testing::TempDir() + "chat_htm_runtime.cache";
+  chat_htm::write_corpus_cache(path, TextChunker(input), enc, {});
+
+  CorpusCache cache(path);
+  TextRuntime loaded(cfg, std::make_unique<TextChunker>(input), enc, "loaded");
+  TextRuntime cached(cfg, cache.character_chunker(), enc, "cached");
+  cached.set_symbol_table(cache.sdr_table());
+  EXPECT_TRUE(cached.has_symbol_table());
+  for (int i = 0; i < 12; ++i) {
+    loaded.step(1);
+    cached.step(1);
+    ASSERT_EQ(cached.last_char(), loaded.last_char()) << "step " << i;
+    ASSERT_EQ(cached.snapshot().active_column_indices, loaded.snapshot().active_column_indices)
+        << "step " << i;
+  }
+  std::remove(path.c_str());
+}
+
+TEST(TextHTMIntegration, ProgressRecordCapturesCursorAndCounters) {
+  int rows = 10, cols = 10;
+  auto cfg = make_test_config(rows, cols);
+  ScalarEncoder::Params ep{.n = rows * cols, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string input = CHAT_HTM_TEST_DATA_DIR "/hello_world.txt";
+  const std::string path = testing::TempDir() + "chat_htm_runtime.progress";
+
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(input), enc, "rt");
+  rt.step(static_cast<int>(rt.input_size()) + 3);
+  const auto record = rt.progress();
+  EXPECT_EQ(record.input_size, rt.input_size());
+  EXPECT_EQ(record.position, rt.input_total_steps() % rt.input_size());
+  EXPECT_EQ(record.epoch, rt.input_epoch());
+  EXPECT_EQ(record.total_steps, rt.input_total_steps());
+  EXPECT_EQ(record.region_timestep, rt.timestep());
+  EXPECT_EQ(record.correct_predictions, rt.correct_predictions());
+  EXPECT_EQ(record.total_predictions, rt.total_predictions());
+
+  // Without the classifier on, a progress file has nothing to reuse.
+  TextRuntime other(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abc")), enc);
+  rt.save_progress(path);
+  EXPECT_FALSE(other.load_classifier(path));
+  std::remove(path.c_str());
+}
+
+TEST(TextHTMIntegration, ClassifierReplicasMergeOnlyClassifierCounts) {
+  int rows = 10, cols = 10;
+  auto cfg = make_test_config(rows, cols);
+  ScalarEncoder::Params ep{.n = rows * cols, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string path = testing::TempDir() + "chat_htm_replicas.progress";
+
+  chat_htm::ClassifierReplicas replicas({.merge_every = 4, .threads = 2});
+  for (const char* text : {"abcabcabc", "xyzxyzxyz"}) {
+    auto rt = std::make_unique<TextRuntime>(
+        cfg, std::make_unique<TextChunker>(TextChunker::from_string(text)), enc);
+    rt->set_classifier(1);
+    replicas.add(std::move(rt));
+  }
+  auto off = std::make_unique<TextRuntime>(
+      cfg, std::make_unique<TextChunker>(TextChunker::from_string("abc")), enc);
+  EXPECT_THROW(replicas.add(std::move(off)), std::invalid_argument);
+
+  replicas.run(10);
+  EXPECT_EQ(replicas.merges(), 3u);
+  // The merged classifier holds what each replica saw on its own slice.
+  const auto& merged = replicas.merged();
+  std::uint64_t a = 0, x = 0;
+  for (std::size_t c = 0; c < merged.num_columns(); ++c) {
+    a += merged.count(c, 'a');
+    x += merged.count(c, 'x');
+  }
+  EXPECT_GT(a, 0u);
+  EXPECT_GT(x, 0u);
+  for (std::size_t i = 0; i < replicas.size(); ++i) {
+    EXPECT_EQ(replicas.replica(i).classifier().observations(), merged.observations());
+  }
+  // Nothing new since the last merge, so merging again adds nothing.
+  const auto observations = merged.observations();
+  replicas.merge();
+  EXPECT_EQ(replicas.merged().observations(), observations);
+
+  replicas.replica(0).save_progress(path);
+  TextRuntime fresh(cfg, std::make_unique<TextChunker>(TextChunker::from_string("other")), enc);
+  fresh.set_classifier(1);
+  ASSERT_TRUE(fresh.load_classifier(path));
+  EXPECT_EQ(fresh.classifier().observations(), replicas.merged().observations());
+  std::remove(path.c_str());
+}
+
+TEST(TextHTMIntegration, ClassifierReplicasStartFromIdenticalRegions) {
+  // The classifier merge assumes replicas of one config share their initial
+  // connectivity, i.e. that htm_flow builds a layer deterministically.
+  auto cfg = make_test_config(10, 10);
+  cfg.layers.push_back(cfg.layers.front());
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string text = "the quick brown fox jumps over the lazy dog";
+  TextRuntime a(cfg, std::make_unique<TextChunker>(TextChunker::from_string(text)), enc, "a");
+  TextRuntime b(cfg, std::make_unique<TextChunker>(TextChunker::from_string(text)), enc, "b");
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    a.step(1);
+    b.step(1);
+    ASSERT_EQ(a.region().layer(0).snapshot().active_column_indices,
+              b.region().layer(0).snapshot().active_column_indices)
+        << "step " << i;
+  }
+}
+
+TEST(TextHTMIntegration, FreezePermanencesZeroesEveryPlasticityRate) {
+  htm_flow::HTMRegionConfig cfg = make_test_config(10, 10);
+  cfg.layers.push_back(cfg.layers.front());
+  // As in default_text.yaml: an active-column decrement on layer 0 and
+  // temporal pooling, with its own rates, on layer 1.
+  cfg.layers[0].active_col_permanence_dec = 0.05f;
+  cfg.layers[1].temp_enabled = true;
+  cfg.layers[1].temp_spatial_permanence_inc = 0.01f;
+  cfg.layers[1].temp_sequence_permanence_inc = 0.01f;
+  cfg.layers[1].temp_sequence_permanence_dec = 0.01f;
+  EXPECT_FALSE(chat_htm::permanences_frozen(cfg));
+
+  // Either of those rates alone still adapts permanences.
+  auto active_col_only = cfg;
+  chat_htm::freeze_permanences(active_col_only);
+  active_col_only.layers[0].active_col_permanence_dec = 0.05f;
+  EXPECT_FALSE(chat_htm::permanences_frozen(active_col_only));
+  auto pooling_only = cfg;
+  chat_htm::freeze_permanences(pooling_only);
+  pooling_only.layers[1].temp_sequence_permanence_inc = 0.01f;
+  EXPECT_FALSE(chat_htm::permanences_frozen(pooling_only));
+
+  chat_htm::freeze_permanences(cfg);
+  EXPECT_TRUE(chat_htm::permanences_frozen(cfg));
+  for (const auto& layer : cfg.layers) {
+    EXPECT_EQ(layer.spatial_permanence_inc, 0.0f);
+    EXPECT_EQ(layer.spatial_permanence_dec, 0.0f);
+    EXPECT_EQ(layer.active_col_permanence_dec, 0.0f);
+    EXPECT_EQ(layer.sequence_permanence_inc, 0.0f);
+    EXPECT_EQ(layer.sequence_permanence_dec, 0.0f);
+    EXPECT_EQ(layer.temp_spatial_permanence_inc, 0.0f);
+    EXPECT_EQ(layer.temp_sequence_permanence_inc, 0.0f);
+    EXPECT_EQ(layer.temp_sequence_permanence_dec, 0.0f);
+  }
+  EXPECT_TRUE(cfg.layers[1].temp_enabled) << "freezing leaves pooling itself on";
+
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  TextRuntime runtime(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abcabc")),
+                      ScalarEncoder(ep), "frozen");
+  EXPECT_TRUE(runtime.permanences_frozen());
+  runtime.step(12);
+  EXPECT_EQ(runtime.input_total_steps(), 12u);
+}
+
+TEST(TextHTMIntegration, BatchStepsStreamsIndependently) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::vector<std::string> docs = {"the quick brown fox", "hello hello", "abcdefg", "zz"};
+
+  chat_htm::TextRuntimeBatch batch(3);
+  std::vector<std::unique_ptr<TextRuntime>> serial;
+  for (const auto& d : docs) {
+    batch.add(std::make_unique<TextRuntime>(
+        cfg, std::make_unique<TextChunker>(TextChunker::from_string(d)), enc));
+    serial.push_back(std::make_unique<TextRuntime>(
+        cfg, std::make_unique<TextChunker>(TextChunker::from_string(d)), enc));
+  }
+  ASSERT_EQ(batch.size(), docs.size());
+
+  batch.step(9);
+  for (auto& s : serial) s->step(9);
+  double mean = 0.0;
+  for (std::size_t i = 0; i < docs.size(); ++i) {
+    EXPECT_EQ(batch.stream(i).input_total_steps(), 9u);
+    EXPECT_EQ(batch.stream(i).last_char(), serial[i]->last_char()) << "stream " << i;
+    EXPECT_EQ(batch.stream(i).snapshot().active_column_indices,
+              serial[i]->snapshot().active_column_indices) << "stream " << i;
+    mean += serial[i]->prediction_accuracy();
+  }
+  EXPECT_DOUBLE_EQ(batch.mean_accuracy(), mean / static_cast<double>(docs.size()));
+  EXPECT_THROW(batch.add(nullptr), std::invalid_argument);
+
+  // The pool outlives a step; single steps reuse it and stay in lockstep.
+  EXPECT_EQ(batch.pool_size(), 2u);
+  for (int i = 0; i < 20; ++i) batch.step(1);
+  for (auto& s : serial) s->step(20);
+  EXPECT_EQ(batch.pool_size(), 2u);
+  for (std::size_t i = 0; i < docs.size(); ++i) {
+    EXPECT_EQ(batch.stream(i).last_char(), serial[i]->last_char()) << "stream " << i;
+  }
+  // A stream added later regroups the pool.
+  batch.add(std::make_unique<TextRuntime>(
+      cfg, std::make_unique<TextChunker>(TextChunker::from_string("xy")), enc));
+  batch.step(3);
+  EXPECT_EQ(batch.stream(docs.size()).input_total_steps(), 3u);
+  EXPECT_EQ(batch.pool_size(), 2u);
+}
+
+TEST(TextHTMIntegration, PrefetchMatchesUnpipelinedStepping) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string input = CHAT_HTM_TEST_DATA_DIR "/hello_world.txt";
+
+  TextRuntime plain(cfg, std::make_unique<TextChunker>(input), enc, "plain");
+  TextRuntime piped(cfg, std::make_unique<TextChunker>(input), enc, "piped");
+  piped.set_prefetch(8);
+  EXPECT_EQ(piped.prefetch(), 8);
+  const int steps = static_cast<int>(plain.input_size()) + 17;
+  for (int i = 0; i < steps; ++i) {
+    plain.step(1);
+    piped.step(1);
+    ASSERT_EQ(piped.last_char(), plain.last_char()) << "step " << i;
+    ASSERT_EQ(piped.snapshot().active_column_indices, plain.snapshot().active_column_indices);
+  }
+  EXPECT_EQ(piped.input_epoch(), plain.input_epoch());
+  EXPECT_EQ(piped.input_context(), plain.input_context());
+  EXPECT_EQ(piped.input_total_steps(), plain.input_total_steps());
+}
+
+TEST(TextHTMIntegration, PrefetchWordMode) {
+  int rows = 5, letter_bits = 2;
+  WordRowEncoder::Params wp;
+  wp.rows = rows;
+  wp.letter_bits = letter_bits;
+  wp.cols = letter_bits * 27;
+  auto cfg = make_test_config(rows, wp.cols);
+  const std::string text = "the cat sat on the mat and the dog sat too";
+
+  TextRuntime plain(cfg, std::make_unique<WordChunker>(WordChunker::from_string(text)),
+                    WordRowEncoder(wp), "plain");
+  TextRuntime piped(cfg, std::make_unique<WordChunker>(WordChunker::from_string(text)),
+                    WordRowEncoder(wp), "piped");
+  piped.set_prefetch(4);
+  for (int i = 0; i < 25; ++i) {
+    plain.step(1);
+    piped.step(1);
+    ASSERT_EQ(piped.last_word(), plain.last_word()) << "step " << i;
+  }
+  piped.set_prefetch(0);
+  piped.step(1);
+  plain.step(1);
+  EXPECT_EQ(piped.last_word(), plain.last_word());
+}
+
+TEST(TextHTMIntegration, LayerPipelineRunsUpperLayersOneStepBehind) {
+  auto cfg = make_test_config(10, 10);
+  auto upper = cfg.layers.front();
+  upper.num_input_rows = upper.num_column_rows;
+  upper.num_input_cols = upper.num_column_cols * upper.cells_per_column;
+  cfg.layers.push_back(upper);
+  cfg.layers.push_back(upper);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string input = CHAT_HTM_TEST_DATA_DIR "/hello_world.txt";
+
+  TextRuntime plain(cfg, std::make_unique<TextChunker>(input), enc, "plain");
+  TextRuntime piped(cfg, std::make_unique<TextChunker>(input), enc, "piped");
+  piped.set_layer_pipeline(true);
+  ASSERT_TRUE(piped.layer_pipeline());
+
+  const int steps = 20;
+  plain.step(steps);
+  piped.step(steps);
+  EXPECT_EQ(piped.timestep(), steps);
+  // Layer 0 is unaffected by the pipeline.
+  EXPECT_EQ(piped.region().layer(0).snapshot().active_column_indices,
+            plain.region().layer(0).snapshot().active_column_indices);
+
+  // Layer k has processed k fewer inputs than layer 0.
+  TextRuntime lagged(cfg, std::make_unique<TextChunker>(input), enc, "lagged");
+  lagged.step(steps - 1);
+  EXPECT_EQ(piped.region().layer(1).snapshot().active_column_indices,
+            lagged.region().layer(1).snapshot().active_column_indices);
+  TextRuntime lagged2(cfg, std::make_unique<TextChunker>(input), enc, "lagged2");
+  lagged2.step(steps - 2);
+  EXPECT_EQ(piped.region().layer(2).snapshot().active_column_indices,
+            lagged2.region().layer(2).snapshot().active_column_indices);
+
+  piped.set_layer_pipeline(false);
+  piped.step(1);
+  EXPECT_EQ(piped.timestep(), steps + 1);
+}
+
+TEST(TextHTMIntegration, StageTimersCountEveryStep) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(CHAT_HTM_TEST_DATA_DIR "/hello_world.txt"),
+                 enc, "timed");
+  rt.step(3);  // Disabled: nothing recorded.
+  EXPECT_EQ(rt.timers()[StageTimers::kRegionStep].count(), 0u);
+
+  rt.timers().set_enabled(true);
+  rt.set_accuracy_interval(2);
+  rt.step(10);
+  EXPECT_EQ(rt.timers()[StageTimers::kRead].count(), 10u);
+  EXPECT_EQ(rt.timers()[StageTimers::kEncode].count(), 10u);
+  EXPECT_EQ(rt.timers()[StageTimers::kSetInput].count(), 10u);
+  EXPECT_EQ(rt.timers()[StageTimers::kRegionStep].count(), 10u);
+  EXPECT_EQ(rt.timers()[StageTimers::kPrefetchWait].count(), 0u);
+  EXPECT_GT(rt.timers()[StageTimers::kAccuracy].count(), 0u);
+  EXPECT_LE(rt.timers()[StageTimers::kAccuracy].count(), 5u);
+  EXPECT_GT(rt.timers()[StageTimers::kRegionStep].total_ns(), 0u);
+}
+
+TEST(TextHTMIntegration, StepLogSamplesStepsWithContext) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string path = testing::TempDir() + "chat_htm_runtime_log.csv";
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(CHAT_HTM_TEST_DATA_DIR "/hello_world.txt"),
+                 enc, "logged");
+  chat_htm::StepLogger::Options opts;
+  opts.format = chat_htm::StepLogger::Format::Csv;
+  opts.path = path;
+  opts.every = 3;
+  rt.set_step_log(opts);
+  ASSERT_TRUE(rt.log_text());
+
+  std::vector<std::string> contexts;
+  for (int i = 1; i <= 12; ++i) {
+    rt.step(1);
+    if (i % 3 == 0) contexts.push_back(rt.input_context());
+  }
+  rt.flush_log();
+  rt.set_log_text(false);
+  EXPECT_FALSE(rt.log_text());
+
+  std::ifstream f(path);
+  std::string line;
+  std::getline(f, line);  // Header.
+  std::size_t rows = 0;
+  while (std::getline(f, line)) {
+    ASSERT_LT(rows, contexts.size());
+    EXPECT_EQ(line.substr(0, line.find(',')), std::to_string(3 * (rows + 1)));
+    EXPECT_NE(line.find("\"" + contexts[rows] + "\""), std::string::npos) << line;
+    ++rows;
+  }
+  EXPECT_EQ(rows, contexts.size());
+  std::remove(path.c_str());
+}
+
+TEST(TextHTMIntegration, ClassifierPredictsFromAlphabetWithoutChangingAccuracy) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  const std::string text = "abcabcabcabcabcabc";
+  TextRuntime plain(cfg, std::make_unique<TextChunker>(TextChunker::from_string(text)), enc);
+  TextRuntime classified(cfg, std::make_unique<TextChunker>(TextChunker::from_string(text)), enc);
+  classified.set_classifier(2);
+
+  plain.step(40);
+  classified.step(40);
+  // The accuracy sample reuses the classifier's snapshot; results must match.
+  EXPECT_DOUBLE_EQ(classified.prediction_accuracy(), plain.prediction_accuracy());
+  EXPECT_EQ(classified.last_prediction_metrics().active_columns,
+            plain.last_prediction_metrics().active_columns);
+
+  EXPECT_GT(classified.classifier().observations(), 0u);
+  EXPECT_LE(classified.predictions().size(), 2u);
+  for (const auto& p : classified.predictions()) {
+    const std::string s = classified.symbol_text(p.symbol);
+    EXPECT_NE(std::string("abc").find(s), std::string::npos) << s;
+    EXPECT_GT(p.score, 0.0f);
+    EXPECT_LE(p.score, 1.0f);
+  }
+  EXPECT_GE(classified.classifier_accuracy(), 0.0);
+  EXPECT_LE(classified.classifier_accuracy(), 1.0);
+  EXPECT_TRUE(plain.predictions().empty());
+}
+
+TEST(TextHTMIntegration, FeedStepsRegionWithoutMovingCursorOrCounters) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abcabcabc")), enc);
+  rt.set_classifier(2);
+  rt.step(30);
+  const auto pos = rt.chunker().position();
+  const auto total = rt.chunker().total_steps();
+  const double accuracy = rt.prediction_accuracy();
+  const auto observations = rt.classifier().observations();
+  const std::int64_t t = rt.timestep();
+
+  for (std::uint32_t s : rt.text_symbols("ab")) rt.feed(s);
+  EXPECT_EQ(rt.timestep(), t + 2);
+  EXPECT_EQ(rt.last_char(), 'b');
+  EXPECT_EQ(rt.chunker().position(), pos);
+  EXPECT_EQ(rt.chunker().total_steps(), total);
+  EXPECT_DOUBLE_EQ(rt.prediction_accuracy(), accuracy);
+  EXPECT_EQ(rt.classifier().observations(), observations);  // No learning.
+  EXPECT_LE(rt.predictions().size(), 2u);
+  EXPECT_THROW(rt.feed(256), std::invalid_argument);
+}
+
+TEST(TextHTMIntegration, GenerateFeedsBackTopPrediction) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  {
+    TextRuntime learning(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abc")), enc);
+    learning.set_classifier(1);
+    EXPECT_THROW(chat_htm::generate(learning, "a", {}), std::invalid_argument);
+    chat_htm::GenerateOptions allow;
+    allow.allow_region_learning = true;
+    EXPECT_NO_THROW(chat_htm::generate(learning, "a", allow));
+  }
+
+  // A frozen region still trains the classifier it decodes with.
+  chat_htm::freeze_permanences(cfg);
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abcabcabc")), enc);
+  EXPECT_THROW(chat_htm::generate(rt, "a", {}), std::invalid_argument);
+
+  rt.set_classifier(1);
+  EXPECT_TRUE(rt.classifier_learning());
+  rt.step(60);
+  EXPECT_GT(rt.classifier().observations(), 0u);
+  chat_htm::GenerateOptions opts;
+  opts.tokens = 8;
+  opts.budget_ns = 1;  // Every real token is slower than 1ns.
+  const auto g = chat_htm::generate(rt, "ab", opts);
+  EXPECT_EQ(g.prompt.size(), 2u);
+  EXPECT_LE(g.symbols.size(), 8u);
+  if (!g.stalled) {
+    EXPECT_EQ(g.symbols.size(), 8u);
+  }
+  EXPECT_EQ(g.latency.count(), g.symbols.size());
+  EXPECT_EQ(g.over_budget, g.symbols.size());
+  EXPECT_EQ(g.text.size(), g.symbols.size());
+  for (char c : g.text) EXPECT_NE(std::string("abc").find(c), std::string::npos) << c;
+}
+
+TEST(TextHTMIntegration, TextSymbolsUsesWordVocabulary) {
+  const int rows = 5, cols = 108;
+  auto cfg = make_test_config(rows, cols);
+  WordRowEncoder::Params ep;
+  ep.rows = rows;
+  ep.cols = cols;
+  ep.letter_bits = 4;
+  ep.alphabet = "abcdefghijklmnopqrstuvwxyz";
+  TextRuntime rt(cfg, std::make_unique<WordChunker>(WordChunker::from_string("small cat likes milk")),
+                 WordRowEncoder(ep));
+  const auto ids = rt.text_symbols("Small, unknown CAT!");
+  ASSERT_EQ(ids.size(), 2u);
+  EXPECT_EQ(rt.symbol_text(ids[0]), "small");
+  EXPECT_EQ(rt.symbol_text(ids[1]), "cat");
+  rt.feed(ids[1]);
+  EXPECT_EQ(rt.last_word(), "cat");
+  EXPECT_THROW(rt.feed(99), std::invalid_argument);
+}
+
+TEST(TextHTMIntegration, SnapshotDeltasReproduceFullSnapshots) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(TextChunker::from_string("hello world ")), enc);
+
+  htm_gui::Snapshot view;
+  std::uint64_t seen = 0;
+  for (int i = 0; i < 12; ++i) {
+    rt.step(1 + i % 3);
+    const auto& d = rt.snapshot_delta(seen);
+    EXPECT_EQ(d.full, i == 0);
+    EXPECT_EQ(d.version, rt.snapshot_version());
+    d.apply(view);
+    seen = d.version;
+
+    auto full = rt.snapshot();
+    std::sort(full.active_column_indices.begin(), full.active_column_indices.end());
+    EXPECT_EQ(view.active_column_indices, full.active_column_indices);
+    ASSERT_EQ(view.column_cell_masks.size(), full.column_cell_masks.size());
+    for (std::size_t c = 0; c < full.column_cell_masks.size(); ++c) {
+      EXPECT_EQ(view.column_cell_masks[c].active, full.column_cell_masks[c].active);
+      EXPECT_EQ(view.column_cell_masks[c].predictive, full.column_cell_masks[c].predictive);
+    }
+  }
+  // No step since the last delta: nothing to send.
+  EXPECT_TRUE(rt.snapshot_delta(seen).columns.empty());
+}
+
+TEST(TextHTMIntegration, DistalPagesStayWithinSegmentCount) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abcabc")), enc);
+  rt.step(10);
+  const int total = rt.num_segments(0, 0, 0);
+  const auto page = rt.query_distal_page(0, 0, 0, 0, 4);
+  EXPECT_EQ(page.total_segments, total);
+  EXPECT_EQ(page.segments.size(), static_cast<std::size_t>(std::min(total, 4)));
+  EXPECT_TRUE(rt.query_distal_page(0, 0, 0, total, 4).segments.empty());
+  EXPECT_TRUE(rt.query_distal_page(0, 0, 0, 0, 0).segments.empty());
+}
+
+TEST(TextHTMIntegration, MetricsServerPublishesRuntimeState) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abcabc")), enc);
+  chat_htm::MetricsServer::Options opts;
+  opts.window_steps = 10;
+  chat_htm::MetricsServer server(opts, rt.num_layers());
+
+  for (int i = 0; i < 5; ++i) {
+    rt.step(10);
+    server.publish(rt);
+  }
+  const auto& m = server.metrics();
+  EXPECT_EQ(m.steps.load(), 50);
+  EXPECT_EQ(m.epoch.load(), rt.input_epoch());
+  EXPECT_DOUBLE_EQ(m.accuracy.load(), rt.prediction_accuracy());
+  EXPECT_EQ(m.window_samples.load(), 10);  // Only the last 10 steps count.
+  EXPECT_GE(m.window_accuracy.load(), 0.0);
+  EXPECT_LE(m.window_accuracy.load(), 1.0);
+  EXPECT_EQ(m.active_columns[0].load(),
+            static_cast<int>(rt.region().layer(0).snapshot().active_column_indices.size()));
+}
+
+TEST(TextHTMIntegration, AccuracyTrackerMatchesCumulativeCounters) {
+  auto cfg = make_test_config(10, 10);
+  ScalarEncoder::Params ep{.n = 100, .w = 9, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(ep);
+  TextRuntime rt(cfg, std::make_unique<TextChunker>(TextChunker::from_string("abcd")), enc);
+  rt.set_accuracy_window(6);
+  rt.step(20);  // 5 epochs; the first step has nothing to measure.
+
+  const auto& t = rt.accuracy_tracker();
+  EXPECT_EQ(t.samples(), static_cast<std::uint64_t>(rt.total_predictions()));
+  EXPECT_DOUBLE_EQ(t.accuracy(), rt.prediction_accuracy());
+  EXPECT_TRUE(t.window_full());
+  // Samples measure the symbol fed on the step before, so the last
+  // epoch's final symbol is still unmeasured.
+  ASSERT_EQ(t.per_epoch().size(), 5u);
+  EXPECT_EQ(t.per_epoch()[0].total, 4u);
+  EXPECT_EQ(t.per_epoch()[4].total, 3u);
+  std::uint64_t by_symbol = 0;
+  for (char c : std::string("abcd")) by_symbol += t.per_symbol()[static_cast<unsigned char>(c)].total;
+  EXPECT_EQ(by_symbol, t.samples());
+  EXPECT_EQ(t.per_symbol()['d'].total, 4u);
+  EXPECT_EQ(t.per_symbol()['a'].total, 5u);
+}
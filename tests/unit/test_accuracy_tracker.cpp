@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "runtime/accuracy_tracker.hpp"
+
+using chat_htm::AccuracyTracker;
+
+TEST(AccuracyTracker, EmptyTrackerReportsZero) {
+  AccuracyTracker t(4);
+  EXPECT_EQ(t.samples(), 0u);
+  EXPECT_DOUBLE_EQ(t.accuracy(), 0.0);
+  EXPECT_DOUBLE_EQ(t.window_accuracy(), 0.0);
+  EXPECT_FALSE(t.window_full());
+  EXPECT_FALSE(t.plateaued(1.0));
+}
+
+TEST(AccuracyTracker, WindowForgetsOldSamples) {
+  AccuracyTracker t(4);
+  for (int i = 0; i < 4; ++i) t.record(false, 0, 0);
+  EXPECT_TRUE(t.window_full());
+  EXPECT_DOUBLE_EQ(t.window_accuracy(), 0.0);
+  for (int i = 0; i < 3; ++i) t.record(true, 0, 0);
+  EXPECT_DOUBLE_EQ(t.window_accuracy(), 0.75);
+  t.record(true, 0, 0);
+  EXPECT_DOUBLE_EQ(t.window_accuracy(), 1.0);
+  EXPECT_DOUBLE_EQ(t.accuracy(), 0.5);  // Cumulative still remembers.
+}
+
+TEST(AccuracyTracker, EmaStartsAtFirstSampleAndMovesByAlpha) {
+  AccuracyTracker t(8, 0.5);
+  t.record(true, 0, 0);
+  EXPECT_DOUBLE_EQ(t.ema(), 1.0);
+  t.record(false, 0, 0);
+  EXPECT_DOUBLE_EQ(t.ema(), 0.5);
+  t.record(false, 0, 0);
+  EXPECT_DOUBLE_EQ(t.ema(), 0.25);
+}
+
+TEST(AccuracyTracker, BreaksDownByEpochAndSymbol) {
+  AccuracyTracker t(16);
+  t.record(true, 0, 'a');
+  t.record(false, 0, 'b');
+  t.record(true, 2, 'a');
+  ASSERT_EQ(t.per_epoch().size(), 3u);
+  EXPECT_DOUBLE_EQ(t.per_epoch()[0].accuracy(), 0.5);
+  EXPECT_EQ(t.per_epoch()[1].total, 0u);
+  EXPECT_EQ(t.per_epoch()[2].correct, 1u);
+  EXPECT_EQ(t.per_symbol()['a'].total, 2u);
+  EXPECT_DOUBLE_EQ(t.per_symbol()['a'].accuracy(), 1.0);
+  EXPECT_DOUBLE_EQ(t.per_symbol()['b'].accuracy(), 0.0);
+}
+
+TEST(AccuracyTracker, PlateauNeedsTwoStableWindows) {
+  AccuracyTracker t(4);
+  for (int i = 0; i < 4; ++i) t.record(i % 2 == 0, 0, 0);  // Window 1: 50%.
+  EXPECT_FALSE(t.plateaued(0.01));
+  for (int i = 0; i < 4; ++i) t.record(true, 0, 0);  // Window 2: 100%.
+  EXPECT_FALSE(t.plateaued(0.01));
+  for (int i = 0; i < 4; ++i) t.record(true, 0, 0);  // Window 3: 100%.
+  EXPECT_TRUE(t.plateaued(0.01));
+  t.reset();
+  EXPECT_EQ(t.samples(), 0u);
+  EXPECT_EQ(t.window_size(), 4u);
+  EXPECT_FALSE(t.plateaued(0.01));
+}
+
+TEST(AccuracyTracker, RejectsBadParameters) {
+  EXPECT_THROW(AccuracyTracker(0), std::invalid_argument);
+  EXPECT_THROW(AccuracyTracker(4, 0.0), std::invalid_argument);
+  EXPECT_THROW(AccuracyTracker(4, 1.5), std::invalid_argument);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "config/chat_htm_config.hpp"
+
+using chat_htm::ChatHtmConfig;
+using chat_htm::TextMode;
+
+namespace {
+
+const std::string kConfigDir = CHAT_HTM_TEST_DATA_DIR "/../../configs/";
+
+/// A one-layer htm_flow config with the given extra chat_htm sections.
+std::string write_config(const std::string& name, const std::string& sections) {
+  const std::string path = testing::TempDir() + name;
+  std::ofstream f(path);
+  f << sections << "\n"
+    << "layers:\n"
+    << "  - name: L0\n"
+    << "    input: {rows: 10, cols: 10}\n"
+    << "    columns: {rows: 10, cols: 20}\n";
+  return path;
+}
+
+}  // namespace
+
+TEST(ChatHtmConfig, LoadsShippedCharacterConfig) {
+  const auto cfg = ChatHtmConfig::load(kConfigDir + "small_text.yaml");
+  EXPECT_EQ(cfg.text_mode, TextMode::Character);
+  ASSERT_FALSE(cfg.region.layers.empty());
+  EXPECT_EQ(cfg.scalar.n, cfg.input_bits());
+  EXPECT_EQ(cfg.scalar.w, 9);
+  EXPECT_TRUE(cfg.scalar.cache);
+  EXPECT_FALSE(cfg.enable_feedback);
+  EXPECT_EQ(cfg.worker_threads, 0);
+}
+
+TEST(ChatHtmConfig, LoadsShippedWordRowsConfig) {
+  const auto cfg = ChatHtmConfig::load(kConfigDir + "word_rows_text.yaml");
+  EXPECT_EQ(cfg.text_mode, TextMode::WordRows);
+  EXPECT_EQ(cfg.word_rows.rows, cfg.region.layers[0].num_input_rows);
+  EXPECT_EQ(cfg.word_rows.cols, cfg.region.layers[0].num_input_cols);
+  EXPECT_EQ(cfg.word_rows.letter_bits, 8);
+}
+
+TEST(ChatHtmConfig, LoadsShippedWordHashConfig) {
+  const auto cfg = ChatHtmConfig::load(kConfigDir + "word_hash_text.yaml");
+  EXPECT_EQ(cfg.text_mode, TextMode::WordHash);
+  EXPECT_EQ(cfg.word_hash.n, cfg.input_bits());
+  EXPECT_EQ(cfg.word_hash.w, 20);
+  EXPECT_EQ(cfg.word_hash.trigram_bits, 8);
+  EXPECT_TRUE(cfg.word_hash.cache);
+}
+
+TEST(ChatHtmConfig, RejectsWordHashTrigramsAboveActiveBits) {
+  const auto path = write_config("chat_htm_cfg_hash.yaml",
+                                 "text: {mode: word_hash}\n"
+                                 "encoder: {active_bits: 4, trigram_bits: 5}");
+  EXPECT_THROW(ChatHtmConfig::load(path), std::invalid_argument);
+  std::remove(path.c_str());
+}
+
+TEST(ChatHtmConfig, ReadsEverySection) {
+  const auto path = write_config("chat_htm_cfg_all.yaml",
+                                 "text: {mode: character, lowercase: true, ascii_only: true}\n"
+                                 "encoder: {active_bits: 7, min_value: 32, max_value: 126}\n"
+                                 "gui: {theme: dark}\n"
+                                 "worker_threads: 3\n"
+                                 "enable_feedback: true");
+  const auto cfg = ChatHtmConfig::load(path);
+  EXPECT_TRUE(cfg.normalization.lowercase);
+  EXPECT_TRUE(cfg.normalization.ascii_only);
+  EXPECT_EQ(cfg.scalar.w, 7);
+  EXPECT_EQ(cfg.scalar.min_val, 32);
+  EXPECT_EQ(cfg.scalar.max_val, 126);
+  EXPECT_EQ(cfg.gui_theme, "dark");
+  EXPECT_TRUE(cfg.enable_feedback);
+  EXPECT_EQ(cfg.worker_threads, 3);
+  std::remove(path.c_str());
+}
+
+TEST(ChatHtmConfig, RejectsInvalidValuesAtLoad) {
+  auto path = write_config("chat_htm_cfg_bad.yaml", "text: {mode: sentences}");
+  EXPECT_THROW(ChatHtmConfig::load(path), std::invalid_argument);
+  path = write_config("chat_htm_cfg_bad.yaml", "gui: {theme: purple}");
+  EXPECT_THROW(ChatHtmConfig::load(path), std::invalid_argument);
+  path = write_config("chat_htm_cfg_bad.yaml", "encoder: {active_bits: 500}");  // w > n
+  EXPECT_THROW(ChatHtmConfig::load(path), std::invalid_argument);
+  path = write_config("chat_htm_cfg_bad.yaml", "worker_threads: -2");
+  EXPECT_THROW(ChatHtmConfig::load(path), std::invalid_argument);
+  path = write_config("chat_htm_cfg_bad.yaml", "threads: 2");  // Renamed.
+  EXPECT_THROW(ChatHtmConfig::load(path), std::invalid_argument);
+  path = write_config("chat_htm_cfg_bad.yaml", "encoder: {active_bits: lots}");
+  EXPECT_THROW(ChatHtmConfig::load(path), std::runtime_error);
+  std::remove(path.c_str());
+  EXPECT_THROW(ChatHtmConfig::load(testing::TempDir() + "missing.yaml"), std::runtime_error);
+}
+
+TEST(ChatHtmConfig, FromRegionNeedsNoYaml) {
+  htm_flow::HTMRegionConfig region;
+  region.layers.emplace_back();
+  region.layers[0].num_input_rows = 4;
+  region.layers[0].num_input_cols = 25;
+  auto cfg = ChatHtmConfig::from_region(region);
+  EXPECT_EQ(cfg.scalar.n, 100);
+  EXPECT_EQ(cfg.text_mode, TextMode::Character);
+
+  cfg.region.layers[0].num_input_cols = 50;
+  cfg.fit_encoders_to_input();
+  EXPECT_EQ(cfg.scalar.n, 200);
+
+  EXPECT_THROW(ChatHtmConfig::from_region({}), std::invalid_argument);
+  // Default word-row encoder needs cols == letter_bits * 27.
+  EXPECT_THROW(ChatHtmConfig::from_region(region, TextMode::WordRows), std::invalid_argument);
+}
+
+TEST(ChatHtmConfig, TextModeNames) {
+  EXPECT_EQ(chat_htm::parse_text_mode("word_rows"), TextMode::WordRows);
+  EXPECT_EQ(chat_htm::parse_text_mode("word_hash"), TextMode::WordHash);
+  EXPECT_STREQ(chat_htm::text_mode_name(TextMode::WordHash), "word_hash");
+  EXPECT_STREQ(chat_htm::text_mode_name(TextMode::Character), "character");
+  EXPECT_THROW(chat_htm::parse_text_mode("bytes"), std::invalid_argument);
+}
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "runtime/column_kernels.hpp"
+
+namespace column_kernels = chat_htm::column_kernels;
+
+namespace {
+
+/// Column masks with random active/predictive bits.
+std::vector<htm_gui::ColumnCellMasks> random_masks(std::size_t n, std::mt19937& rng) {
+  std::uniform_int_distribution<std::uint32_t> cells(0, 0x3f);
+  std::bernoulli_distribution predictive(0.3);
+  std::vector<htm_gui::ColumnCellMasks> masks(n);
+  for (auto& m : masks) {
+    m.active = cells(rng);
+    m.predictive = predictive(rng) ? cells(rng) : 0;
+  }
+  return masks;
+}
+
+}  // namespace
+
+TEST(ColumnKernels, PackPredictiveMatchesReference) {
+  std::mt19937 rng(7);
+  for (std::size_t n : {std::size_t{1}, std::size_t{63}, std::size_t{64}, std::size_t{200},
+                        std::size_t{1024}}) {
+    const auto masks = random_masks(n, rng);
+    std::vector<std::uint64_t> words((n + 63) / 64, ~std::uint64_t{0});
+    column_kernels::pack_predictive(masks.data(), n, words.data());
+    for (std::size_t c = 0; c < n; ++c) {
+      EXPECT_EQ(((words[c / 64] >> (c % 64)) & 1u) != 0, masks[c].predictive != 0) << c;
+    }
+    if (n % 64 != 0) {
+      EXPECT_EQ(words.back() >> (n % 64), 0u) << "tail bits must stay zero";
+    }
+  }
+}
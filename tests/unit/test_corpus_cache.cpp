@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "text/corpus_cache.hpp"
+
+using chat_htm::CorpusCache;
+using chat_htm::CorpusKind;
+using chat_htm::ScalarEncoder;
+using chat_htm::TextChunker;
+using chat_htm::TextNormalization;
+using chat_htm::WordChunker;
+using chat_htm::WordHashEncoder;
+using chat_htm::WordRowEncoder;
+
+namespace {
+
+std::string temp_path(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / ("chat_htm_" + name)).string();
+}
+
+ScalarEncoder::Params char_params() {
+  ScalarEncoder::Params p;
+  p.n = 64;
+  p.w = 5;
+  p.min_val = 0;
+  p.max_val = 255;
+  return p;
+}
+
+WordRowEncoder::Params word_params() {
+  WordRowEncoder::Params p;
+  p.rows = 8;
+  p.cols = 27 * 2;
+  p.letter_bits = 2;
+  return p;
+}
+
+}  // namespace
+
+TEST(CorpusCache, CharacterRoundTrip) {
+  TextNormalization norm;
+  norm.lowercase = true;
+  const auto loaded = TextChunker::from_string("Hello World", norm);
+  ScalarEncoder encoder(char_params());
+  const std::string path = temp_path("char.cache");
+  chat_htm::write_corpus_cache(path, loaded, encoder, norm);
+
+  CorpusCache cache(path);
+  EXPECT_EQ(cache.kind(), CorpusKind::Character);
+  EXPECT_NO_THROW(cache.require_params(chat_htm::corpus_cache_hash(char_params(), norm)));
+
+  auto chunker = cache.character_chunker();
+  ASSERT_EQ(chunker->size(), loaded.size());
+  for (std::size_t i = 0; i < loaded.size(); ++i) {
+    EXPECT_EQ(chunker->at(i), loaded.at(i)) << "index " << i;
+  }
+
+  const auto table = cache.sdr_table();
+  ASSERT_EQ(table.size(), 256u);
+  std::vector<int> expected;
+  for (int v : {0, int{'h'}, int{'w'}, 255}) {
+    encoder.encode_indices(v, expected);
+    const auto row = table[static_cast<std::size_t>(v)];
+    EXPECT_EQ(std::vector<int>(row.begin(), row.end()), expected) << "value " << v;
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(CorpusCache, WordRoundTrip) {
+  const auto loaded = WordChunker::from_string("the cat sat on the mat");
+  WordRowEncoder encoder(word_params());
+  const std::string path = temp_path("word.cache");
+  chat_htm::write_corpus_cache(path, loaded, encoder);
+
+  CorpusCache cache(path);
+  EXPECT_EQ(cache.kind(), CorpusKind::Words);
+  auto chunker = cache.word_chunker();
+  EXPECT_EQ(chunker->tokens(), loaded.tokens());
+  EXPECT_EQ(chunker->vocabulary(), loaded.vocabulary());
+  EXPECT_EQ(chunker->max_word_length(), loaded.max_word_length());
+
+  const auto table = cache.sdr_table();
+  ASSERT_EQ(table.size(), loaded.vocabulary_size());
+  std::vector<int> expected;
+  for (std::size_t id = 0; id < loaded.vocabulary_size(); ++id) {
+    encoder.encode_indices(loaded.word(static_cast<WordChunker::WordId>(id)), expected);
+    const auto row = table[id];
+    EXPECT_EQ(std::vector<int>(row.begin(), row.end()), expected) << "word " << id;
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(CorpusCache, WordHashRoundTrip) {
+  const auto loaded = WordChunker::from_string("the cat sat on the mat");
+  WordHashEncoder::Params p;
+  p.n = 128;
+  p.w = 6;
+  p.trigram_bits = 2;
+  p.seed = 7;
+  WordHashEncoder encoder(p);
+  const std::string path = temp_path("word_hash.cache");
+  chat_htm::write_corpus_cache(path, loaded, encoder);
+
+  CorpusCache cache(path);
+  EXPECT_EQ(cache.kind(), CorpusKind::Words);
+  EXPECT_NO_THROW(cache.require_params(chat_htm::corpus_cache_hash(p)));
+  auto other = p;
+  other.seed = 8;
+  EXPECT_THROW(cache.require_params(chat_htm::corpus_cache_hash(other)), std::runtime_error);
+
+  const auto table = cache.sdr_table();
+  ASSERT_EQ(table.size(), loaded.vocabulary_size());
+  std::vector<int> expected;
+  for (std::size_t id = 0; id < loaded.vocabulary_size(); ++id) {
+    encoder.encode_indices(loaded.word(static_cast<WordChunker::WordId>(id)), expected);
+    const auto row = table[id];
+    EXPECT_EQ(std::vector<int>(row.begin(), row.end()), expected) << "word " << id;
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(CorpusCache, RejectsMismatchedParams) {
+  const auto loaded = TextChunker::from_string("abc");
+  const std::string path = temp_path("params.cache");
+  chat_htm::write_corpus_cache(path, loaded, ScalarEncoder(char_params()), {});
+
+  CorpusCache cache(path);
+  auto other = char_params();
+  other.w = 7;
+  EXPECT_THROW(cache.require_params(chat_htm::corpus_cache_hash(other, {})), std::runtime_error);
+  TextNormalization lower;
+  lower.lowercase = true;
+  EXPECT_THROW(cache.require_params(chat_htm::corpus_cache_hash(char_params(), lower)),
+               std::runtime_error);
+  EXPECT_THROW(cache.word_chunker(), std::logic_error);
+  std::filesystem::remove(path);
+}
+
+TEST(CorpusCache, RejectsBadFiles) {
+  EXPECT_THROW(CorpusCache("/nonexistent/corpus.cache"), std::runtime_error);
+
+  const std::string path = temp_path("bad.cache");
+  {
+    std::ofstream f(path, std::ios::binary);
+    f << std::string(256, 'x');
+  }
+  EXPECT_THROW(CorpusCache{path}, std::runtime_error);
+
+  // A valid cache cut short must fail validation rather than read past the end.
+  chat_htm::write_corpus_cache(path, WordChunker::from_string("one two three"),
+                               WordRowEncoder(word_params()));
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+  EXPECT_THROW(CorpusCache{path}, std::runtime_error);
+  std::filesystem::remove(path);
+}
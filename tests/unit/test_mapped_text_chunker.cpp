@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include "text/mapped_text_chunker.hpp"
+#include "text/text_chunker.hpp"
+
+using chat_htm::MappedTextChunker;
+using chat_htm::TextChunker;
+
+namespace {
+const std::string kHelloPath = CHAT_HTM_TEST_DATA_DIR "/hello_world.txt";
+}  // namespace
+
+TEST(MappedTextChunker, FromFileMatchesTextChunker) {
+  MappedTextChunker mapped(kHelloPath);
+  TextChunker loaded(kHelloPath);
+  ASSERT_EQ(mapped.size(), loaded.size());
+  EXPECT_EQ(mapped.path(), kHelloPath);
+  for (std::size_t i = 0; i < loaded.size() * 2 + 3; ++i) {
+    ASSERT_EQ(mapped.next(), loaded.next()) << "step " << i;
+    EXPECT_EQ(mapped.position(), loaded.position());
+    EXPECT_EQ(mapped.epoch(), loaded.epoch());
+  }
+  EXPECT_EQ(mapped.total_steps(), loaded.total_steps());
+}
+
+TEST(MappedTextChunker, PeekAndAtWrap) {
+  MappedTextChunker mapped(kHelloPath);
+  TextChunker loaded(kHelloPath);
+  EXPECT_EQ(mapped.peek(), loaded.peek());
+  EXPECT_EQ(mapped.peek_at(3), loaded.peek_at(3));
+  EXPECT_EQ(mapped.at(mapped.size() + 1), loaded.at(1));
+}
+
+TEST(MappedTextChunker, ResetGoesBackToStart) {
+  MappedTextChunker mapped(kHelloPath);
+  const int first = mapped.peek();
+  mapped.next();
+  mapped.next();
+  mapped.reset();
+  EXPECT_EQ(mapped.position(), 0u);
+  EXPECT_EQ(mapped.total_steps(), 0u);
+  EXPECT_EQ(mapped.next(), first);
+}
+
+TEST(MappedTextChunker, MoveTransfersMapping) {
+  MappedTextChunker a(kHelloPath);
+  a.next();
+  MappedTextChunker b(std::move(a));
+  EXPECT_EQ(b.position(), 1u);
+  EXPECT_GT(b.size(), 0u);
+}
+
+TEST(MappedTextChunker, ThrowsOnMissingFile) {
+  EXPECT_THROW(MappedTextChunker("/nonexistent/path/file.txt"), std::runtime_error);
+}
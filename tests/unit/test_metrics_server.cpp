@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "runtime/metrics_server.hpp"
+
+using chat_htm::MetricsServer;
+using chat_htm::RunMetrics;
+
+namespace {
+
+/// Send one raw HTTP request to 127.0.0.1:port and return the whole reply.
+std::string http_get(int port, const std::string& path) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<std::uint16_t>(port));
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return {};
+  }
+  const std::string req = "GET " + path + " HTTP/1.0\r\n\r\n";
+  ::send(fd, req.data(), req.size(), 0);
+  std::string reply;
+  char buf[4096];
+  ssize_t n;
+  while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) reply.append(buf, static_cast<std::size_t>(n));
+  ::close(fd);
+  return reply;
+}
+
+}  // namespace
+
+TEST(MetricsServer, RendersPrometheusText) {
+  RunMetrics m(2);
+  m.steps.store(1234);
+  m.epoch.store(3);
+  m.window_accuracy.store(0.5);
+  m.active_columns[1].store(7);
+  m.predictive_columns[0].store(4);
+
+  const std::string text = MetricsServer::render(m, 4096);
+  EXPECT_NE(text.find("# TYPE chat_htm_steps_total counter\nchat_htm_steps_total 1234\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("chat_htm_epoch 3\n"), std::string::npos);
+  EXPECT_NE(text.find("chat_htm_prediction_accuracy_window 0.5\n"), std::string::npos);
+  EXPECT_NE(text.find("chat_htm_resident_bytes 4096\n"), std::string::npos);
+  EXPECT_NE(text.find("chat_htm_active_columns{layer=\"1\"} 7\n"), std::string::npos);
+  EXPECT_NE(text.find("chat_htm_predictive_columns{layer=\"0\"} 4\n"), std::string::npos);
+  EXPECT_EQ(MetricsServer::render(m, -1).find("resident"), std::string::npos);
+}
+
+TEST(MetricsServer, ServesMetricsOverHttp) {
+  MetricsServer server({}, 1);
+  ASSERT_GT(server.port(), 0);
+  server.metrics().steps.store(42);
+
+  const std::string reply = http_get(server.port(), "/metrics");
+  EXPECT_EQ(reply.rfind("HTTP/1.0 200 OK", 0), 0u) << reply;
+  EXPECT_NE(reply.find("chat_htm_steps_total 42\n"), std::string::npos);
+  EXPECT_EQ(http_get(server.port(), "/nope").rfind("HTTP/1.0 404", 0), 0u);
+}
+
+TEST(MetricsServer, ResidentBytesIsPositiveOnLinux) {
+  EXPECT_GT(MetricsServer::resident_bytes(), 0);
+}
+
+TEST(MetricsServer, BadAddressThrows) {
+  MetricsServer::Options opts;
+  opts.host = "not an address";
+  EXPECT_THROW(MetricsServer(opts, 1), std::runtime_error);
+}
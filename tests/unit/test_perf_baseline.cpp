@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "runtime/perf_baseline.hpp"
+
+using chat_htm::PerfResult;
+
+TEST(PerfBaseline, JsonRoundTrip) {
+  const std::vector<PerfResult> results = {{"char/c400/l1/learn/t1", 1234.5, 12.25, 20480},
+                                           {"word_rows/c6400/l1/frozen/t1", 88.0, 140.0, 65536}};
+  const std::string path = testing::TempDir() + "chat_htm_perf.json";
+  std::ofstream(path) << chat_htm::perf_results_json(results);
+
+  const auto back = chat_htm::load_perf_results(path);
+  ASSERT_EQ(back.size(), 2u);
+  EXPECT_EQ(back[1].name, "word_rows/c6400/l1/frozen/t1");
+  EXPECT_DOUBLE_EQ(back[0].steps_per_sec, 1234.5);
+  EXPECT_DOUBLE_EQ(back[0].startup_ms, 12.25);
+  EXPECT_EQ(back[1].peak_rss_kib, 65536);
+
+  std::ofstream(path) << chat_htm::perf_results_json({});
+  EXPECT_TRUE(chat_htm::load_perf_results(path).empty());
+  std::ofstream(path) << "{\"cases\": [{\"name\": \"x\"}]}";
+  EXPECT_THROW(chat_htm::load_perf_results(path), std::runtime_error);
+  std::remove(path.c_str());
+  EXPECT_THROW(chat_htm::load_perf_results(path), std::runtime_error);
+}
+
+TEST(PerfBaseline, FlagsOnlyMetricsPastTolerance) {
+  const std::vector<PerfResult> baseline = {{"a", 1000.0, 100.0, 10000}, {"b", 1000.0, 2.0, 10000}};
+  chat_htm::PerfTolerance tol;  // 15% slower, 10% more RSS, 25% + 5 ms slower startup.
+
+  auto cmp = chat_htm::compare_perf(baseline, {{"a", 900.0, 120.0, 10900}, {"new", 1.0, 1.0, 1}}, tol);
+  EXPECT_TRUE(cmp.regressions.empty());
+  EXPECT_FALSE(cmp.ok());  // "new" was never checked.
+  EXPECT_TRUE(cmp.ok(/*require_baseline=*/false));
+  ASSERT_EQ(cmp.unmatched.size(), 1u);
+  EXPECT_EQ(cmp.unmatched[0], "new");
+
+  cmp = chat_htm::compare_perf(baseline, {{"a", 800.0, 130.0, 11100}}, tol);
+  ASSERT_EQ(cmp.regressions.size(), 3u);
+  EXPECT_EQ(cmp.regressions[0].metric, "steps_per_sec");
+  EXPECT_DOUBLE_EQ(cmp.regressions[0].measured, 800.0);
+  EXPECT_EQ(cmp.regressions[1].metric, "peak_rss_kib");
+  EXPECT_EQ(cmp.regressions[2].metric, "startup_ms");
+
+  // Tripling a 2 ms startup is still under the absolute floor.
+  cmp = chat_htm::compare_perf(baseline, {{"b", 1000.0, 6.0, 10000}}, tol);
+  EXPECT_TRUE(cmp.ok());
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <htm_flow/config.hpp>
+
+#include "config/region_footprint.hpp"
+
+using chat_htm::estimate_footprint;
+using chat_htm::format_bytes;
+
+TEST(RegionFootprint, CountsSynapsesFromConfig) {
+  htm_flow::HTMRegionConfig region;
+  htm_flow::HTMLayerConfig l;
+  l.num_column_rows = 20;
+  l.num_column_cols = 40;
+  l.pot_width = 20;
+  l.pot_height = 1;
+  l.cells_per_column = 5;
+  l.max_segments_per_cell = 4;
+  l.max_synapses_per_segment = 20;
+  region.layers = {l, l};
+
+  const auto fp = estimate_footprint(region);
+  ASSERT_EQ(fp.layers.size(), 2u);
+  EXPECT_EQ(fp.layers[0].columns, 800);
+  EXPECT_EQ(fp.layers[0].cells, 4000);
+  EXPECT_EQ(fp.layers[0].proximal_synapses, 16000);
+  EXPECT_EQ(fp.layers[0].distal_synapses, 320000);
+  EXPECT_EQ(fp.layers[0].bytes(), (16000 + 320000) * 8 + 800 * 16 + 4000 * 8);
+  EXPECT_EQ(fp.bytes(), 2 * fp.layers[0].bytes());
+  EXPECT_EQ(fp.distal_synapses(), 640000);
+  EXPECT_EQ(fp.proximal_synapses(), 32000);
+}
+
+TEST(RegionFootprint, LargeGridsDoNotOverflow) {
+  htm_flow::HTMRegionConfig region;
+  htm_flow::HTMLayerConfig l;
+  l.num_column_rows = 1000;
+  l.num_column_cols = 1000;
+  l.cells_per_column = 32;
+  l.max_segments_per_cell = 128;
+  l.max_synapses_per_segment = 64;
+  region.layers = {l};
+  EXPECT_EQ(estimate_footprint(region).distal_synapses(), 1000000LL * 32 * 128 * 64);
+}
+
+TEST(RegionFootprint, NegativeSizesCountAsZero) {
+  htm_flow::HTMRegionConfig region;
+  htm_flow::HTMLayerConfig l;
+  l.cells_per_column = -1;
+  region.layers = {l};
+  const auto fp = estimate_footprint(region);
+  EXPECT_EQ(fp.layers[0].cells, 0);
+  EXPECT_EQ(fp.layers[0].distal_synapses, 0);
+}
+
+TEST(RegionFootprint, FormatsBytes) {
+  EXPECT_EQ(format_bytes(512), "512 B");
+  EXPECT_EQ(format_bytes(1536), "1.5 KiB");
+  EXPECT_EQ(format_bytes(3LL * 1024 * 1024 * 1024), "3.0 GiB");
+}
@@ -132,3 +132,64 @@ TEST(ScalarEncoder, SingleValueRange) {
   int active = std::accumulate(sdr.begin(), sdr.end(), 0);
   EXPECT_EQ(active, 5);
 }
+
+// ---------------------------------------------------------------------------
+// Sparse index output
+// ---------------------------------------------------------------------------
+
+TEST(ScalarEncoder, EncodeIndicesMatchesDenseEncoding) {
+  ScalarEncoder::Params p{.n = 400, .w = 21, .min_val = 0, .max_val = 127};
+  ScalarEncoder enc(p);
+
+  std::vector<int> indices;
+  for (int v = -3; v <= 130; ++v) {
+    enc.encode_indices(v, indices);
+    ASSERT_EQ(static_cast<int>(indices.size()), p.w) << "value=" << v;
+    auto dense = enc.encode(v);
+    std::vector<int> expected;
+    for (int i = 0; i < p.n; ++i) {
+      if (dense[static_cast<std::size_t>(i)]) expected.push_back(i);
+    }
+    EXPECT_EQ(indices, expected) << "value=" << v;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Cached mode
+// ---------------------------------------------------------------------------
+
+TEST(ScalarEncoder, CachedModeMatchesComputedEncoding) {
+  ScalarEncoder::Params p{.n = 400, .w = 21, .min_val = 0, .max_val = 127};
+  ScalarEncoder plain(p);
+  p.cache = true;
+  ScalarEncoder cached(p);
+  ASSERT_TRUE(cached.cached());
+  EXPECT_FALSE(plain.cached());
+
+  std::vector<int> expected;
+  for (int v = -2; v <= 129; ++v) {
+    plain.encode_indices(v, expected);
+    auto view = cached.active_indices(v);
+    EXPECT_EQ(std::vector<int>(view.begin(), view.end()), expected) << "value=" << v;
+    EXPECT_EQ(cached.encode(v), plain.encode(v)) << "value=" << v;
+  }
+}
+
+TEST(ScalarEncoder, ActiveIndicesRequiresCache) {
+  ScalarEncoder enc;
+  EXPECT_THROW(enc.active_indices(10), std::logic_error);
+}
+
+TEST(ScalarEncoder, OverlapMatchesDenseComparison) {
+  ScalarEncoder::Params p{.n = 100, .w = 9, .min_val = 0, .max_val = 127, .cache = true};
+  ScalarEncoder enc(p);
+  for (int a = 0; a <= 127; a += 7) {
+    for (int b = 0; b <= 127; b += 5) {
+      auto da = enc.encode(a);
+      auto db = enc.encode(b);
+      int expected = 0;
+      for (std::size_t i = 0; i < da.size(); ++i) expected += (da[i] && db[i]) ? 1 : 0;
+      EXPECT_EQ(enc.overlap(a, b), expected) << a << " vs " << b;
+    }
+  }
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "encoders/scalar_encoder.hpp"
+#include "encoders/sdr.hpp"
+#include "encoders/word_row_encoder.hpp"
+
+using chat_htm::Sdr;
+namespace kernels = chat_htm::sdr_kernels;
+
+namespace {
+
+/// Random SDR of `size` bits with each bit set with probability `p`.
+Sdr random_sdr(std::size_t size, double p, std::mt19937& rng) {
+  std::bernoulli_distribution bit(p);
+  Sdr s(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    if (bit(rng)) s.set(i);
+  }
+  return s;
+}
+
+}  // namespace
+
+TEST(Sdr, PacksIntoWords) {
+  Sdr s(1080);
+  EXPECT_EQ(s.size(), 1080u);
+  EXPECT_EQ(s.num_words(), 17u);
+  EXPECT_TRUE(s.empty());
+  s.set(0);
+  s.set(63);
+  s.set(64);
+  s.set(1079);
+  EXPECT_EQ(s.count(), 4u);
+  EXPECT_TRUE(s.test(63));
+  EXPECT_FALSE(s.test(62));
+  s.clear(63);
+  EXPECT_EQ(s.indices(), (std::vector<int>{0, 64, 1079}));
+  EXPECT_THROW(s.set(1080), std::out_of_range);
+}
+
+TEST(Sdr, IndexAndDenseRoundTrip) {
+  const std::vector<int> active = {3, 17, 64, 65, 127, 199};
+  const Sdr s = Sdr::from_indices(200, active);
+  EXPECT_EQ(s.indices(), active);
+
+  std::vector<int> dense(200, 0);
+  for (int i : active) dense[static_cast<std::size_t>(i)] = 1;
+  EXPECT_EQ(Sdr::from_dense(dense), s);
+  EXPECT_THROW(Sdr::from_indices(10, std::vector<int>{10}), std::out_of_range);
+  EXPECT_THROW(Sdr::from_indices(10, std::vector<int>{-1}), std::out_of_range);
+}
+
+TEST(Sdr, OverlapUnionAndHamming) {
+  const Sdr a = Sdr::from_indices(130, std::vector<int>{1, 2, 3, 100, 129});
+  const Sdr b = Sdr::from_indices(130, std::vector<int>{2, 3, 4, 129});
+  EXPECT_EQ(a.overlap(b), 3u);
+  EXPECT_EQ(a.union_count(b), 6u);
+  EXPECT_EQ(a.hamming(b), 3u);
+  EXPECT_EQ((a | b).indices(), (std::vector<int>{1, 2, 3, 4, 100, 129}));
+  EXPECT_EQ((a & b).indices(), (std::vector<int>{2, 3, 129}));
+  EXPECT_THROW(a.overlap(Sdr(64)), std::invalid_argument);
+}
+
+TEST(SdrKernels, MatchScalarReferenceAtEveryLength) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<std::uint64_t> word;
+  // Cover the vector body and every tail length.
+  for (std::size_t n = 0; n <= 19; ++n) {
+    std::vector<std::uint64_t> a(n), b(n);
+    std::size_t count = 0, both = 0, either = 0, diff = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      a[i] = word(rng);
+      b[i] = word(rng);
+      count += static_cast<std::size_t>(kernels::popcount64(a[i]));
+      both += static_cast<std::size_t>(kernels::popcount64(a[i] & b[i]));
+      either += static_cast<std::size_t>(kernels::popcount64(a[i] | b[i]));
+      diff += static_cast<std::size_t>(kernels::popcount64(a[i] ^ b[i]));
+    }
+    EXPECT_EQ(kernels::popcount(a.data(), n), count) << "n=" << n << " " << kernels::name();
+    EXPECT_EQ(kernels::and_popcount(a.data(), b.data(), n), both) << "n=" << n;
+    EXPECT_EQ(kernels::or_popcount(a.data(), b.data(), n), either) << "n=" << n;
+    EXPECT_EQ(kernels::xor_popcount(a.data(), b.data(), n), diff) << "n=" << n;
+  }
+  EXPECT_EQ(kernels::popcount64(~std::uint64_t{0}), 64);
+  EXPECT_EQ(kernels::ctz64(std::uint64_t{1} << 40), 40);
+}
+
+TEST(Sdr, RandomOverlapMatchesSetIntersection) {
+  std::mt19937 rng(11);
+  const Sdr a = random_sdr(1080, 0.1, rng);
+  const Sdr b = random_sdr(1080, 0.1, rng);
+  const auto ia = a.indices();
+  const auto ib = b.indices();
+  std::size_t shared = 0;
+  for (int i : ia) shared += b.test(static_cast<std::size_t>(i)) ? 1 : 0;
+  EXPECT_EQ(a.overlap(b), shared);
+  EXPECT_EQ(a.hamming(b), ia.size() + ib.size() - 2 * shared);
+}
+
+TEST(Sdr, EncodersProduceMatchingSdrs) {
+  chat_htm::ScalarEncoder::Params sp;
+  sp.n = 100;
+  sp.w = 9;
+  const chat_htm::ScalarEncoder scalar(sp);
+  for (int a : {0, 40, 41, 127}) {
+    for (int b : {0, 42, 127}) {
+      EXPECT_EQ(static_cast<int>(scalar.encode_sdr(a).overlap(scalar.encode_sdr(b))),
+                scalar.overlap(a, b));
+    }
+  }
+  EXPECT_EQ(scalar.encode_sdr(65), Sdr::from_dense(scalar.encode(65)));
+
+  chat_htm::WordRowEncoder::Params wp;
+  wp.rows = 5;
+  wp.cols = 216;
+  wp.letter_bits = 8;
+  const chat_htm::WordRowEncoder words(wp);
+  EXPECT_EQ(words.encode_sdr("hello"), Sdr::from_dense(words.encode("hello")));
+  EXPECT_EQ(words.encode_sdr("hello").num_words(), 17u);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "text/sharded_corpus.hpp"
+
+using chat_htm::ShardedCorpus;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// A fresh directory under the test temp dir holding `files` (name -> text).
+fs::path make_shards(const std::string& dir,
+                     const std::vector<std::pair<std::string, std::string>>& files) {
+  const fs::path root = fs::path(testing::TempDir()) / dir;
+  fs::remove_all(root);
+  fs::create_directories(root);
+  for (const auto& [name, text] : files) {
+    std::ofstream(root / name, std::ios::binary) << text;
+  }
+  return root;
+}
+
+std::string drain(ShardedCorpus& corpus, std::size_t shards) {
+  std::string out;
+  for (std::size_t i = 0; i < shards; ++i) out += corpus.next_shard()->text() + "|";
+  return out;
+}
+
+}  // namespace
+
+TEST(ShardedCorpus, ListsDirectoryInNameOrderSkippingEmptyAndHidden) {
+  const auto root = make_shards("shards_dir", {{"b.txt", "bb"}, {"a.txt", "aa"},
+                                               {"empty.txt", ""}, {".hidden", "hh"}});
+  const auto shards = ShardedCorpus::list_shards(root.string());
+  ASSERT_EQ(shards.size(), 2u);
+  EXPECT_EQ(fs::path(shards[0]).filename(), "a.txt");
+  EXPECT_EQ(fs::path(shards[1]).filename(), "b.txt");
+  fs::remove_all(root);
+}
+
+TEST(ShardedCorpus, ReadsManifestRelativeToItsDirectory) {
+  const auto root = make_shards("shards_manifest", {{"one.txt", "1"}, {"two.txt", "2"}});
+  std::ofstream(root / "list.txt") << "# shards\ntwo.txt\n\n  one.txt  \n";
+  const auto shards = ShardedCorpus::list_shards((root / "list.txt").string());
+  ASSERT_EQ(shards.size(), 2u);
+  EXPECT_EQ(fs::path(shards[0]).filename(), "two.txt");
+  EXPECT_EQ(fs::path(shards[1]).filename(), "one.txt");
+
+  std::ofstream(root / "bad.txt") << "missing.txt\n";
+  EXPECT_THROW(ShardedCorpus::list_shards((root / "bad.txt").string()), std::runtime_error);
+  EXPECT_THROW(ShardedCorpus::list_shards((root / "nope").string()), std::runtime_error);
+  fs::remove_all(root);
+}
+
+TEST(ShardedCorpus, StreamsShardsInOrderAcrossEpochs) {
+  const auto root = make_shards("shards_stream", {{"a", "Ab"}, {"b", "Cd"}, {"c", "Ef"}});
+  ShardedCorpus::Options opts;
+  opts.norm.lowercase = true;
+  ShardedCorpus corpus(ShardedCorpus::list_shards(root.string()), opts);
+  EXPECT_EQ(corpus.num_shards(), 3u);
+  EXPECT_EQ(corpus.total_size(), 6u);
+
+  EXPECT_EQ(drain(corpus, 3), "ab|cd|ef|");
+  EXPECT_EQ(corpus.epoch(), 0);
+  EXPECT_EQ(corpus.shard_index(), 2u);
+  EXPECT_EQ(corpus.next_shard()->text(), "ab");
+  EXPECT_EQ(corpus.epoch(), 1);
+  EXPECT_EQ(corpus.shard_index(), 0u);
+  fs::remove_all(root);
+}
+
+TEST(ShardedCorpus, ShuffleIsSeededPerEpochPermutation) {
+  std::vector<std::string> shards;
+  std::vector<std::pair<std::string, std::string>> files;
+  for (int i = 0; i < 16; ++i) files.push_back({"s" + std::to_string(100 + i), std::to_string(i)});
+  const auto root = make_shards("shards_shuffle", files);
+
+  ShardedCorpus::Options opts;
+  opts.shuffle = true;
+  opts.seed = 7;
+  ShardedCorpus a(ShardedCorpus::list_shards(root.string()), opts);
+  ShardedCorpus b(ShardedCorpus::list_shards(root.string()), opts);
+  opts.seed = 8;
+  ShardedCorpus c(ShardedCorpus::list_shards(root.string()), opts);
+
+  const auto e0 = a.order(0);
+  EXPECT_EQ(e0, b.order(0));
+  EXPECT_NE(e0, a.order(1));
+  EXPECT_NE(e0, c.order(0));
+  auto sorted = e0;
+  std::sort(sorted.begin(), sorted.end());
+  for (std::size_t i = 0; i < sorted.size(); ++i) EXPECT_EQ(sorted[i], i);
+
+  // Streaming follows order(): epoch 0, then epoch 1's permutation.
+  for (int epoch : {0, 1}) {
+    for (std::size_t idx : a.order(epoch)) {
+      EXPECT_EQ(a.next_shard()->text(), std::to_string(idx));
+    }
+  }
+  fs::remove_all(root);
+}
+
+TEST(ShardedCorpus, RejectsEmptyShardList) {
+  EXPECT_THROW(ShardedCorpus({}, {}), std::invalid_argument);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "runtime/snapshot_delta.hpp"
+
+using chat_htm::SnapshotDelta;
+using chat_htm::SnapshotTracker;
+
+namespace {
+
+htm_gui::Snapshot make_snapshot(std::size_t columns, std::vector<int> active,
+                                std::vector<std::size_t> predictive) {
+  htm_gui::Snapshot s;
+  s.column_cell_masks.resize(columns);
+  for (int c : active) s.column_cell_masks[static_cast<std::size_t>(c)].active = 1;
+  for (std::size_t c : predictive) s.column_cell_masks[c].predictive = 2;
+  s.active_column_indices = std::move(active);
+  return s;
+}
+
+}  // namespace
+
+TEST(SnapshotDelta, FirstRequestIsAKeyframe) {
+  SnapshotTracker tracker;
+  const auto snap = make_snapshot(8, {5, 1}, {3});
+  const SnapshotDelta& d = tracker.update(snap, 0, 0, 1);
+  EXPECT_TRUE(d.full);
+  EXPECT_EQ(d.version, 1u);
+  EXPECT_EQ(d.columns.size(), 8u);
+
+  htm_gui::Snapshot view;
+  d.apply(view);
+  EXPECT_EQ(view.active_column_indices, (std::vector<int>{1, 5}));
+  ASSERT_EQ(view.column_cell_masks.size(), 8u);
+  EXPECT_EQ(view.column_cell_masks[3].predictive, 2u);
+}
+
+TEST(SnapshotDelta, LaterRequestsListOnlyChangedColumns) {
+  SnapshotTracker tracker;
+  htm_gui::Snapshot view;
+  tracker.update(make_snapshot(16, {1, 5}, {3}), 0, 0, 1).apply(view);
+
+  const auto next = make_snapshot(16, {5, 9}, {3, 12});
+  const SnapshotDelta& d = tracker.update(next, 1, 0, 2);
+  EXPECT_FALSE(d.full);
+  EXPECT_EQ(d.base_version, 1u);
+  ASSERT_EQ(d.columns.size(), 3u);  // 1 turned off, 9 on, 12 predictive.
+  EXPECT_EQ(d.columns[0].column, 1);
+  EXPECT_FALSE(d.columns[0].active);
+  EXPECT_EQ(d.columns[1].column, 9);
+  EXPECT_TRUE(d.columns[1].active);
+  EXPECT_EQ(d.columns[2].column, 12);
+
+  d.apply(view);
+  EXPECT_EQ(view.active_column_indices, (std::vector<int>{5, 9}));
+  for (std::size_t c = 0; c < 16; ++c) {
+    EXPECT_EQ(view.column_cell_masks[c].active, next.column_cell_masks[c].active) << c;
+    EXPECT_EQ(view.column_cell_masks[c].predictive, next.column_cell_masks[c].predictive) << c;
+  }
+}
+
+TEST(SnapshotDelta, StaleOrForeignRequestsGetAKeyframe) {
+  SnapshotTracker tracker;
+  tracker.update(make_snapshot(4, {0}, {}), 0, 0, 1);
+  tracker.update(make_snapshot(4, {1}, {}), 1, 0, 2);
+  EXPECT_TRUE(tracker.update(make_snapshot(4, {2}, {}), 1, 0, 3).full);  // Missed version 2.
+  EXPECT_TRUE(tracker.update(make_snapshot(4, {2}, {}), 3, 1, 3).full);  // Other layer.
+  EXPECT_TRUE(tracker.update(make_snapshot(6, {2}, {}), 3, 1, 4).full);  // Resized.
+}
+
+TEST(SnapshotDelta, CurrentReceiverNeedsNoSnapshot) {
+  SnapshotTracker tracker;
+  EXPECT_FALSE(tracker.current(0, 0, 0));
+  tracker.update(make_snapshot(4, {0}, {}), 0, 0, 7);
+  EXPECT_TRUE(tracker.current(7, 0, 7));
+  EXPECT_FALSE(tracker.current(7, 0, 8));
+  EXPECT_FALSE(tracker.current(7, 1, 7));
+  const SnapshotDelta& d = tracker.unchanged();
+  EXPECT_FALSE(d.full);
+  EXPECT_EQ(d.base_version, 7u);
+  EXPECT_EQ(d.version, 7u);
+  EXPECT_TRUE(d.columns.empty());
+}
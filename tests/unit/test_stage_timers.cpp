@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "runtime/stage_timers.hpp"
+
+using chat_htm::LatencyHistogram;
+using chat_htm::StageTimers;
+
+TEST(LatencyHistogram, EmptyReportsZero) {
+  LatencyHistogram h;
+  EXPECT_EQ(h.count(), 0u);
+  EXPECT_EQ(h.min_ns(), 0u);
+  EXPECT_EQ(h.percentile(50), 0.0);
+}
+
+TEST(LatencyHistogram, PercentilesWithinBucketError) {
+  LatencyHistogram h;
+  for (std::uint64_t v = 1; v <= 1000; ++v) h.record(v * 1000);
+  EXPECT_EQ(h.count(), 1000u);
+  EXPECT_EQ(h.min_ns(), 1000u);
+  EXPECT_EQ(h.max_ns(), 1000000u);
+  EXPECT_DOUBLE_EQ(h.mean_ns(), 500500.0);
+  // Log-linear buckets with 4 sub-buckets per octave: within ~20%.
+  EXPECT_NEAR(h.percentile(50), 500000.0, 0.2 * 500000.0);
+  EXPECT_NEAR(h.percentile(99), 990000.0, 0.2 * 990000.0);
+  EXPECT_LE(h.percentile(100), 1000000.0);
+  EXPECT_GE(h.percentile(0), 1000.0);
+}
+
+TEST(LatencyHistogram, SmallAndHugeValues) {
+  LatencyHistogram h;
+  h.record(0);
+  h.record(3);
+  h.record(~std::uint64_t{0});
+  EXPECT_EQ(h.percentile(0), 0.0);
+  EXPECT_EQ(h.percentile(100), static_cast<double>(~std::uint64_t{0}));
+  h.reset();
+  EXPECT_EQ(h.count(), 0u);
+}
+
+TEST(StageTimers, DisabledRecordsNothing) {
+  StageTimers timers;
+  { StageTimers::ScopedTimer t(timers, StageTimers::kRegionStep); }
+  EXPECT_EQ(timers[StageTimers::kRegionStep].count(), 0u);
+  EXPECT_EQ(timers.to_json(), "{}");
+}
+
+TEST(StageTimers, JsonListsRecordedStages) {
+  StageTimers timers;
+  timers.set_enabled(true);
+  for (int i = 0; i < 3; ++i) {
+    StageTimers::ScopedTimer t(timers, StageTimers::kEncode);
+  }
+  EXPECT_EQ(timers[StageTimers::kEncode].count(), 3u);
+  const std::string json = timers.to_json();
+  EXPECT_NE(json.find("\"encode\": {\"count\": 3"), std::string::npos);
+  EXPECT_NE(json.find("\"p99_us\""), std::string::npos);
+  EXPECT_EQ(json.find("region_step"), std::string::npos);
+  timers.reset();
+  EXPECT_EQ(timers.to_json(), "{}");
+}
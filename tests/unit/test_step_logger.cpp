@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "runtime/step_logger.hpp"
+
+using chat_htm::StepLogger;
+using chat_htm::StepRecord;
+
+namespace {
+
+std::string read_file(const std::string& path) {
+  std::ifstream f(path, std::ios::binary);
+  std::ostringstream ss;
+  ss << f.rdbuf();
+  return ss.str();
+}
+
+StepRecord record(std::int64_t step) {
+  StepRecord r;
+  r.step = step;
+  r.epoch = step / 10;
+  r.position = static_cast<std::uint64_t>(step % 10);
+  r.correct = step / 2;
+  r.total = step;
+  return r;
+}
+
+}  // namespace
+
+TEST(StepLogger, ParseFormat) {
+  EXPECT_EQ(StepLogger::parse_format("text"), StepLogger::Format::Text);
+  EXPECT_EQ(StepLogger::parse_format("csv"), StepLogger::Format::Csv);
+  EXPECT_EQ(StepLogger::parse_format("binary"), StepLogger::Format::Binary);
+  EXPECT_THROW(StepLogger::parse_format("json"), std::invalid_argument);
+}
+
+TEST(StepLogger, RejectsBadOptions) {
+  StepLogger::Options opts;
+  opts.every = 0;
+  EXPECT_THROW(StepLogger(opts, nullptr), std::invalid_argument);
+  opts.every = 1;
+  opts.format = StepLogger::Format::Binary;  // Binary needs a file.
+  EXPECT_THROW(StepLogger(opts, nullptr), std::invalid_argument);
+  opts.path = testing::TempDir() + "no_such_dir/log.bin";
+  EXPECT_THROW(StepLogger(opts, nullptr), std::runtime_error);
+}
+
+TEST(StepLogger, WantsSamplesEveryNthStep) {
+  StepLogger::Options opts;
+  opts.path = testing::TempDir() + "chat_htm_every.log";
+  opts.every = 4;
+  StepLogger log(opts, nullptr);
+  EXPECT_TRUE(log.wants(0));
+  EXPECT_FALSE(log.wants(3));
+  EXPECT_TRUE(log.wants(8));
+  std::remove(opts.path.c_str());
+}
+
+TEST(StepLogger, TextAndCsvLinesInOrder) {
+  const std::string path = testing::TempDir() + "chat_htm_steps.csv";
+  StepLogger::Options opts;
+  opts.format = StepLogger::Format::Csv;
+  opts.path = path;
+  opts.capacity = 4;  // Smaller than the record count: log() must wait, not drop.
+  {
+    StepLogger log(opts, [](std::uint64_t pos) { return "ctx \"" + std::to_string(pos) + "\""; });
+    for (int s = 1; s <= 100; ++s) log.log(record(s));
+    log.flush();
+    EXPECT_EQ(log.written(), 100u);
+  }
+  std::istringstream lines(read_file(path));
+  std::string line;
+  std::getline(lines, line);
+  EXPECT_EQ(line, "step,epoch,accuracy,position,context");
+  std::getline(lines, line);
+  EXPECT_EQ(line, "1,0,0.000000,1,\"ctx \"\"1\"\"\"");
+  int rows = 1;
+  while (std::getline(lines, line)) ++rows;
+  EXPECT_EQ(rows, 100);
+
+  opts.format = StepLogger::Format::Text;
+  {
+    StepLogger log(opts, [](std::uint64_t) { return std::string("[h]ello"); });
+    log.log(record(4));
+  }
+  EXPECT_EQ(read_file(path), "[text] step=4  epoch=0  accuracy=50.0%  | [h]ello\n");
+  std::remove(path.c_str());
+}
+
+TEST(StepLogger, BinaryHeaderAndRecords) {
+  const std::string path = testing::TempDir() + "chat_htm_steps.bin";
+  StepLogger::Options opts;
+  opts.format = StepLogger::Format::Binary;
+  opts.path = path;
+  {
+    StepLogger log(opts, nullptr);
+    for (int s = 0; s < 3; ++s) log.log(record(s * 7));
+  }
+  const std::string data = read_file(path);
+  ASSERT_EQ(data.size(), 16 + 3 * sizeof(StepRecord));
+  EXPECT_EQ(std::memcmp(data.data(), "CHTMLOG", 8), 0);
+  std::uint32_t header[2];
+  std::memcpy(header, data.data() + 8, sizeof(header));
+  EXPECT_EQ(header[0], 1u);
+  EXPECT_EQ(header[1], sizeof(StepRecord));
+  StepRecord last;
+  std::memcpy(&last, data.data() + 16 + 2 * sizeof(StepRecord), sizeof(last));
+  EXPECT_EQ(last.step, 14);
+  EXPECT_EQ(last.correct, 7);
+  std::remove(path.c_str());
+}
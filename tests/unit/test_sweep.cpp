@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "runtime/sweep.hpp"
+
+using chat_htm::SweepGrid;
+using chat_htm::SweepResult;
+
+namespace {
+
+SweepGrid make_grid() {
+  SweepGrid grid;
+  grid.add_axis("cells_per_column", {4, 8});
+  grid.add_axis("encoder.active_bits", {5, 7, 9});
+  return grid;
+}
+
+}  // namespace
+
+TEST(SweepGrid, CombinationsAreRowMajor) {
+  const auto grid = make_grid();
+  ASSERT_EQ(grid.size(), 6u);
+  EXPECT_EQ(grid.combination(0), (std::vector<double>{4, 5}));
+  EXPECT_EQ(grid.combination(1), (std::vector<double>{4, 7}));
+  EXPECT_EQ(grid.combination(3), (std::vector<double>{8, 5}));
+  EXPECT_EQ(grid.combination(5), (std::vector<double>{8, 9}));
+}
+
+TEST(SweepGrid, EmptyGridIsOneBaseRun) {
+  SweepGrid grid;
+  EXPECT_EQ(grid.size(), 1u);
+  EXPECT_TRUE(grid.combination(0).empty());
+}
+
+TEST(SweepGrid, RejectsUnknownKeysAndEmptyAxes) {
+  SweepGrid grid;
+  EXPECT_THROW(grid.add_axis("no_such_field", {1}), std::invalid_argument);
+  EXPECT_THROW(grid.add_axis("cells_per_column", {}), std::invalid_argument);
+  EXPECT_TRUE(SweepGrid::is_known_key("activation_threshold"));
+  EXPECT_TRUE(SweepGrid::is_known_key("encoder.letter_bits"));
+}
+
+TEST(SweepGrid, ApplySetsEveryLayerAndEncoder) {
+  SweepGrid grid;
+  grid.add_axis("cells_per_column", {16});
+  grid.add_axis("connected_perm", {0.25});
+  grid.add_axis("encoder.active_bits", {11});
+  grid.add_axis("encoder.letter_bits", {3});
+
+  htm_flow::HTMRegionConfig region;
+  region.layers.resize(2);
+  chat_htm::ScalarEncoder::Params scalar;
+  chat_htm::WordRowEncoder::Params word;
+  grid.apply(grid.combination(0), region, scalar, word);
+  for (const auto& layer : region.layers) {
+    EXPECT_EQ(layer.cells_per_column, 16);
+    EXPECT_FLOAT_EQ(layer.connected_perm, 0.25f);
+  }
+  EXPECT_EQ(scalar.w, 11);
+  EXPECT_EQ(word.letter_bits, 3);
+  // The word rows input is resized to fit the new letter width.
+  const int cols = 3 * (static_cast<int>(word.alphabet.size()) + 1);
+  EXPECT_EQ(word.cols, cols);
+  EXPECT_EQ(region.layers.front().num_input_cols, cols);
+  EXPECT_NO_THROW(chat_htm::WordRowEncoder{word});
+}
+
+TEST(SweepGrid, ApplyRechainsUpperLayerInputs) {
+  SweepGrid grid;
+  grid.add_axis("cells_per_column", {4, 8});
+
+  // Two layers wired as in default_text.yaml: layer 1 reads all of layer 0's cells.
+  htm_flow::HTMRegionConfig base;
+  base.layers.resize(2);
+  base.layers[0].num_column_rows = 20;
+  base.layers[0].num_column_cols = 40;
+  base.layers[0].cells_per_column = 5;
+  base.layers[1].num_input_rows = 20;
+  base.layers[1].num_input_cols = 40 * 5;
+
+  for (std::size_t run = 0; run < grid.size(); ++run) {
+    auto region = base;
+    chat_htm::ScalarEncoder::Params scalar;
+    chat_htm::WordRowEncoder::Params word;
+    grid.apply(grid.combination(run), region, scalar, word);
+    const int cells = static_cast<int>(grid.combination(run)[0]);
+    EXPECT_EQ(region.layers[1].num_input_rows, 20);
+    EXPECT_EQ(region.layers[1].num_input_cols, 40 * cells) << "cells_per_column " << cells;
+  }
+}
+
+TEST(SweepGrid, RejectsEncoderKeysTheModeIgnores) {
+  using chat_htm::TextMode;
+  SweepGrid scalar_keys;
+  scalar_keys.add_axis("encoder.min_value", {0});
+  scalar_keys.add_axis("encoder.active_bits", {9});
+  EXPECT_NO_THROW(scalar_keys.check_text_mode(TextMode::Character));
+  EXPECT_THROW(scalar_keys.check_text_mode(TextMode::WordRows), std::invalid_argument);
+  EXPECT_THROW(scalar_keys.check_text_mode(TextMode::WordHash), std::invalid_argument);
+
+  SweepGrid word_keys;
+  word_keys.add_axis("encoder.letter_bits", {3});
+  word_keys.add_axis("cells_per_column", {4});
+  EXPECT_NO_THROW(word_keys.check_text_mode(TextMode::WordRows));
+  EXPECT_THROW(word_keys.check_text_mode(TextMode::Character), std::invalid_argument);
+
+  SweepGrid hash_keys;
+  hash_keys.add_axis("encoder.trigram_bits", {2});
+  EXPECT_NO_THROW(hash_keys.check_text_mode(TextMode::WordHash));
+  EXPECT_THROW(hash_keys.check_text_mode(TextMode::WordRows), std::invalid_argument);
+}
+
+TEST(SweepGrid, FromYaml) {
+  const std::string path = testing::TempDir() + "chat_htm_grid.yaml";
+  {
+    std::ofstream f(path);
+    f << "cells_per_column: [4, 8]\nactivation_threshold: 3\n";
+  }
+  const auto grid = SweepGrid::from_yaml(path);
+  ASSERT_EQ(grid.axes().size(), 2u);
+  EXPECT_EQ(grid.axes()[0].key, "cells_per_column");
+  EXPECT_EQ(grid.axes()[1].values, std::vector<double>{3});
+  {
+    std::ofstream f(path);
+    f << "bogus: [1]\n";
+  }
+  EXPECT_THROW(SweepGrid::from_yaml(path), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(RunSweep, RunsEveryCombinationOnceAndRecordsErrors) {
+  const auto grid = make_grid();
+  std::set<std::size_t> done;
+  const auto results = chat_htm::run_sweep(
+      grid, 4,
+      [](const std::vector<double>& values, SweepResult& r) {
+        if (values[1] == 7) throw std::runtime_error("bad combo");
+        r.steps = 10;
+        r.accuracy = values[0] / 10.0;
+      },
+      [&](const SweepResult& r) { done.insert(r.run); });
+
+  ASSERT_EQ(results.size(), grid.size());
+  EXPECT_EQ(done.size(), grid.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].run, i);
+    EXPECT_EQ(results[i].values, grid.combination(i));
+    if (results[i].values[1] == 7) {
+      EXPECT_EQ(results[i].error, "bad combo");
+    } else {
+      EXPECT_TRUE(results[i].error.empty());
+      EXPECT_DOUBLE_EQ(results[i].accuracy, results[i].values[0] / 10.0);
+    }
+  }
+}
+
+TEST(RunSweep, WritesCsv) {
+  const auto grid = make_grid();
+  const auto results = chat_htm::run_sweep(grid, 1, [](const std::vector<double>&, SweepResult& r) {
+    r.steps = 5;
+  });
+  const std::string path = testing::TempDir() + "chat_htm_sweep.csv";
+  chat_htm::write_sweep_csv(path, grid, results);
+
+  std::ifstream in(path);
+  std::string header;
+  std::getline(in, header);
+  EXPECT_EQ(header, "run,cells_per_column,encoder.active_bits,steps,accuracy,seconds,steps_per_sec,error");
+  std::string line;
+  std::size_t rows = 0;
+  while (std::getline(in, line)) ++rows;
+  EXPECT_EQ(rows, grid.size());
+  std::remove(path.c_str());
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "runtime/symbol_classifier.hpp"
+
+using chat_htm::SymbolClassifier;
+
+TEST(SymbolClassifier, EmptyDecodesNothing) {
+  SymbolClassifier c(10, 4);
+  std::vector<SymbolClassifier::Prediction> out{{1, 1.0f}};
+  c.decode(std::vector<int>{0, 1, 2}, 3, out);
+  EXPECT_TRUE(out.empty());
+}
+
+TEST(SymbolClassifier, RanksSymbolsByColumnEvidence) {
+  SymbolClassifier c(10, 4);
+  c.learn(std::vector<int>{0, 1, 2}, 0);
+  c.learn(std::vector<int>{2, 3, 4}, 1);
+  c.learn(std::vector<int>{5, 6}, 2);
+  EXPECT_EQ(c.observations(), 8u);
+
+  std::vector<SymbolClassifier::Prediction> out;
+  c.decode(std::vector<int>{0, 1, 2, 3}, 3, out);
+  ASSERT_EQ(out.size(), 2u);  // Symbol 2 shares no column.
+  EXPECT_EQ(out[0].symbol, 0u);
+  // Columns 0 and 1 are all symbol 0, column 2 is split: (1 + 1 + 0.5) / 4.
+  EXPECT_FLOAT_EQ(out[0].score, 2.5f / 4.0f);
+  EXPECT_EQ(out[1].symbol, 1u);
+  EXPECT_FLOAT_EQ(out[1].score, 1.5f / 4.0f);
+
+  c.decode(std::vector<int>{0, 1, 2, 3}, 1, out);
+  ASSERT_EQ(out.size(), 1u);
+  EXPECT_EQ(out[0].symbol, 0u);
+}
+
+TEST(SymbolClassifier, RepeatedDecodesAreIndependent) {
+  SymbolClassifier c(8, 2);
+  c.learn(std::vector<int>{0, 1}, 0);
+  c.learn(std::vector<int>{6, 7}, 1);
+  std::vector<SymbolClassifier::Prediction> out;
+  c.decode(std::vector<int>{0, 1}, 2, out);
+  ASSERT_EQ(out.size(), 1u);
+  EXPECT_FLOAT_EQ(out[0].score, 1.0f);
+  c.decode(std::vector<int>{6, 7}, 2, out);  // Scratch scores were reset.
+  ASSERT_EQ(out.size(), 1u);
+  EXPECT_EQ(out[0].symbol, 1u);
+  EXPECT_FLOAT_EQ(out[0].score, 1.0f);
+}
+
+TEST(SymbolClassifier, TiesPreferSmallerSymbolAndSymbolsGrow) {
+  SymbolClassifier c(4, 1);
+  c.learn(std::vector<int>{0, 99, -1}, 7);  // Bad columns ignored, capacity grows.
+  c.learn(std::vector<int>{0}, 3);
+  EXPECT_EQ(c.num_symbols(), 8u);
+  std::vector<SymbolClassifier::Prediction> out;
+  c.decode(std::vector<int>{0}, 2, out);
+  ASSERT_EQ(out.size(), 2u);
+  EXPECT_EQ(out[0].symbol, 3u);
+  EXPECT_EQ(out[1].symbol, 7u);
+  c.clear();
+  c.decode(std::vector<int>{0}, 2, out);
+  EXPECT_TRUE(out.empty());
+}
+
+TEST(SymbolClassifier, MergeAddsOnlyCountsLearnedSinceBase) {
+  SymbolClassifier base(6, 2);
+  base.learn(std::vector<int>{0, 1}, 0);
+
+  SymbolClassifier a = base;
+  a.learn(std::vector<int>{0}, 0);
+  SymbolClassifier b = base;
+  b.learn(std::vector<int>{4, 5}, 1);
+
+  SymbolClassifier merged = base;
+  merged.merge(a, &base);
+  merged.merge(b, &base);
+  EXPECT_EQ(merged.count(0, 0), 2u);
+  EXPECT_EQ(merged.count(1, 0), 1u);
+  EXPECT_EQ(merged.count(4, 1), 1u);
+  EXPECT_EQ(merged.count(5, 1), 1u);
+  EXPECT_EQ(merged.observations(), 5u);
+
+  // Without a base every count is added; the classifier grows to fit.
+  SymbolClassifier empty;
+  empty.merge(merged);
+  EXPECT_EQ(empty.num_columns(), 6u);
+  EXPECT_EQ(empty.observations(), 5u);
+  EXPECT_EQ(empty.count(99, 0), 0u);
+}
+
+TEST(SymbolClassifier, WriteReadRoundTrip) {
+  SymbolClassifier c(8, 3);
+  c.learn(std::vector<int>{0, 1, 2}, 0);
+  c.learn(std::vector<int>{2, 7}, 2);
+  std::stringstream buf;
+  c.write(buf);
+
+  SymbolClassifier back = SymbolClassifier::read(buf);
+  EXPECT_EQ(back.num_columns(), 8u);
+  EXPECT_EQ(back.observations(), c.observations());
+  EXPECT_EQ(back.count(2, 0), 1u);
+  EXPECT_EQ(back.count(2, 2), 1u);
+  std::vector<SymbolClassifier::Prediction> want, got;
+  c.decode(std::vector<int>{2, 7}, 2, want);
+  back.decode(std::vector<int>{2, 7}, 2, got);
+  ASSERT_EQ(got.size(), want.size());
+  EXPECT_EQ(got[0].symbol, want[0].symbol);
+
+  const std::string bytes = buf.str();
+  std::stringstream truncated(bytes.substr(0, bytes.size() - 3));
+  EXPECT_THROW(SymbolClassifier::read(truncated), std::runtime_error);
+}
@@ -103,6 +103,27 @@ TEST(TextChunker, ResetGoesBackToStart) {
   EXPECT_EQ(tc.next(), 'h');
 }
 
+TEST(TextChunker, SeekRestoresCursor) {
+  auto tc = TextChunker::from_string("hello");
+  tc.seek(3, 2, 13);
+  EXPECT_EQ(tc.position(), 3u);
+  EXPECT_EQ(tc.epoch(), 2);
+  EXPECT_EQ(tc.total_steps(), 13u);
+  EXPECT_EQ(tc.next(), 'l');
+  EXPECT_THROW(tc.seek(5, 0, 0), std::invalid_argument);
+}
+
+TEST(TextChunker, CopiesShareTextWithIndependentCursors) {
+  auto a = TextChunker::from_string("hello");
+  a.next();
+  TextChunker b = a;
+  EXPECT_EQ(&a.text(), &b.text());
+  EXPECT_EQ(b.next(), 'e');
+  EXPECT_EQ(b.next(), 'l');
+  EXPECT_EQ(a.position(), 1u);
+  EXPECT_EQ(a.next(), 'e');
+}
+
 // ---------------------------------------------------------------------------
 // Peek at offset
 // ---------------------------------------------------------------------------
@@ -113,3 +134,34 @@ TEST(TextChunker, PeekAtOffset) {
   EXPECT_EQ(tc.peek_at(2), 'c');
   EXPECT_EQ(tc.peek_at(5), 'a');  // wraps around
 }
+
+// ---------------------------------------------------------------------------
+// Normalization
+// ---------------------------------------------------------------------------
+
+TEST(TextChunker, LowercaseNormalization) {
+  chat_htm::TextNormalization norm;
+  norm.lowercase = true;
+  auto tc = TextChunker::from_string("AbC", norm);
+  EXPECT_EQ(tc.text(), "abc");
+}
+
+TEST(TextChunker, AsciiOnlyNormalization) {
+  chat_htm::TextNormalization norm;
+  norm.ascii_only = true;
+  auto tc = TextChunker::from_string(std::string("a\xC3\xA9z"), norm);
+  EXPECT_EQ(tc.text(), "a  z");
+}
+
+TEST(TextChunker, ParallelNormalizationMatchesSerial) {
+  std::string text;
+  while (text.size() < (2u << 20)) text += "Hello World\n";
+  chat_htm::TextNormalization norm;
+  norm.lowercase = true;
+  std::string parallel = text;
+  norm.apply(parallel, 4);
+  std::string serial = text;
+  norm.apply(serial, 1);
+  EXPECT_EQ(parallel, serial);
+  EXPECT_EQ(parallel.substr(0, 12), "hello world\n");
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "text/word_chunker.hpp"
+
+using chat_htm::WordChunker;
+
+// ---------------------------------------------------------------------------
+// Tokenization
+// ---------------------------------------------------------------------------
+
+TEST(WordChunker, TokenizesLowercasedAlphaRuns) {
+  auto wc = WordChunker::from_string("Hello, world!  HELLO again");
+  ASSERT_EQ(wc.size(), 4u);
+  EXPECT_EQ(wc.next(), "hello");
+  EXPECT_EQ(wc.next(), "world");
+  EXPECT_EQ(wc.next(), "hello");
+  EXPECT_EQ(wc.next(), "again");
+}
+
+TEST(WordChunker, InternsRepeatedWords) {
+  auto wc = WordChunker::from_string("cat dog cat cat dog bird");
+  EXPECT_EQ(wc.size(), 6u);
+  EXPECT_EQ(wc.vocabulary_size(), 3u);
+  EXPECT_EQ(wc.token(0), wc.token(2));
+  EXPECT_EQ(wc.token(1), wc.token(4));
+  EXPECT_EQ(wc.word(wc.token(5)), "bird");
+
+  auto vocab = wc.vocabulary();
+  ASSERT_EQ(vocab.size(), 3u);
+  EXPECT_EQ(vocab[0], "cat");
+  EXPECT_EQ(vocab[1], "dog");
+  EXPECT_EQ(vocab[2], "bird");
+}
+
+TEST(WordChunker, ThrowsWithoutWords) {
+  EXPECT_THROW(WordChunker::from_string("123 !!"), std::invalid_argument);
+}
+
+TEST(WordChunker, FromFile) {
+  WordChunker wc(CHAT_HTM_TEST_DATA_DIR "/simple_sentences.txt");
+  EXPECT_GT(wc.size(), 0u);
+  EXPECT_GT(wc.vocabulary_size(), 0u);
+  EXPECT_LE(wc.vocabulary_size(), wc.size());
+}
+
+// ---------------------------------------------------------------------------
+// Iteration
+// ---------------------------------------------------------------------------
+
+TEST(WordChunker, NextIdWrapsAndCountsEpochs) {
+  auto wc = WordChunker::from_string("a b");
+  const auto a = wc.next_id();
+  wc.next_id();
+  EXPECT_EQ(wc.epoch(), 1);
+  EXPECT_EQ(wc.position(), 0u);
+  EXPECT_EQ(wc.next_id(), a);
+  EXPECT_EQ(wc.total_steps(), 3u);
+}
+
+TEST(WordChunker, PeekDoesNotAdvance) {
+  auto wc = WordChunker::from_string("one two");
+  EXPECT_EQ(wc.peek(), "one");
+  EXPECT_EQ(wc.peek_id(), wc.token(0));
+  EXPECT_EQ(wc.position(), 0u);
+}
+
+TEST(WordChunker, ResetGoesBackToStart) {
+  auto wc = WordChunker::from_string("one two three");
+  wc.next();
+  wc.next();
+  wc.reset();
+  EXPECT_EQ(wc.position(), 0u);
+  EXPECT_EQ(wc.epoch(), 0);
+  EXPECT_EQ(wc.total_steps(), 0u);
+  EXPECT_EQ(wc.next(), "one");
+}
+
+TEST(WordChunker, SeekRestoresCursor) {
+  auto wc = WordChunker::from_string("one two three");
+  wc.seek(2, 1, 5);
+  EXPECT_EQ(wc.next(), "three");
+  EXPECT_EQ(wc.epoch(), 2);
+  EXPECT_EQ(wc.total_steps(), 6u);
+  EXPECT_THROW(wc.seek(3, 0, 0), std::invalid_argument);
+}
+
+TEST(WordChunker, CopiesShareCorpusWithIndependentCursors) {
+  auto a = WordChunker::from_string("one two three");
+  WordChunker b = a;
+  EXPECT_EQ(&a.tokens(), &b.tokens());
+  EXPECT_EQ(b.next(), "one");
+  EXPECT_EQ(b.next(), "two");
+  EXPECT_EQ(a.position(), 0u);
+  EXPECT_EQ(a.next(), "one");
+}
+
+// ---------------------------------------------------------------------------
+// Parallel tokenization
+// ---------------------------------------------------------------------------
+
+TEST(WordChunker, ParallelTokenizationMatchesSerial) {
+  // Large enough to take the multi-threaded path.
+  std::string text;
+  const char* words[] = {"alpha", "Beta", "gamma,", "delta.", "epsilonic", "zeta9eta", "theta"};
+  for (int i = 0; text.size() < (2u << 20); ++i) {
+    text += words[(i * 7 + i / 3) % 7];
+    text += (i % 11 == 0) ? "\n" : " ";
+  }
+
+  auto serial = WordChunker::from_string(text, 1);
+  auto parallel = WordChunker::from_string(text, 4);
+  EXPECT_EQ(parallel.tokens(), serial.tokens());
+  EXPECT_EQ(parallel.vocabulary(), serial.vocabulary());
+  EXPECT_EQ(parallel.max_word_length(), serial.max_word_length());
+  EXPECT_EQ(serial.max_word_length(), 9u);  // "epsilonic"
+}
+
+TEST(WordChunker, MaxWordLength) {
+  auto wc = WordChunker::from_string("a bb cccc bb");
+  EXPECT_EQ(wc.max_word_length(), 4u);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include "encoders/word_hash_encoder.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <string>
+
+using chat_htm::SdrView;
+using chat_htm::WordHashEncoder;
+
+namespace {
+
+WordHashEncoder::Params small_params(int trigram_bits = 0) {
+  WordHashEncoder::Params p;
+  p.n = 400;
+  p.w = 20;
+  p.trigram_bits = trigram_bits;
+  return p;
+}
+
+int overlap(const std::vector<int>& a, const std::vector<int>& b) {
+  std::vector<int> both;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(both));
+  return static_cast<int>(both.size());
+}
+
+std::vector<int> indices(const WordHashEncoder& enc, const std::string& word) {
+  std::vector<int> out;
+  enc.encode_indices(word, out);
+  return out;
+}
+
+}  // namespace
+
+TEST(WordHashEncoder, EveryWordHasExactlyWSortedBits) {
+  for (int trigrams : {0, 8, 20}) {
+    WordHashEncoder enc(small_params(trigrams));
+    for (const std::string word : {"a", "cat", "extraordinarily", "", "supercalifragilisticexpialidociousness"}) {
+      const auto bits = indices(enc, word);
+      EXPECT_EQ(bits.size(), 20u) << word << " trigrams=" << trigrams;
+      EXPECT_TRUE(std::is_sorted(bits.begin(), bits.end()));
+      EXPECT_EQ(std::adjacent_find(bits.begin(), bits.end()), bits.end());
+      EXPECT_GE(bits.front(), 0);
+      EXPECT_LT(bits.back(), 400);
+    }
+  }
+}
+
+TEST(WordHashEncoder, DenseAndPackedMatchIndices) {
+  WordHashEncoder enc(small_params(8));
+  const auto dense = enc.encode("learning");
+  EXPECT_EQ(static_cast<int>(dense.size()), enc.total_bits());
+  EXPECT_EQ(std::accumulate(dense.begin(), dense.end(), 0), 20);
+  for (int idx : indices(enc, "learning")) EXPECT_EQ(dense[static_cast<std::size_t>(idx)], 1);
+  EXPECT_EQ(enc.encode_sdr("learning").count(), 20u);
+}
+
+TEST(WordHashEncoder, IsDeterministicAndSeeded) {
+  WordHashEncoder a(small_params());
+  WordHashEncoder b(small_params());
+  EXPECT_EQ(indices(a, "milk"), indices(b, "milk"));
+
+  auto p = small_params();
+  p.seed = 42;
+  WordHashEncoder seeded(p);
+  EXPECT_NE(indices(a, "milk"), indices(seeded, "milk"));
+}
+
+TEST(WordHashEncoder, DistinctWordsBarelyOverlap) {
+  WordHashEncoder enc(small_params());
+  // Random 20-of-400 codes share ~1 bit on average.
+  EXPECT_LE(overlap(indices(enc, "cat"), indices(enc, "dog")), 5);
+  EXPECT_LE(overlap(indices(enc, "cat"), indices(enc, "cats")), 5);
+}
+
+TEST(WordHashEncoder, TrigramsMakeSimilarSpellingsOverlap) {
+  WordHashEncoder whole(small_params(0));
+  WordHashEncoder grams(small_params(10));
+  const int plain = overlap(indices(whole, "learn"), indices(whole, "learning"));
+  const int shared = overlap(indices(grams, "learn"), indices(grams, "learning"));
+  // "learn" and "learning" share "^le", "lea", "ear", "arn".
+  EXPECT_GT(shared, plain);
+  EXPECT_GE(shared, 4);
+  EXPECT_LE(overlap(indices(grams, "learn"), indices(grams, "milk")), 5);
+}
+
+TEST(WordHashEncoder, CachesVocabularyById) {
+  auto p = small_params(8);
+  p.cache = true;
+  WordHashEncoder enc(p);
+  EXPECT_FALSE(enc.has_word_cache());
+  enc.cache_vocabulary({"small", "cat"});
+  ASSERT_TRUE(enc.has_word_cache());
+
+  const auto expected = indices(enc, "cat");
+  const SdrView row = enc.cached_indices(1);
+  EXPECT_EQ(std::vector<int>(row.begin(), row.end()), expected);
+  EXPECT_EQ(enc.word_table().size(), 2u);
+}
+
+TEST(WordHashEncoder, RejectsInvalidParams) {
+  auto p = small_params();
+  p.n = 0;
+  EXPECT_THROW(WordHashEncoder{p}, std::invalid_argument);
+  p = small_params();
+  p.w = 0;
+  EXPECT_THROW(WordHashEncoder{p}, std::invalid_argument);
+  p = small_params();
+  p.w = p.n;
+  EXPECT_THROW(WordHashEncoder{p}, std::invalid_argument);
+  p = small_params();
+  p.trigram_bits = p.w + 1;
+  EXPECT_THROW(WordHashEncoder{p}, std::invalid_argument);
+}
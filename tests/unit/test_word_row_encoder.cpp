@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "encoders/word_row_encoder.hpp"
+
+#include <numeric>
+
+using chat_htm::SdrView;
+using chat_htm::WordRowEncoder;
+
+namespace {
+
+WordRowEncoder::Params small_params() {
+  WordRowEncoder::Params p;
+  p.rows = 5;
+  p.cols = 108;  // 4 * (26 + 1)
+  p.letter_bits = 4;
+  return p;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Dense encoding
+// ---------------------------------------------------------------------------
+
+TEST(WordRowEncoder, OutputLengthMatchesRowsTimesCols) {
+  WordRowEncoder enc(small_params());
+  EXPECT_EQ(static_cast<int>(enc.encode("cat").size()), 5 * 108);
+}
+
+TEST(WordRowEncoder, OneBlockPerLetterRow) {
+  WordRowEncoder enc(small_params());
+  auto sdr = enc.encode("cat");
+  EXPECT_EQ(std::accumulate(sdr.begin(), sdr.end(), 0), 3 * 4);
+  // 'c' is bucket 2 in row 0.
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(sdr[static_cast<std::size_t>(2 * 4 + i)], 1);
+}
+
+TEST(WordRowEncoder, IsCaseInsensitiveAndBucketsUnknownChars) {
+  WordRowEncoder enc(small_params());
+  EXPECT_EQ(enc.encode("CAT"), enc.encode("cat"));
+  auto sdr = enc.encode("1");
+  // Unknown characters map to the last block (bucket 26).
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(sdr[static_cast<std::size_t>(26 * 4 + i)], 1);
+}
+
+TEST(WordRowEncoder, LongWordsAreTruncatedToRows) {
+  WordRowEncoder enc(small_params());
+  EXPECT_EQ(enc.encode("abcdefgh"), enc.encode("abcde"));
+}
+
+TEST(WordRowEncoder, ThrowsOnMismatchedCols) {
+  auto p = small_params();
+  p.cols = 100;
+  EXPECT_THROW(WordRowEncoder{p}, std::invalid_argument);
+}
+
+// ---------------------------------------------------------------------------
+// Sparse and cached encoding
+// ---------------------------------------------------------------------------
+
+TEST(WordRowEncoder, EncodeIndicesMatchesDenseEncoding) {
+  WordRowEncoder enc(small_params());
+  std::vector<int> indices;
+  enc.encode_indices("milk", indices);
+  auto dense = enc.encode("milk");
+  std::vector<int> expected;
+  for (std::size_t i = 0; i < dense.size(); ++i) {
+    if (dense[i]) expected.push_back(static_cast<int>(i));
+  }
+  EXPECT_EQ(indices, expected);
+}
+
+TEST(WordRowEncoder, CachedVocabularyMatchesEncoding) {
+  WordRowEncoder enc(small_params());
+  enc.cache_vocabulary({"small", "cat", "milk"});
+  ASSERT_TRUE(enc.has_word_cache());
+  EXPECT_EQ(enc.word_table().size(), 3u);
+
+  std::vector<int> expected;
+  std::uint32_t id = 0;
+  for (const char* w : {"small", "cat", "milk"}) {
+    const SdrView view = enc.cached_indices(id++);
+    enc.encode_indices(w, expected);
+    EXPECT_EQ(std::vector<int>(view.begin(), view.end()), expected) << w;
+  }
+}